@@ -15,6 +15,7 @@
 from argparse import FileType
 
 from rclpy.qos import InvalidQoSProfileException
+from ros2bag.api import check_non_negative_float
 from ros2bag.api import check_path_exists
 from ros2bag.api import check_positive_float
 from ros2bag.api import convert_yaml_to_qos_profile
@@ -56,6 +57,14 @@ class PlayVerb(VerbExtension):
             '--remap', '-m', default='', nargs='+',
             help='list of topics to be remapped: in the form '
                  '"old_topic1:=new_topic1 old_topic2:=new_topic2 etc." ')
+        parser.add_argument(
+            '--start-offset', type=check_non_negative_float, default=0.0,
+            help='start the playback this many seconds after the beginning of the bag.')
+        parser.add_argument(
+            '--state-topics', type=str, default='', nargs='+',
+            help='topics whose last message before the start offset is published first, '
+                 'separated by space. Topics recorded with transient local durability are '
+                 'always included.')
 
     def main(self, *, args):  # noqa: D102
         qos_profile_overrides = {}  # Specify a valid default
@@ -82,4 +91,6 @@ class PlayVerb(VerbExtension):
             topics=args.topics,
             qos_profile_overrides=qos_profile_overrides,
             loop=args.loop,
-            topic_remapping=args.remap)
+            topic_remapping=args.remap,
+            start_offset=args.start_offset,
+            state_topics=args.state_topics)
@@ -66,11 +66,51 @@ class RecordVerb(VerbExtension):
                   'is disabled. If both splitting by size and duration are enabled, '
                   'the bag will split at whichever threshold is reached first.'
         )
+        parser.add_argument(
+            '--align-bag-duration', action='store_true',
+            help='split by duration at multiples of --max-bag-duration since the epoch of the '
+                 'message timestamps, e.g. at every full minute, instead of counting from the '
+                 'first message of each bagfile.'
+        )
+        parser.add_argument(
+            '--metadata-snapshot-interval', type=int, default=0,
+            help='write the metadata of the bag recorded so far at every split and then at most '
+                 'every this many seconds, so that a bag cut short by a crash can be recovered '
+                 'by only scanning its last bagfile. Default is zero, writing the metadata only '
+                 'when recording stops.'
+        )
         parser.add_argument(
             '--max-cache-size', type=int, default=0,
             help='maximum amount of messages to hold in cache before writing to disk. '
                  'Default it is zero, writing every message directly to disk.'
         )
+        parser.add_argument(
+            '--max-cache-bytes', type=int, default=0,
+            help='maximum amount of serialized message data, in bytes, to hold in cache before '
+                 'writing to disk. The cache is written once either this or --max-cache-size is '
+                 'reached. Default it is zero, not limiting the cache by size.'
+        )
+        parser.add_argument(
+            '--async-cache-flush', action='store_true',
+            help='write full caches to disk on a separate thread while recording into a second '
+                 'cache.'
+        )
+        parser.add_argument(
+            '--drop-on-full-cache', action='store_true',
+            help='with --async-cache-flush, drop messages instead of waiting when the cache is '
+                 'full while the previous one is still being written.'
+        )
+        parser.add_argument(
+            '--prepare-next-file', action='store_true',
+            help='open the next bagfile in the background while recording, so that splitting '
+                 'does not stall recording. Only has an effect together with --max-bag-size '
+                 'or --max-bag-duration.'
+        )
+        parser.add_argument(
+            '--append', action='store_true',
+            help='continue recording into the output bag if it already exists. New messages '
+                 'are written to a new bagfile. The bag must not be compressed.'
+        )
         parser.add_argument(
             '--compression-mode', type=str, default='none',
             choices=['none', 'file', 'message'],
@@ -96,9 +136,12 @@ class RecordVerb(VerbExtension):
 
         uri = args.output or datetime.datetime.now().strftime('rosbag2_%Y_%m_%d-%H_%M_%S')
 
-        if os.path.isdir(uri):
+        if os.path.isdir(uri) and not args.append:
             return print_error("Output folder '{}' already exists.".format(uri))
 
+        if args.append and args.compression_mode != 'none':
+            return print_error('Invalid choice: Cannot append to a bag with compression.')
+
         if args.compression_format and args.compression_mode == 'none':
             return print_error('Invalid choice: Cannot specify compression format '
                                'without a compression mode.')
@@ -134,7 +177,14 @@ class RecordVerb(VerbExtension):
                 polling_interval=args.polling_interval,
                 max_bagfile_size=args.max_bag_size,
                 max_bagfile_duration=args.max_bag_duration,
+                align_bagfile_duration=args.align_bag_duration,
+                metadata_snapshot_interval=args.metadata_snapshot_interval,
+                append=args.append,
                 max_cache_size=args.max_cache_size,
+                max_cache_bytes=args.max_cache_bytes,
+                async_cache_flush=args.async_cache_flush,
+                drop_messages_on_full_cache=args.drop_on_full_cache,
+                prepare_next_file=args.prepare_next_file,
                 include_hidden_topics=args.include_hidden_topics,
                 qos_profile_overrides=qos_profile_overrides)
         elif args.topics and len(args.topics) > 0:
@@ -156,7 +206,14 @@ class RecordVerb(VerbExtension):
                 polling_interval=args.polling_interval,
                 max_bagfile_size=args.max_bag_size,
                 max_bagfile_duration=args.max_bag_duration,
+                align_bagfile_duration=args.align_bag_duration,
+                metadata_snapshot_interval=args.metadata_snapshot_interval,
+                append=args.append,
                 max_cache_size=args.max_cache_size,
+                max_cache_bytes=args.max_cache_bytes,
+                async_cache_flush=args.async_cache_flush,
+                drop_messages_on_full_cache=args.drop_on_full_cache,
+                prepare_next_file=args.prepare_next_file,
                 topics=args.topics,
                 include_hidden_topics=args.include_hidden_topics,
                 qos_profile_overrides=qos_profile_overrides)
@@ -0,0 +1,52 @@
+# Copyright 2020 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+
+from ros2bag.verb import VerbExtension
+
+
+class ReindexVerb(VerbExtension):
+    """Rebuild the metadata of a bag from its files."""
+
+    def add_arguments(self, parser, cli_name):  # noqa: D102
+        parser.add_argument(
+            'bag_directory', help='bag directory to rebuild the metadata.yaml of')
+        parser.add_argument(
+            '-s', '--storage', default='',
+            help='storage identifier of the bag files. Defaults to the one of the existing '
+                 'metadata.yaml, if any.')
+        parser.add_argument(
+            '-j', '--jobs', type=int, default=0,
+            help='number of bag files to read at once. Default is zero, reading as many as '
+                 'there are hardware threads.')
+
+    def main(self, *, args):  # noqa: D102
+        bag_directory = args.bag_directory
+        if not os.path.isdir(bag_directory):
+            return "[ERROR] [ros2bag]: bag directory '{}' does not exist!".format(bag_directory)
+        if args.jobs < 0:
+            return '[ERROR] [ros2bag]: the number of jobs must not be negative.'
+        # NOTE(hidmic): in merged install workspaces on Windows, Python entrypoint lookups
+        #               combined with constrained environments (as imposed by colcon test)
+        #               may result in DLL loading failures when attempting to import a C
+        #               extension. Therefore, do not import rosbag2_transport at the module
+        #               level but on demand, right before first use.
+        from rosbag2_transport import rosbag2_transport_py
+        try:
+            file_count, message_count = rosbag2_transport_py.reindex(
+                uri=bag_directory, storage_id=args.storage, thread_count=args.jobs)
+        except RuntimeError as e:
+            return '[ERROR] [ros2bag]: {}'.format(e)
+        print('Reindexed {} bag files with {} messages.'.format(file_count, message_count))
@@ -58,6 +58,7 @@ public:
 
   /**
    * Compress the serialized_data of a serialized bag message in place.
+   * The message may be given a new serialized_data rather than having its buffer overwritten.
    *
    * \param[in,out] bag_message A serialized bag message.
    */
@@ -60,6 +60,7 @@ public:
 
   /**
    * Decompress the serialized_data of a serialized bag message in place.
+   * The message may be given a new serialized_data rather than having its buffer overwritten.
    *
    * \param[in,out] bag_message A serialized bag message.
    */
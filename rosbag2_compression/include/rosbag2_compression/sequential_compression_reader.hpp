@@ -69,6 +69,24 @@ public:
   std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_next() override;
 
 protected:
+  /**
+   * Decompresses messages of bags compressed per message before converting them.
+   */
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> decode_stored_message(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message) override;
+
+  /**
+   * Random access is not supported for bags compressed per file, as only the current file
+   * is decompressed.
+   */
+  bool supports_random_access() const override;
+
+  /**
+   * Messages of bags compressed per message are decompressed after reading, so they cannot be
+   * read into batches by the storage.
+   */
+  bool reads_messages_as_stored() const override;
+
   /**
    * Increment the current file iterator to point to the next file in the list of relative file
    * paths.
@@ -15,6 +15,7 @@
 #ifndef ROSBAG2_COMPRESSION__SEQUENTIAL_COMPRESSION_WRITER_HPP_
 #define ROSBAG2_COMPRESSION__SEQUENTIAL_COMPRESSION_WRITER_HPP_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -26,6 +27,8 @@
 #include "rosbag2_cpp/serialization_format_converter_factory_interface.hpp"
 #include "rosbag2_cpp/storage_options.hpp"
 #include "rosbag2_cpp/writer_interfaces/base_writer_interface.hpp"
+#include "rosbag2_cpp/writers/message_pool.hpp"
+#include "rosbag2_cpp/writers/metadata_snapshot_writer.hpp"
 
 #include "rosbag2_storage/metadata_io.hpp"
 #include "rosbag2_storage/storage_factory.hpp"
@@ -70,6 +73,7 @@ public:
    *
    * \param storage_options Options to configure the storage
    * \param converter_options options to define in which format incoming messages are stored
+   * \throws runtime_error if `append` is set in the storage options.
    **/
   void open(
     const rosbag2_cpp::StorageOptions & storage_options,
@@ -86,9 +90,10 @@ public:
    * a message which is passed to write(...).
    *
    * \param topic_with_type name and type identifier of topic to be created
+   * \return handle to write messages of the topic with; valid until the topic is removed
    * \throws runtime_error if the Writer is not open.
    */
-  void create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) override;
+  TopicHandle create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) override;
 
   /**
    * Remove a new topic in the underlying storage.
@@ -108,6 +113,49 @@ public:
    */
   void write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> message) override;
 
+  /**
+   * Write a message handed over by value. The message is moved into a recycled message object,
+   * so no object is allocated per message once as many have been allocated as are in flight.
+   *
+   * \param message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open.
+   */
+  void write(rosbag2_storage::SerializedBagMessage && message) override;
+
+  /**
+   * Write a message handed over by unique ownership, like write(SerializedBagMessage &&).
+   *
+   * \param message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open or the message is null.
+   */
+  void write(std::unique_ptr<rosbag2_storage::SerializedBagMessage> message) override;
+
+  /**
+   * Write a message on the topic with the given handle. Compressed messages are written by
+   * topic name, so this is a convenience rather than a faster path.
+   *
+   * \param topic handle returned by create_topic
+   * \param time_stamp time stamp of the message
+   * \param serialized_data serialized message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open or the handle does not belong to a topic.
+   */
+  void write(
+    TopicHandle topic,
+    rcutils_time_point_value_t time_stamp,
+    std::shared_ptr<rcutils_uint8_array_t> serialized_data) override;
+
+  /**
+   * Write a message and get notified of the id the storage assigns to it.
+   * Messages are written immediately, so the callback runs before this call returns.
+   *
+   * \param message to be written to the bagfile
+   * \param on_written callback receiving the assigned id
+   * \throws runtime_error if the Writer is not open.
+   */
+  void write_with_id(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    MessageIdCallback on_written) override;
+
 protected:
   /**
    * Compress the most recent file and update the metadata file path.
@@ -143,9 +191,22 @@ private:
 
   // Used in bagfile splitting; specifies the best-effort maximum sub-section of a bagfile in bytes.
   uint64_t max_bagfile_size_{rosbag2_storage::storage_interfaces::MAX_BAGFILE_SIZE_NO_SPLIT};
+  // Messages checked against the maximum bagfile size since the real size was last queried.
+  uint64_t messages_since_size_reconciliation_{0};
+
+  // Metadata snapshots are written at every split and once this much time passed since the last
+  // one, checked whenever a message is written. Zero if snapshots are disabled.
+  std::chrono::seconds metadata_snapshot_interval_{0};
+  std::chrono::steady_clock::time_point next_metadata_snapshot_time_{};
+  rosbag2_cpp::writers::MetadataSnapshotWriter metadata_snapshot_writer_;
 
   // Used to track topic -> message count
   std::unordered_map<std::string, rosbag2_storage::TopicInformation> topics_names_to_info_{};
+  // Names of the created topics, indexed by their handle; empty where a topic was removed.
+  std::vector<std::string> topic_names_by_handle_{};
+  std::unordered_map<std::string, TopicHandle> topic_handles_{};
+  // Holds the messages written by value or by handle, recycled once they have been written.
+  rosbag2_cpp::writers::MessagePool message_pool_{};
 
   rosbag2_storage::BagMetadata metadata_{};
 
@@ -157,12 +218,26 @@ private:
   void split_bagfile();
 
   // Checks if the current recording bagfile needs to be split and rolled over to a new file.
-  bool should_split_bagfile() const;
+  bool should_split_bagfile();
+
+  // Returns the size of the current bagfile: the storage's estimate on most messages, and the
+  // real size every BAGFILE_SIZE_RECONCILIATION_INTERVAL messages.
+  uint64_t get_current_bagfile_size();
 
   // Prepares the metadata by setting initial values.
   void init_metadata();
 
+  // Accounts a message in the summary of the file it is written to.
+  void record_in_current_file(const rosbag2_storage::SerializedBagMessage & message);
+
   // Record TopicInformation into metadata
+  void update_metadata();
+
+  // Hands the metadata of the bag recorded so far, marked as not finalized, to the snapshot
+  // writer.
+  void write_metadata_snapshot();
+
+  // Updates the metadata and marks it as finalized.
   void finalize_metadata();
 };
 }  // namespace rosbag2_compression
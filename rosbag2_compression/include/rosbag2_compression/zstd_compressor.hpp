@@ -33,20 +33,32 @@ namespace rosbag2_compression
  * A BaseCompressorInterface that is used to compress bagfiles stored using ZStandard compression.
  *
  * ZstdCompressor should only be initialized by Writer.
+ *
+ * The compression context is kept across calls instead of being set up for every message, so an
+ * instance must not be used from several threads at once.
  */
 class ROSBAG2_COMPRESSION_PUBLIC ZstdCompressor : public BaseCompressorInterface
 {
 public:
-  ZstdCompressor() = default;
+  /**
+   * \throws runtime_error if the compression context cannot be created.
+   */
+  ZstdCompressor();
 
   ~ZstdCompressor() = default;
 
+  ZstdCompressor(ZstdCompressor &&) = default;
+  ZstdCompressor & operator=(ZstdCompressor &&) = default;
+
   std::string compress_uri(const std::string & uri) override;
 
   void compress_serialized_bag_message(
     rosbag2_storage::SerializedBagMessage * bag_message) override;
 
   std::string get_compression_identifier() const override;
+
+private:
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> zstd_context_;
 };
 
 }  // namespace rosbag2_compression
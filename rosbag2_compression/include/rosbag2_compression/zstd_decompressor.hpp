@@ -33,20 +33,32 @@ namespace rosbag2_compression
  * A BaseDecompressorInterface that is used to decompress bagfiles stored using ZStandard compression.
  *
  * ZstdDecompressor should only be initialized by Reader.
+ *
+ * The decompression context is kept across calls instead of being set up for every message, so an
+ * instance must not be used from several threads at once.
  */
 class ROSBAG2_COMPRESSION_PUBLIC ZstdDecompressor : public BaseDecompressorInterface
 {
 public:
-  ZstdDecompressor() = default;
+  /**
+   * \throws runtime_error if the decompression context cannot be created.
+   */
+  ZstdDecompressor();
 
   ~ZstdDecompressor() = default;
 
+  ZstdDecompressor(ZstdDecompressor &&) = default;
+  ZstdDecompressor & operator=(ZstdDecompressor &&) = default;
+
   std::string decompress_uri(const std::string & uri) override;
 
   void decompress_serialized_bag_message(
     rosbag2_storage::SerializedBagMessage * bag_message) override;
 
   std::string get_decompression_identifier() const override;
+
+private:
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> zstd_context_;
 };
 
 }  // namespace rosbag2_compression
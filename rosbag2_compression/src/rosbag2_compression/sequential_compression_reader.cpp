@@ -62,8 +62,10 @@ void SequentialCompressionReader::open(
   const rosbag2_cpp::StorageOptions & storage_options,
   const rosbag2_cpp::ConverterOptions & converter_options)
 {
+  close_open_storages();
   if (metadata_io_->metadata_file_exists(storage_options.uri)) {
     metadata_ = metadata_io_->read_metadata(storage_options.uri);
+    read_immutable_ = storage_options.read_immutable || metadata_.finalized;
     if (metadata_.relative_file_paths.empty()) {
       ROSBAG2_COMPRESSION_LOG_WARN("No file paths were found in metadata.");
       return;
@@ -72,7 +74,7 @@ void SequentialCompressionReader::open(
     current_file_iterator_ = file_paths_.begin();
     setup_decompression();
 
-    storage_ = storage_factory_->open_read_only(
+    storage_ = open_read_only_storage(
       *current_file_iterator_, metadata_.storage_identifier);
     if (!storage_) {
       std::stringstream errmsg;
@@ -81,6 +83,7 @@ void SequentialCompressionReader::open(
 
       throw std::runtime_error{errmsg.str()};
     }
+    add_open_storage(get_current_file(), storage_);
   } else {
     std::stringstream errmsg;
     errmsg << "Could not find metadata for bag: \"" << storage_options.uri <<
@@ -113,6 +116,26 @@ std::shared_ptr<rosbag2_storage::SerializedBagMessage> SequentialCompressionRead
   throw std::runtime_error{"Bag is not open. Call open() before reading."};
 }
 
+std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+SequentialCompressionReader::decode_stored_message(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message)
+{
+  if (decompressor_ && compression_mode_ == rosbag2_compression::CompressionMode::MESSAGE) {
+    decompressor_->decompress_serialized_bag_message(message.get());
+  }
+  return SequentialReader::decode_stored_message(message);
+}
+
+bool SequentialCompressionReader::supports_random_access() const
+{
+  return compression_mode_ != rosbag2_compression::CompressionMode::FILE;
+}
+
+bool SequentialCompressionReader::reads_messages_as_stored() const
+{
+  return compression_mode_ != rosbag2_compression::CompressionMode::MESSAGE &&
+         SequentialReader::reads_messages_as_stored();
+}
 
 void SequentialCompressionReader::load_next_file()
 {
@@ -31,6 +31,7 @@
 #include "rosbag2_cpp/storage_options.hpp"
 
 #include "rosbag2_storage/storage_interfaces/read_write_interface.hpp"
+#include "rosbag2_storage/topic_statistics.hpp"
 
 #include "logging.hpp"
 
@@ -49,6 +50,13 @@ std::string format_storage_uri(const std::string & base_folder, uint64_t storage
 
   return (rcpputils::fs::path(base_folder) / storage_file_name.str()).string();
 }
+
+rosbag2_storage::FileInformation make_file_information(const std::string & path)
+{
+  rosbag2_storage::FileInformation file_information{};
+  file_information.path = path;
+  return file_information;
+}
 }  // namespace
 
 SequentialCompressionWriter::SequentialCompressionWriter(
@@ -85,6 +93,7 @@ void SequentialCompressionWriter::init_metadata()
   metadata_.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>{
     std::chrono::nanoseconds::max()};
   metadata_.relative_file_paths = {storage_->get_relative_file_path()};
+  metadata_.files = {make_file_information(metadata_.relative_file_paths.back())};
   metadata_.compression_format = compression_options_.compression_format;
   metadata_.compression_mode =
     rosbag2_compression::compression_mode_to_string(compression_options_.compression_mode);
@@ -103,8 +112,13 @@ void SequentialCompressionWriter::open(
   const rosbag2_cpp::StorageOptions & storage_options,
   const rosbag2_cpp::ConverterOptions & converter_options)
 {
+  if (storage_options.append) {
+    throw std::runtime_error("Appending to a bag is not supported with compression.");
+  }
+
   max_bagfile_size_ = storage_options.max_bagfile_size;
   base_folder_ = storage_options.uri;
+  metadata_snapshot_interval_ = std::chrono::seconds(storage_options.metadata_snapshot_interval);
 
   if (converter_options.output_serialization_format !=
     converter_options.input_serialization_format)
@@ -145,10 +159,15 @@ void SequentialCompressionWriter::open(
 
   setup_compression();
   init_metadata();
+  if (metadata_snapshot_interval_ != std::chrono::seconds::zero()) {
+    metadata_snapshot_writer_.start(*metadata_io_, base_folder_);
+    write_metadata_snapshot();
+  }
 }
 
 void SequentialCompressionWriter::reset()
 {
+  metadata_snapshot_writer_.stop();
   if (!base_folder_.empty() && compressor_) {
     // Reset may be called before initializing the compressor (ex. bad options).
     // We compress the last file only if it hasn't been compressed earlier (ex. in split_bagfile()).
@@ -162,6 +181,7 @@ void SequentialCompressionWriter::reset()
         ROSBAG2_COMPRESSION_LOG_WARN_STREAM("Could not compress the last bag file.\n" << e.what());
       }
     }
+    storage_.reset();  // Files must be complete before the metadata marks the bag as finalized.
     finalize_metadata();
     metadata_io_->write_metadata(base_folder_, metadata_);
   }
@@ -170,7 +190,7 @@ void SequentialCompressionWriter::reset()
   storage_factory_.reset();
 }
 
-void SequentialCompressionWriter::create_topic(
+SequentialCompressionWriter::TopicHandle SequentialCompressionWriter::create_topic(
   const rosbag2_storage::TopicMetadata & topic_with_type)
 {
   if (!storage_) {
@@ -181,23 +201,29 @@ void SequentialCompressionWriter::create_topic(
     converter_->add_topic(topic_with_type.name, topic_with_type.type);
   }
 
-  if (topics_names_to_info_.find(topic_with_type.name) ==
-    topics_names_to_info_.end())
-  {
-    rosbag2_storage::TopicInformation info{};
-    info.topic_metadata = topic_with_type;
+  const auto existing_handle = topic_handles_.find(topic_with_type.name);
+  if (existing_handle != topic_handles_.end()) {
+    return existing_handle->second;
+  }
 
-    const auto insert_res = topics_names_to_info_.insert(
-      std::make_pair(topic_with_type.name, info));
+  rosbag2_storage::TopicInformation info{};
+  info.topic_metadata = topic_with_type;
 
-    if (!insert_res.second) {
-      std::stringstream errmsg;
-      errmsg << "Failed to insert topic \"" << topic_with_type.name << "\"!";
-      throw std::runtime_error{errmsg.str()};
-    }
+  const auto insert_res = topics_names_to_info_.insert(
+    std::make_pair(topic_with_type.name, info));
 
-    storage_->create_topic(topic_with_type);
+  if (!insert_res.second) {
+    std::stringstream errmsg;
+    errmsg << "Failed to insert topic \"" << topic_with_type.name << "\"!";
+    throw std::runtime_error{errmsg.str()};
   }
+
+  const auto handle = static_cast<TopicHandle>(topic_names_by_handle_.size());
+  topic_names_by_handle_.push_back(topic_with_type.name);
+  topic_handles_.emplace(topic_with_type.name, handle);
+
+  storage_->create_topic(topic_with_type);
+  return handle;
 }
 
 void SequentialCompressionWriter::remove_topic(
@@ -208,6 +234,11 @@ void SequentialCompressionWriter::remove_topic(
   }
 
   if (topics_names_to_info_.erase(topic_with_type.name) > 0) {
+    const auto handle = topic_handles_.find(topic_with_type.name);
+    if (handle != topic_handles_.end()) {
+      topic_names_by_handle_[handle->second].clear();
+      topic_handles_.erase(handle);
+    }
     storage_->remove_topic(topic_with_type);
   } else {
     std::stringstream errmsg;
@@ -228,6 +259,7 @@ void SequentialCompressionWriter::compress_last_file()
     const auto compressed_uri = compressor_->compress_uri(to_compress.string());
 
     metadata_.relative_file_paths.back() = compressed_uri;
+    metadata_.files.back().path = compressed_uri;
 
     if (!rcpputils::fs::remove(to_compress)) {
       ROSBAG2_COMPRESSION_LOG_ERROR_STREAM(
@@ -239,11 +271,13 @@ void SequentialCompressionWriter::compress_last_file()
         "\" because it either is empty or does not exist.");
 
     metadata_.relative_file_paths.pop_back();
+    metadata_.files.pop_back();
   }
 }
 
 void SequentialCompressionWriter::split_bagfile()
 {
+  messages_since_size_reconciliation_ = 0;
   const auto storage_uri = format_storage_uri(
     base_folder_,
     metadata_.relative_file_paths.size());
@@ -265,11 +299,16 @@ void SequentialCompressionWriter::split_bagfile()
   }
 
   metadata_.relative_file_paths.push_back(storage_->get_relative_file_path());
+  metadata_.files.push_back(make_file_information(metadata_.relative_file_paths.back()));
 
   // Re-register all topics since we rolled-over to a new bagfile.
   for (const auto & topic : topics_names_to_info_) {
     storage_->create_topic(topic.second.topic_metadata);
   }
+
+  if (metadata_snapshot_interval_ != std::chrono::seconds::zero()) {
+    write_metadata_snapshot();
+  }
 }
 
 void SequentialCompressionWriter::compress_message(
@@ -289,8 +328,10 @@ void SequentialCompressionWriter::write(
     throw std::runtime_error{"Bag is not open. Call open() before writing."};
   }
 
-  // Update the message count for the Topic.
-  ++topics_names_to_info_.at(message->topic_name).message_count;
+  // Update the message count and statistics for the Topic.
+  auto & topic_information = topics_names_to_info_.at(message->topic_name);
+  ++topic_information.message_count;
+  rosbag2_storage::update_topic_statistics(topic_information, *message);
 
   if (should_split_bagfile()) {
     split_bagfile();
@@ -303,24 +344,106 @@ void SequentialCompressionWriter::write(
   const auto duration = message_timestamp - metadata_.starting_time;
   metadata_.duration = std::max(metadata_.duration, duration);
 
+  record_in_current_file(*message);
+
   auto converted_message = converter_ ? converter_->convert(message) : message;
   if (compression_options_.compression_mode == rosbag2_compression::CompressionMode::MESSAGE) {
     compress_message(converted_message);
   }
 
   storage_->write(converted_message);
+
+  if (metadata_snapshot_interval_ != std::chrono::seconds::zero() &&
+    std::chrono::steady_clock::now() >= next_metadata_snapshot_time_)
+  {
+    write_metadata_snapshot();
+  }
 }
 
-bool SequentialCompressionWriter::should_split_bagfile() const
+void SequentialCompressionWriter::record_in_current_file(
+  const rosbag2_storage::SerializedBagMessage & message)
+{
+  auto & file_information = metadata_.files.back();
+  const auto message_timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>{
+    std::chrono::nanoseconds(message.time_stamp)};
+  if (file_information.message_count == 0) {
+    file_information.starting_time = message_timestamp;
+    file_information.duration = std::chrono::nanoseconds(0);
+  } else {
+    const auto file_end = std::max(
+      file_information.starting_time + file_information.duration, message_timestamp);
+    file_information.starting_time = std::min(file_information.starting_time, message_timestamp);
+    file_information.duration = file_end - file_information.starting_time;
+  }
+  ++file_information.message_count;
+  ++file_information.topics_message_count[message.topic_name];
+}
+
+void SequentialCompressionWriter::write(rosbag2_storage::SerializedBagMessage && message)
+{
+  write(message_pool_.acquire(std::move(message)));
+}
+
+void SequentialCompressionWriter::write(
+  std::unique_ptr<rosbag2_storage::SerializedBagMessage> message)
+{
+  if (!message) {
+    throw std::runtime_error{"Cannot write a null message."};
+  }
+  write(std::move(*message));
+}
+
+void SequentialCompressionWriter::write(
+  TopicHandle topic,
+  rcutils_time_point_value_t time_stamp,
+  std::shared_ptr<rcutils_uint8_array_t> serialized_data)
+{
+  if (topic >= topic_names_by_handle_.size() || topic_names_by_handle_[topic].empty()) {
+    std::stringstream errmsg;
+    errmsg << "Failed to write on topic handle " << topic <<
+      ". Call create_topic() before first write.";
+    throw std::runtime_error{errmsg.str()};
+  }
+
+  auto message = message_pool_.acquire();
+  message->serialized_data = std::move(serialized_data);
+  message->time_stamp = time_stamp;
+  message->topic_name = topic_names_by_handle_[topic];
+  write(message);
+}
+
+void SequentialCompressionWriter::write_with_id(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+  MessageIdCallback on_written)
+{
+  write(message);
+  if (on_written) {
+    on_written(storage_->get_last_inserted_id());
+  }
+}
+
+bool SequentialCompressionWriter::should_split_bagfile()
 {
   if (max_bagfile_size_ == rosbag2_storage::storage_interfaces::MAX_BAGFILE_SIZE_NO_SPLIT) {
     return false;
   } else {
-    return storage_->get_bagfile_size() > max_bagfile_size_;
+    return get_current_bagfile_size() > max_bagfile_size_;
   }
 }
 
-void SequentialCompressionWriter::finalize_metadata()
+uint64_t SequentialCompressionWriter::get_current_bagfile_size()
+{
+  // The real size costs a file system call, so it is only queried every so often.
+  if (++messages_since_size_reconciliation_ >=
+    rosbag2_storage::storage_interfaces::BAGFILE_SIZE_RECONCILIATION_INTERVAL)
+  {
+    messages_since_size_reconciliation_ = 0;
+    return storage_->get_bagfile_size();
+  }
+  return storage_->get_bagfile_size_estimate();
+}
+
+void SequentialCompressionWriter::update_metadata()
 {
   metadata_.bag_size = 0;
 
@@ -342,4 +465,18 @@ void SequentialCompressionWriter::finalize_metadata()
   }
 }
 
+void SequentialCompressionWriter::write_metadata_snapshot()
+{
+  next_metadata_snapshot_time_ = std::chrono::steady_clock::now() + metadata_snapshot_interval_;
+  update_metadata();
+  metadata_.finalized = false;
+  metadata_snapshot_writer_.write(metadata_);
+}
+
+void SequentialCompressionWriter::finalize_metadata()
+{
+  update_metadata();
+  metadata_.finalized = true;
+}
+
 }  // namespace rosbag2_compression
@@ -16,17 +16,29 @@
 #include <chrono>
 #include <cstdio>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/filesystem_helper.hpp"
 
+#include "rosbag2_storage/serialized_buffer_pool.hpp"
+
 #include "compression_utils.hpp"
 #include "rosbag2_compression/zstd_compressor.hpp"
 
 namespace rosbag2_compression
 {
 
+ZstdCompressor::ZstdCompressor()
+: zstd_context_(ZSTD_createCCtx(), &ZSTD_freeCCtx)
+{
+  if (!zstd_context_) {
+    throw std::runtime_error{"Failed to create a ZSTD compression context."};
+  }
+}
+
 std::string ZstdCompressor::compress_uri(const std::string & uri)
 {
   const auto start = std::chrono::high_resolution_clock::now();
@@ -39,8 +51,8 @@ std::string ZstdCompressor::compress_uri(const std::string & uri)
 
   // Perform compression and check.
   // compression_result is either the actual compressed size or an error code.
-  const auto compression_result = ZSTD_compress(
-    compressed_buffer.data(), compressed_buffer.size(),
+  const auto compression_result = ZSTD_compressCCtx(
+    zstd_context_.get(), compressed_buffer.data(), compressed_buffer.size(),
     decompressed_buffer.data(), decompressed_buffer.size(), kDefaultZstdCompressionLevel);
   throw_on_zstd_error(compression_result);
 
@@ -58,31 +70,23 @@ void ZstdCompressor::compress_serialized_bag_message(
   rosbag2_storage::SerializedBagMessage * message)
 {
   const auto start = std::chrono::high_resolution_clock::now();
+  const auto uncompressed_buffer_length = message->serialized_data->buffer_length;
   // Allocate based on compression bound and compress
-  const auto uncompressed_buffer_length =
-    ZSTD_compressBound(message->serialized_data->buffer_length);
-  std::vector<uint8_t> compressed_buffer(uncompressed_buffer_length);
+  auto compressed_data = rosbag2_storage::make_pooled_empty_serialized_message(
+    ZSTD_compressBound(uncompressed_buffer_length));
 
   // Perform compression and check.
   // compression_result is either the actual compressed size or an error code.
-  const auto compression_result = ZSTD_compress(
-    compressed_buffer.data(), compressed_buffer.size(),
+  const auto compression_result = ZSTD_compressCCtx(
+    zstd_context_.get(), compressed_data->buffer, compressed_data->buffer_capacity,
     message->serialized_data->buffer, message->serialized_data->buffer_length,
     kDefaultZstdCompressionLevel);
   throw_on_zstd_error(compression_result);
 
-  // Compression_buffer_length might be larger than the actual compression size
-  // Resize compressed_buffer so its size is the actual compression size.
-  compressed_buffer.resize(compression_result);
-
-  const auto resize_result =
-    rcutils_uint8_array_resize(message->serialized_data.get(), compression_result);
-  throw_on_rcutils_resize_error(resize_result);
-
-  // Note that rcutils_uint8_array_resize changes buffer_capacity but not buffer_length, we
-  // have to do that manually.
-  message->serialized_data->buffer_length = compression_result;
-  std::copy(compressed_buffer.begin(), compressed_buffer.end(), message->serialized_data->buffer);
+  // The message takes the compressed buffer; the uncompressed one goes back to the pool once
+  // no one else holds it.
+  compressed_data->buffer_length = compression_result;
+  message->serialized_data = std::move(compressed_data);
 
   const auto end = std::chrono::high_resolution_clock::now();
   print_compression_statistics(start, end, uncompressed_buffer_length, compression_result);
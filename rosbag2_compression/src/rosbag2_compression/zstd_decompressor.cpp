@@ -16,17 +16,29 @@
 #include <chrono>
 #include <cstdio>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/filesystem_helper.hpp"
 
+#include "rosbag2_storage/serialized_buffer_pool.hpp"
+
 #include "compression_utils.hpp"
 #include "rosbag2_compression/zstd_decompressor.hpp"
 
 namespace rosbag2_compression
 {
 
+ZstdDecompressor::ZstdDecompressor()
+: zstd_context_(ZSTD_createDCtx(), &ZSTD_freeDCtx)
+{
+  if (!zstd_context_) {
+    throw std::runtime_error{"Failed to create a ZSTD decompression context."};
+  }
+}
+
 std::string ZstdDecompressor::decompress_uri(const std::string & uri)
 {
   const auto start = std::chrono::high_resolution_clock::now();
@@ -45,8 +57,8 @@ std::string ZstdDecompressor::decompress_uri(const std::string & uri)
   // the initializer list constructor instead.
   std::vector<uint8_t> decompressed_buffer(decompressed_buffer_length);
 
-  const auto decompression_result = ZSTD_decompress(
-    decompressed_buffer.data(), decompressed_buffer_length,
+  const auto decompression_result = ZSTD_decompressDCtx(
+    zstd_context_.get(), decompressed_buffer.data(), decompressed_buffer_length,
     compressed_buffer.data(), compressed_buffer_length);
 
   throw_on_zstd_error(decompression_result);
@@ -71,25 +83,17 @@ void ZstdDecompressor::decompress_serialized_bag_message(
 
   throw_on_invalid_frame_content(decompressed_buffer_length);
 
-  // Initializes decompressed_buffer with size = decompressed_buffer_length.
-  // Uniform initialization cannot be used here since it will choose
-  // the initializer list constructor instead.
-  std::vector<uint8_t> decompressed_buffer(decompressed_buffer_length);
+  auto decompressed_data =
+    rosbag2_storage::make_pooled_empty_serialized_message(decompressed_buffer_length);
 
-  const auto decompression_result = ZSTD_decompress(
-    decompressed_buffer.data(), decompressed_buffer_length,
+  const auto decompression_result = ZSTD_decompressDCtx(
+    zstd_context_.get(), decompressed_data->buffer, decompressed_buffer_length,
     message->serialized_data->buffer, compressed_buffer_length);
 
   throw_on_zstd_error(decompression_result);
 
-  const auto resize_result =
-    rcutils_uint8_array_resize(message->serialized_data.get(), decompression_result);
-  throw_on_rcutils_resize_error(resize_result);
-
-  message->serialized_data->buffer_length = decompression_result;
-  std::copy(
-    decompressed_buffer.begin(), decompressed_buffer.end(),
-    message->serialized_data->buffer);
+  decompressed_data->buffer_length = decompression_result;
+  message->serialized_data = std::move(decompressed_data);
 
   const auto end = std::chrono::high_resolution_clock::now();
   print_compression_statistics(start, end, decompression_result, compressed_buffer_length);
@@ -212,3 +212,55 @@ TEST_F(SequentialCompressionReaderTest, compression_called_when_splitting_bagfil
   EXPECT_EQ(compression_reader->has_next(), true);
   compression_reader->read_next();
 }
+
+TEST_F(SequentialCompressionReaderTest, files_without_filtered_topics_are_not_decompressed)
+{
+  const std::vector<std::string> relative_paths = {
+    "/path/to/storage1.zstd", "/path/to/storage2.zstd", "/path/to/storage3.zstd"};
+  rosbag2_storage::BagMetadata metadata = construct_default_bag_metadata();
+  metadata.relative_file_paths = relative_paths;
+  metadata.topics_with_message_count.push_back(
+    {{"other", "test_msgs/BasicTypes", storage_serialization_format_, ""}, 1});
+  // The second file holds no messages on the filtered topic.
+  const std::vector<std::string> file_topics = {"topic", "other", "topic"};
+  for (size_t i = 0; i < relative_paths.size(); ++i) {
+    rosbag2_storage::FileInformation file_information{};
+    file_information.path = relative_paths[i];
+    file_information.message_count = 1;
+    file_information.topics_message_count = {{file_topics[i], 1}};
+    metadata.files.push_back(file_information);
+  }
+  ON_CALL(*metadata_io_, read_metadata(_)).WillByDefault(Return(metadata));
+  ON_CALL(*metadata_io_, metadata_file_exists(_)).WillByDefault(Return(true));
+
+  auto decompressor = std::make_unique<NiceMock<MockDecompressor>>();
+  EXPECT_CALL(*decompressor, decompress_uri(relative_paths[0]))
+  .WillOnce(Return("/path/to/storage1"));
+  EXPECT_CALL(*decompressor, decompress_uri(relative_paths[1])).Times(0);
+  EXPECT_CALL(*decompressor, decompress_uri(relative_paths[2]))
+  .WillOnce(Return("/path/to/storage3"));
+
+  auto compression_factory = std::make_unique<StrictMock<MockCompressionFactory>>();
+  ON_CALL(*compression_factory, create_decompressor(_))
+  .WillByDefault(Return(ByMove(std::move(decompressor))));
+  EXPECT_CALL(*compression_factory, create_decompressor(_)).Times(1);
+  EXPECT_CALL(*storage_factory_, open_read_only("/path/to/storage1", _));
+  EXPECT_CALL(*storage_factory_, open_read_only("/path/to/storage3", _));
+  EXPECT_CALL(*storage_, has_next())
+  .WillOnce(Return(false))  // The first file is read to its end
+  .WillOnce(Return(true));  // The third file has a message
+
+  auto compression_reader = std::make_unique<rosbag2_compression::SequentialCompressionReader>(
+    std::move(compression_factory),
+    std::move(storage_factory_),
+    converter_factory_,
+    std::move(metadata_io_));
+  compression_reader->open(
+    rosbag2_cpp::StorageOptions(), {"", storage_serialization_format_});
+
+  rosbag2_storage::StorageFilter storage_filter;
+  storage_filter.topics = {"topic"};
+  compression_reader->set_filter(storage_filter);
+  EXPECT_TRUE(compression_reader->has_next());
+  EXPECT_EQ(compression_reader->get_current_file(), "/path/to/storage3");
+}
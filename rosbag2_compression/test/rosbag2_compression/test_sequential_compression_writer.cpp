@@ -138,3 +138,26 @@ TEST_F(SequentialCompressionWriterTest, writer_calls_create_compressor)
   writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
   writer_->open(rosbag2_cpp::StorageOptions(), {serialization_format_, serialization_format_});
 }
+
+TEST_F(SequentialCompressionWriterTest, write_with_id_reports_the_inserted_id)
+{
+  rosbag2_compression::CompressionOptions compression_options{
+    "zstd", rosbag2_compression::CompressionMode::FILE};
+  auto compression_factory = std::make_unique<rosbag2_compression::CompressionFactory>();
+  EXPECT_CALL(*storage_, get_last_inserted_id()).WillOnce(Return(42));
+
+  auto sequential_writer = std::make_unique<rosbag2_compression::SequentialCompressionWriter>(
+    compression_options,
+    std::move(compression_factory),
+    std::move(storage_factory_),
+    converter_factory_,
+    std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+  writer_->open(rosbag2_cpp::StorageOptions(), {serialization_format_, serialization_format_});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+
+  EXPECT_THAT(writer_->write_with_id(message).get(), Eq(42));
+}
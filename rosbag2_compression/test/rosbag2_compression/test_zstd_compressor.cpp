@@ -297,3 +297,24 @@ TEST_F(CompressionHelperFixture, zstd_decompress_serialized_bag_message)
   std::string new_msg = deserialize_message(msg->serialized_data);
   EXPECT_EQ(new_msg, message_);
 }
+
+TEST_F(CompressionHelperFixture, zstd_compressor_instances_are_reused_across_messages)
+{
+  rosbag2_compression::ZstdCompressor compressor;
+  rosbag2_compression::ZstdDecompressor decompressor;
+
+  const std::vector<std::string> messages{
+    message_, "a short message", message_ + message_, message_};
+  for (const auto & message : messages) {
+    auto msg = std::make_unique<rosbag2_storage::SerializedBagMessage>();
+    msg->serialized_data = rosbag2_storage::make_serialized_message(
+      message.data(), message.length());
+
+    compressor.compress_serialized_bag_message(msg.get());
+    if (message == message_) {
+      EXPECT_EQ(compressed_length_, msg->serialized_data->buffer_length);
+    }
+    decompressor.decompress_serialized_bag_message(msg.get());
+    EXPECT_EQ(message, deserialize_message(msg->serialized_data));
+  }
+}
@@ -16,6 +16,8 @@
 #ifndef ROSBAG2_CPP__READER_HPP_
 #define ROSBAG2_CPP__READER_HPP_
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -26,6 +28,7 @@
 #include "rosbag2_cpp/visibility_control.hpp"
 
 #include "rosbag2_storage/bag_metadata.hpp"
+#include "rosbag2_storage/message_batch.hpp"
 #include "rosbag2_storage/serialized_bag_message.hpp"
 #include "rosbag2_storage/storage_filter.hpp"
 #include "rosbag2_storage/topic_metadata.hpp"
@@ -110,6 +113,24 @@ public:
    */
   std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_next();
 
+  /**
+   * Read the next messages into a single batch, which holds their payloads in one buffer and
+   * is released as a unit. Reading stops once the batch holds max_messages or at least
+   * max_payload_bytes, or there is no next message.
+   *
+   * Expected usage:
+   * auto batch = reader.read_next_batch(1000);
+   * for (const auto & record : batch->get_records()) {
+   *   process(batch->get_topic_names()[record.topic_id], batch->get_payload(record));
+   * }
+   *
+   * \return the batch, which is empty if there is no next message
+   * \throws runtime_error if the Reader is not open or does not support batches.
+   */
+  std::shared_ptr<rosbag2_storage::MessageBatch> read_next_batch(
+    size_t max_messages,
+    uint64_t max_payload_bytes = std::numeric_limits<uint64_t>::max());
+
   /**
     * Ask bagfile for its full metadata.
     *
@@ -139,6 +160,59 @@ public:
    */
   void reset_filter();
 
+  /**
+   * Read, for each of the given topics, the last message stamped strictly before the
+   * given timestamp, e.g. to reconstruct the latched state when starting playback at
+   * an offset. Topics without such a message are left out.
+   *
+   * \param topic_names Topics to look up
+   * \param timestamp Timestamp (in nanoseconds) the messages have to precede
+   * \return the found messages ordered by timestamp
+   * \throws runtime_error if the Reader is not open.
+   */
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_latest_before(
+    const std::vector<std::string> & topic_names, rcutils_time_point_value_t timestamp);
+
+  /**
+   * Restart sequential reading at the first message stamped at or after the given timestamp,
+   * in whichever file of the bag it is stored. Filters set on the reader stay in effect.
+   *
+   * \param timestamp Timestamp (in nanoseconds) to continue reading from
+   * 	hrows runtime_error if the Reader is not open.
+   */
+  void seek(rcutils_time_point_value_t timestamp);
+
+  /**
+   * Read all messages stamped within [timestamp_begin, timestamp_end], across the files of
+   * the bag, without disturbing sequential reading.
+   *
+   * \param timestamp_begin Start of the range (in nanoseconds)
+   * \param timestamp_end End of the range (in nanoseconds), inclusive
+   * \param topic_names Topics to read, all topics if empty
+   * 
+eturn the messages ordered by timestamp
+   * 	hrows runtime_error if the Reader is not open.
+   */
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_range(
+    rcutils_time_point_value_t timestamp_begin,
+    rcutils_time_point_value_t timestamp_end,
+    const std::vector<std::string> & topic_names = {});
+
+  /**
+   * Read the message of the given topic stamped closest to the given timestamp, without
+   * disturbing sequential reading. On a tie, the earlier message is returned.
+   *
+   * \param topic_name Topic to read from
+   * \param timestamp Timestamp (in nanoseconds) to look up
+   * 
+eturn the closest message, or nullptr if the topic has no messages
+   * 	hrows runtime_error if the Reader is not open.
+   */
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_closest(
+    const std::string & topic_name, rcutils_time_point_value_t timestamp);
+
   reader_interfaces::BaseReaderInterface & get_implementation_handle() const
   {
     return *reader_impl_;
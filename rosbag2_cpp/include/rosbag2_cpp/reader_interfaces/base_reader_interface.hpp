@@ -15,7 +15,10 @@
 #ifndef ROSBAG2_CPP__READER_INTERFACES__BASE_READER_INTERFACE_HPP_
 #define ROSBAG2_CPP__READER_INTERFACES__BASE_READER_INTERFACE_HPP_
 
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "rosbag2_cpp/converter_options.hpp"
@@ -23,6 +26,7 @@
 #include "rosbag2_cpp/visibility_control.hpp"
 
 #include "rosbag2_storage/bag_metadata.hpp"
+#include "rosbag2_storage/message_batch.hpp"
 #include "rosbag2_storage/serialized_bag_message.hpp"
 #include "rosbag2_storage/storage_filter.hpp"
 #include "rosbag2_storage/topic_metadata.hpp"
@@ -46,6 +50,14 @@ public:
 
   virtual std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_next() = 0;
 
+  virtual std::shared_ptr<rosbag2_storage::MessageBatch> read_next_batch(
+    size_t max_messages, uint64_t max_payload_bytes)
+  {
+    (void) max_messages;
+    (void) max_payload_bytes;
+    throw std::runtime_error("read_next_batch is not supported by this reader.");
+  }
+
   virtual const rosbag2_storage::BagMetadata & get_metadata() const = 0;
 
   virtual std::vector<rosbag2_storage::TopicMetadata> get_all_topics_and_types() const = 0;
@@ -53,6 +65,41 @@ public:
   virtual void set_filter(const rosbag2_storage::StorageFilter & storage_filter) = 0;
 
   virtual void reset_filter() = 0;
+
+  virtual std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_latest_before(
+    const std::vector<std::string> & topic_names, rcutils_time_point_value_t timestamp)
+  {
+    (void) topic_names;
+    (void) timestamp;
+    throw std::runtime_error("read_latest_before is not supported by this reader.");
+  }
+
+  virtual void seek(rcutils_time_point_value_t timestamp)
+  {
+    (void) timestamp;
+    throw std::runtime_error("seek is not supported by this reader.");
+  }
+
+  virtual std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_range(
+    rcutils_time_point_value_t timestamp_begin,
+    rcutils_time_point_value_t timestamp_end,
+    const std::vector<std::string> & topic_names)
+  {
+    (void) timestamp_begin;
+    (void) timestamp_end;
+    (void) topic_names;
+    throw std::runtime_error("read_range is not supported by this reader.");
+  }
+
+  virtual std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_closest(
+    const std::string & topic_name, rcutils_time_point_value_t timestamp)
+  {
+    (void) topic_name;
+    (void) timestamp;
+    throw std::runtime_error("read_closest is not supported by this reader.");
+  }
 };
 
 }  // namespace reader_interfaces
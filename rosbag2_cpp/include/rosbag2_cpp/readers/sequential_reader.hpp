@@ -15,8 +15,10 @@
 #ifndef ROSBAG2_CPP__READERS__SEQUENTIAL_READER_HPP_
 #define ROSBAG2_CPP__READERS__SEQUENTIAL_READER_HPP_
 
+#include <list>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rosbag2_cpp/converter.hpp"
@@ -67,6 +69,17 @@ public:
 
   std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_next() override;
 
+  /**
+   * Read the next messages into one batch, across files if needed, until the batch holds
+   * max_messages or at least max_payload_bytes, or there is no next message.
+   * The messages are the ones read_next would return, in the same order.
+   *
+   * \return the batch, which is empty if there is no next message
+   * \throws runtime_error if the Reader is not open.
+   */
+  std::shared_ptr<rosbag2_storage::MessageBatch> read_next_batch(
+    size_t max_messages, uint64_t max_payload_bytes) override;
+
   const rosbag2_storage::BagMetadata & get_metadata() const override;
 
   std::vector<rosbag2_storage::TopicMetadata> get_all_topics_and_types() const override;
@@ -75,6 +88,22 @@ public:
 
   void reset_filter() override;
 
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_latest_before(
+    const std::vector<std::string> & topic_names,
+    rcutils_time_point_value_t timestamp) override;
+
+  void seek(rcutils_time_point_value_t timestamp) override;
+
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_range(
+    rcutils_time_point_value_t timestamp_begin,
+    rcutils_time_point_value_t timestamp_end,
+    const std::vector<std::string> & topic_names) override;
+
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_closest(
+    const std::string & topic_name, rcutils_time_point_value_t timestamp) override;
+
   /**
    * Ask whether there is another database file to read from the list of relative
    * file paths.
@@ -132,6 +161,47 @@ protected:
     */
   virtual void fill_topics_metadata();
 
+  /**
+    * Turn a message as stored in the files into the message handed out by the random access
+    * methods, i.e. apply the converter while keeping topic name, timestamp and index.
+    */
+  virtual std::shared_ptr<rosbag2_storage::SerializedBagMessage> decode_stored_message(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message);
+
+  /**
+    * Whether the files of the bag can be read at random, i.e. without reading them in order.
+    */
+  virtual bool supports_random_access() const;
+
+  /**
+    * Whether read_next hands out messages as the storage returns them, so that batches can be
+    * filled by the storage directly.
+    */
+  virtual bool reads_messages_as_stored() const;
+
+  /**
+    * Return a storage for the given file of the bag. Up to max_open_storages_ files are kept
+    * open, so that jumping back and forth between neighbouring files does not reopen them.
+    */
+  std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface>
+  get_storage(const std::string & file);
+
+  void add_open_storage(
+    const std::string & file,
+    std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> storage);
+
+  /**
+    * Drop all storages kept open for random access, along with the cached file time ranges.
+    */
+  void close_open_storages();
+
+  /**
+    * Open a file of the bag through the storage factory, in immutable mode if requested by the
+    * storage options or if the bag is finalized.
+    */
+  std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface>
+  open_read_only_storage(const std::string & uri, const std::string & storage_id);
+
   std::unique_ptr<rosbag2_storage::StorageFactoryInterface> storage_factory_{};
   std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> storage_{};
   std::unique_ptr<Converter> converter_{};
@@ -140,9 +210,48 @@ protected:
   std::vector<rosbag2_storage::TopicMetadata> topics_metadata_{};
   std::vector<std::string> file_paths_{};  // List of database files.
   std::vector<std::string>::iterator current_file_iterator_{};  // Index of file to read from
+  bool read_immutable_{false};
 
 private:
+  struct FileTimeRange
+  {
+    bool known = false;
+    bool empty = true;
+    rcutils_time_point_value_t start = 0;
+    rcutils_time_point_value_t end = 0;
+  };
+
+  void check_random_access() const;
+
+  void use_storage_for_reading(
+    std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> storage);
+
+  // Whether the metadata holds a summary of each file of the bag.
+  bool has_file_summaries() const;
+
+  size_t current_file_index() const;
+
+  // Whether the file may hold messages on any of the topics. Without file summaries, or if no
+  // topics are given, every file may.
+  bool file_has_topics(size_t file_index, const std::vector<std::string> & topic_names) const;
+
+  const FileTimeRange & get_file_time_range(size_t file_index);
+
+  rosbag2_storage::FileInformation file_information_from_storage(size_t file_index);
+
+  // Index of the first file holding messages stamped at or after the timestamp,
+  // or of the last file if there is none.
+  size_t find_file_index(rcutils_time_point_value_t timestamp);
+
+  static constexpr size_t max_open_storages_ = 4;
+
   std::shared_ptr<SerializationFormatConverterFactoryInterface> converter_factory_{};
+  // Most recently used first.
+  std::list<std::pair<std::string,
+    std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface>>> open_storages_{};
+  std::vector<FileTimeRange> file_time_ranges_{};
+  std::vector<rcutils_time_point_value_t> file_end_bounds_{};
+  rosbag2_storage::StorageFilter storage_filter_{};
 };
 
 }  // namespace readers
@@ -0,0 +1,103 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_CPP__REINDEXER_HPP_
+#define ROSBAG2_CPP__REINDEXER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rosbag2_cpp/storage_options.hpp"
+#include "rosbag2_cpp/visibility_control.hpp"
+
+#include "rosbag2_storage/bag_metadata.hpp"
+#include "rosbag2_storage/metadata_io.hpp"
+#include "rosbag2_storage/storage_factory.hpp"
+#include "rosbag2_storage/storage_factory_interface.hpp"
+
+// This is necessary because of using stl types here. It is completely safe, because
+// a) the member is not accessible from the outside
+// b) there are no inline functions.
+#ifdef _WIN32
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace rosbag2_cpp
+{
+
+/**
+ * Rebuilds the metadata of a bag from its files, e.g. for bags whose recorder crashed before
+ * writing the metadata.
+ *
+ * The bagfiles are the files in the bag directory named like the writer names them,
+ * `<directory name>_<index>` followed by the extension of the storage. Each of them is opened and
+ * summarized on its own thread of a pool, so reindexing takes about as long as summarizing the
+ * largest file. Files which cannot be opened or summarized, e.g. because they are truncated or
+ * corrupt, are left out of the metadata with a warning. Bags compressed per file are not
+ * supported, since the storage cannot open their files.
+ *
+ * If the existing metadata is a snapshot of a recording which did not finish, the files it lists
+ * as complete are not opened again: their summaries are taken from the snapshot, and only its last
+ * file and the files created after it are summarized.
+ */
+class ROSBAG2_CPP_PUBLIC Reindexer
+{
+public:
+  explicit
+  Reindexer(
+    std::unique_ptr<rosbag2_storage::StorageFactoryInterface> storage_factory =
+    std::make_unique<rosbag2_storage::StorageFactory>(),
+    std::unique_ptr<rosbag2_storage::MetadataIo> metadata_io =
+    std::make_unique<rosbag2_storage::MetadataIo>());
+
+  virtual ~Reindexer() = default;
+
+  /**
+   * Summarize the bagfiles of the bag and write its metadata, replacing any existing metadata.
+   * Must not be called on a bag which is still being written.
+   *
+   * \param storage_options uri of the bag directory and id of the storage of its files. Without a
+   * storage id, the one of the existing metadata is used.
+   * \param thread_count number of files summarized at once; 0 for one per hardware thread.
+   * \return the written metadata
+   * \throws runtime_error if the bag directory holds no bagfile that could be summarized, the
+   * storage id is neither given nor known from existing metadata, or the bag is compressed per
+   * file.
+   */
+  virtual rosbag2_storage::BagMetadata reindex(
+    const StorageOptions & storage_options, size_t thread_count = 0);
+
+  // Paths of the bagfiles in the bag directory, ordered by their index.
+  static std::vector<std::string> find_bagfiles(const std::string & uri);
+
+  // Index in the name of the file at the given path, or -1 if it is not named like a bagfile of
+  // the bag at uri.
+  static int64_t get_bagfile_index(const std::string & uri, const std::string & path);
+
+private:
+  std::unique_ptr<rosbag2_storage::StorageFactoryInterface> storage_factory_;
+  std::unique_ptr<rosbag2_storage::MetadataIo> metadata_io_;
+};
+
+}  // namespace rosbag2_cpp
+
+#ifdef _WIN32
+# pragma warning(pop)
+#endif
+
+#endif  // ROSBAG2_CPP__REINDEXER_HPP_
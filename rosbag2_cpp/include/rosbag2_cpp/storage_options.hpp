@@ -15,11 +15,37 @@
 #ifndef ROSBAG2_CPP__STORAGE_OPTIONS_HPP_
 #define ROSBAG2_CPP__STORAGE_OPTIONS_HPP_
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 
 namespace rosbag2_cpp
 {
 
+/**
+ * What the writer does with a message which does not fit into the ingestion budget
+ * (`max_queued_bytes`) anymore.
+ */
+enum class BackpressurePolicy : uint8_t
+{
+  // Wait until enough queued messages are written.
+  BLOCK = 0,
+  // Drop the incoming message.
+  DROP_NEWEST,
+  // Queue the incoming message and drop the oldest queued message of the topic instead.
+  DROP_OLDEST,
+  // Queue only every Nth message of the topic while over budget and drop the others.
+  // The queued messages may exceed the budget.
+  KEEP_EVERY_NTH
+};
+
+struct TopicBackpressure
+{
+  BackpressurePolicy policy = BackpressurePolicy::BLOCK;
+  // Only used with KEEP_EVERY_NTH.
+  uint64_t keep_every_nth = 1;
+};
+
 struct StorageOptions
 {
 public:
@@ -34,10 +60,61 @@ public:
   // A value of 0 indicates that bagfile splitting will not be used.
   uint64_t max_bagfile_duration = 0;
 
+  // Split bagfiles by duration at multiples of max_bagfile_duration since the epoch, e.g. at every
+  // full minute, rather than max_bagfile_duration after the first message of each bagfile.
+  // Only has an effect if splitting by duration is used.
+  bool align_bagfile_duration = false;
+
   // The cache size indiciates how many messages can maximally be hold in cache
   // before these being written to disk.
   // Defaults to 0, and effectively disables the caching.
   uint64_t max_cache_size = 0;
+
+  // The maximum amount of serialized message data, in bytes, held in cache before being written
+  // to disk. The cache is written once either limit is reached.
+  // Defaults to 0, which does not limit the cache by size.
+  uint64_t max_cache_bytes = 0;
+
+  // Write full caches to disk on a separate thread, while new messages are collected in a second
+  // cache. Only has an effect if caching is used.
+  bool async_cache_flush = false;
+
+  // With async_cache_flush, drop incoming messages instead of waiting when the cache is full
+  // while the previous one is still being written.
+  bool drop_messages_on_full_cache = false;
+
+  // Open the next bagfile in the background while writing to the current one, so that splitting
+  // does not stall writing. Only has an effect if bagfile splitting is used.
+  bool prepare_next_file = false;
+
+  // Continue recording into the bag at uri if it exists, instead of failing. Its metadata is
+  // loaded and messages are written to a new bagfile following its last one, so the existing
+  // bagfiles are not modified. The bag needs finalized metadata with file and topic summaries
+  // (version 8 or newer), which `ros2 bag reindex` rebuilds if missing, outdated or left behind
+  // by a crashed recording. Not supported with compression.
+  bool append = false;
+
+  // Write the metadata, marked as not finalized, when opening the bag, at every split and then
+  // whenever a message is written this many seconds after the last time. After a crash, only
+  // the last bagfile listed in it needs to be scanned to recover the bag.
+  // A value of 0 disables these snapshots; the metadata is then only written on closing the bag.
+  uint64_t metadata_snapshot_interval = 0;
+
+  // Accept writes from several threads at once. Messages are queued without locking and written
+  // to the storage by a dedicated thread, in the order they were queued.
+  bool concurrent_write = false;
+
+  // With concurrent_write, the maximum amount of serialized message data, in bytes, queued for
+  // writing. Messages beyond it are handled according to the backpressure of their topic.
+  // Defaults to 0, which does not limit the queue.
+  uint64_t max_queued_bytes = 0;
+  TopicBackpressure default_backpressure;
+  // Backpressure per topic name, overriding default_backpressure.
+  std::unordered_map<std::string, TopicBackpressure> topic_backpressure;
+
+  // Read the bag in immutable mode, i.e. without taking any locks. Only valid for bags that are
+  // not written to anymore; bags whose metadata marks them as finalized are always read this way.
+  bool read_immutable = false;
 };
 
 }  // namespace rosbag2_cpp
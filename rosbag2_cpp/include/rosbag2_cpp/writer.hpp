@@ -15,6 +15,7 @@
 #ifndef ROSBAG2_CPP__WRITER_HPP_
 #define ROSBAG2_CPP__WRITER_HPP_
 
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -87,9 +88,11 @@ public:
    * a message which is passed to write(...).
    *
    * \param topic_with_type name and type identifier of topic to be created
+   * \return handle to write messages of the topic with
    * \throws runtime_error if the Writer is not open.
    */
-  void create_topic(const rosbag2_storage::TopicMetadata & topic_with_type);
+  writer_interfaces::BaseWriterInterface::TopicHandle
+  create_topic(const rosbag2_storage::TopicMetadata & topic_with_type);
 
   /**
    * Remove a new topic in the underlying storage.
@@ -109,6 +112,61 @@ public:
    */
   void write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> message);
 
+  /**
+   * Write a message handed over by value, sparing the writer implementation to allocate an
+   * object for it.
+   *
+   * \param message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open.
+   */
+  void write(rosbag2_storage::SerializedBagMessage && message);
+
+  /**
+   * Write a message handed over by unique ownership, like write(SerializedBagMessage &&).
+   *
+   * \param message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open or the message is null.
+   */
+  void write(std::unique_ptr<rosbag2_storage::SerializedBagMessage> message);
+
+  /**
+   * Write a message on the topic with the given handle, as returned by create_topic.
+   * Unlike writing a SerializedBagMessage, this does not look up the topic by name.
+   *
+   * \param topic handle of the topic to write on
+   * \param time_stamp time stamp of the message
+   * \param serialized_data serialized message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open or does not support topic handles.
+   */
+  void write(
+    writer_interfaces::BaseWriterInterface::TopicHandle topic,
+    rcutils_time_point_value_t time_stamp,
+    std::shared_ptr<rcutils_uint8_array_t> serialized_data);
+
+  /**
+   * Write a message and get notified of the id the storage assigns to it.
+   * If the writer caches messages, the callback is invoked once the cache holding the message
+   * has been flushed, i.e. on a full cache, a split or when the writer is closed.
+   * Ids are only unique within a single bagfile of a split bag.
+   *
+   * \param message to be written to the bagfile
+   * \param on_written callback receiving the assigned id
+   * \throws runtime_error if the Writer is not open or does not support reporting ids.
+   */
+  void write_with_id(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    writer_interfaces::BaseWriterInterface::MessageIdCallback on_written);
+
+  /**
+   * Future-based variant of write_with_id.
+   *
+   * \param message to be written to the bagfile
+   * \return future holding the assigned id once the message has been written
+   * \throws runtime_error if the Writer is not open or does not support reporting ids.
+   */
+  std::future<int32_t> write_with_id(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message);
+
   writer_interfaces::BaseWriterInterface & get_implementation_handle() const
   {
     return *writer_impl_;
@@ -15,7 +15,11 @@
 #ifndef ROSBAG2_CPP__WRITER_INTERFACES__BASE_WRITER_INTERFACE_HPP_
 #define ROSBAG2_CPP__WRITER_INTERFACES__BASE_WRITER_INTERFACE_HPP_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <stdexcept>
+#include <utility>
 
 #include "rosbag2_cpp/converter_options.hpp"
 #include "rosbag2_cpp/storage_options.hpp"
@@ -39,11 +43,55 @@ public:
 
   virtual void reset() = 0;
 
-  virtual void create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) = 0;
+  // Dense id of a created topic, to write messages of it without looking up its name.
+  using TopicHandle = uint32_t;
+
+  // Returns the handle of the topic. Creating an existing topic again returns its handle.
+  virtual TopicHandle create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) = 0;
 
   virtual void remove_topic(const rosbag2_storage::TopicMetadata & topic_with_type) = 0;
 
   virtual void write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> message) = 0;
+
+  // Write a message handed over by value. Writers may recycle the object holding it,
+  // instead of allocating one per message.
+  virtual void write(rosbag2_storage::SerializedBagMessage && message)
+  {
+    write(std::make_shared<rosbag2_storage::SerializedBagMessage>(std::move(message)));
+  }
+
+  virtual void write(std::unique_ptr<rosbag2_storage::SerializedBagMessage> message)
+  {
+    if (!message) {
+      throw std::runtime_error("Cannot write a null message.");
+    }
+    write(std::move(*message));
+  }
+
+  virtual void write(
+    TopicHandle topic,
+    rcutils_time_point_value_t time_stamp,
+    std::shared_ptr<rcutils_uint8_array_t> serialized_data)
+  {
+    // dummy code
+    (void) topic;
+    (void) time_stamp;
+    (void) serialized_data;
+    throw std::runtime_error("This writer does not support writing by topic handle.");
+  }
+
+  // Called with the id the storage assigned to a message once it has actually been written.
+  using MessageIdCallback = std::function<void (int32_t)>;
+
+  virtual void write_with_id(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    MessageIdCallback on_written)
+  {
+    // dummy code
+    (void) message;
+    (void) on_written;
+    throw std::runtime_error("This writer does not report the ids of written messages.");
+  }
 };
 
 }  // namespace writer_interfaces
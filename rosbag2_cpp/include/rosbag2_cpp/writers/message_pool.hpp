@@ -0,0 +1,75 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_CPP__WRITERS__MESSAGE_POOL_HPP_
+#define ROSBAG2_CPP__WRITERS__MESSAGE_POOL_HPP_
+
+#include <cstddef>
+#include <memory>
+
+#include "rosbag2_cpp/visibility_control.hpp"
+
+#include "rosbag2_storage/serialized_bag_message.hpp"
+
+namespace rosbag2_cpp
+{
+namespace writers
+{
+
+/**
+ * Recycles the message objects handed to a writer, so that writing a message does not allocate
+ * one once the pool holds as many messages as are in flight.
+ *
+ * The deleter of a pooled message returns it to the pool, so the writer and its storage release
+ * pooled messages like any other. Returned messages are reset at once, which releases their
+ * payload, and are kept on a free list to be handed out again. The control blocks of the
+ * returned shared pointers are recycled the same way. Messages may outlive the pool.
+ *
+ * Safe to call from any number of threads at once.
+ */
+class ROSBAG2_CPP_PUBLIC MessagePool
+{
+public:
+  static constexpr size_t DEFAULT_MAX_SIZE = 4096;
+
+  // Messages beyond `max_size` in flight at once are allocated and not recycled.
+  explicit MessagePool(size_t max_size = DEFAULT_MAX_SIZE);
+
+  MessagePool(const MessagePool &) = delete;
+  MessagePool & operator=(const MessagePool &) = delete;
+
+  // Returns a message with default values, keeping only the capacity of its topic name.
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> acquire();
+
+  // Returns a message holding the contents of the given one.
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> acquire(
+    rosbag2_storage::SerializedBagMessage && message);
+
+  // Number of messages owned by the pool, free or not.
+  size_t size() const;
+
+private:
+  // Shared with the deleters of the messages in flight.
+  struct State;
+  template<typename T>
+  class ControlBlockAllocator;
+  class Recycler;
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace writers
+}  // namespace rosbag2_cpp
+
+#endif  // ROSBAG2_CPP__WRITERS__MESSAGE_POOL_HPP_
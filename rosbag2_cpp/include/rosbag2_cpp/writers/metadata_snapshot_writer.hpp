@@ -0,0 +1,77 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_CPP__WRITERS__METADATA_SNAPSHOT_WRITER_HPP_
+#define ROSBAG2_CPP__WRITERS__METADATA_SNAPSHOT_WRITER_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "rosbag2_cpp/visibility_control.hpp"
+
+#include "rosbag2_storage/bag_metadata.hpp"
+#include "rosbag2_storage/metadata_io.hpp"
+
+namespace rosbag2_cpp
+{
+namespace writers
+{
+
+/**
+ * Writes the metadata snapshots of a recording on a background thread, so that the recording
+ * does not wait for the metadata file to be emitted and synced to disk.
+ *
+ * Snapshots are written in the order they were queued. Failures are logged, as the recording
+ * can go on without the snapshot.
+ */
+class ROSBAG2_CPP_PUBLIC MetadataSnapshotWriter
+{
+public:
+  MetadataSnapshotWriter() = default;
+  ~MetadataSnapshotWriter();
+
+  MetadataSnapshotWriter(const MetadataSnapshotWriter &) = delete;
+  MetadataSnapshotWriter & operator=(const MetadataSnapshotWriter &) = delete;
+
+  // Starts the thread writing the snapshots of the bag at `uri`. `metadata_io` must not be used
+  // by others until stop() returns.
+  void start(rosbag2_storage::MetadataIo & metadata_io, const std::string & uri);
+
+  // Queues a snapshot to be written. Does nothing unless started.
+  void write(rosbag2_storage::BagMetadata metadata);
+
+  // Writes the snapshots still queued and stops the thread, so that the final metadata can
+  // follow. Does nothing unless started.
+  void stop();
+
+private:
+  void run();
+
+  rosbag2_storage::MetadataIo * metadata_io_ = nullptr;
+  std::string uri_;
+  std::thread thread_;
+  // Guards the members below.
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<rosbag2_storage::BagMetadata> pending_snapshots_;
+  bool stop_ = false;
+};
+
+}  // namespace writers
+}  // namespace rosbag2_cpp
+
+#endif  // ROSBAG2_CPP__WRITERS__METADATA_SNAPSHOT_WRITER_HPP_
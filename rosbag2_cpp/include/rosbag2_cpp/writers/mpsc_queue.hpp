@@ -0,0 +1,94 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_CPP__WRITERS__MPSC_QUEUE_HPP_
+#define ROSBAG2_CPP__WRITERS__MPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <utility>
+
+namespace rosbag2_cpp
+{
+namespace writers
+{
+
+/**
+ * Unbounded queue which any number of threads can push to without locking, while a single
+ * thread pops from it. Elements are popped in the order their pushes completed.
+ *
+ * Pushing links a new node in with a single atomic exchange. Popping never waits: an element
+ * whose push has not completed yet is not visible to try_pop.
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+  MpscQueue()
+  : head_(new Node()), tail_(head_.load())
+  {}
+
+  ~MpscQueue()
+  {
+    T value;
+    while (try_pop(value)) {}
+    delete tail_;
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue & operator=(const MpscQueue &) = delete;
+
+  // Safe to call from any number of threads at once.
+  void push(T value)
+  {
+    auto node = new Node(std::move(value));
+    auto previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  // Must not be called from several threads at once.
+  // Returns false if there is no element to pop.
+  bool try_pop(T & value)
+  {
+    auto next = tail_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    // The popped node stays in the queue as the new (empty) tail.
+    value = std::move(next->value);
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+
+private:
+  struct Node
+  {
+    Node() = default;
+    explicit Node(T node_value)
+    : value(std::move(node_value)) {}
+
+    T value{};
+    std::atomic<Node *> next{nullptr};
+  };
+
+  // Last pushed node, shared by the producers.
+  std::atomic<Node *> head_;
+  // Node before the next one to pop, owned by the consumer.
+  Node * tail_;
+};
+
+}  // namespace writers
+}  // namespace rosbag2_cpp
+
+#endif  // ROSBAG2_CPP__WRITERS__MPSC_QUEUE_HPP_
@@ -15,8 +15,16 @@
 #ifndef ROSBAG2_CPP__WRITERS__SEQUENTIAL_WRITER_HPP_
 #define ROSBAG2_CPP__WRITERS__SEQUENTIAL_WRITER_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -24,6 +32,9 @@
 #include "rosbag2_cpp/serialization_format_converter_factory.hpp"
 #include "rosbag2_cpp/storage_options.hpp"
 #include "rosbag2_cpp/writer_interfaces/base_writer_interface.hpp"
+#include "rosbag2_cpp/writers/message_pool.hpp"
+#include "rosbag2_cpp/writers/metadata_snapshot_writer.hpp"
+#include "rosbag2_cpp/writers/mpsc_queue.hpp"
 #include "rosbag2_cpp/visibility_control.hpp"
 
 #include "rosbag2_storage/metadata_io.hpp"
@@ -44,9 +55,18 @@ namespace rosbag2_cpp
 namespace writers
 {
 
+struct DroppedMessages
+{
+  uint64_t message_count = 0;
+  uint64_t bytes = 0;
+};
+
 /**
  * The Writer allows writing messages to a new bag. For every topic, information about its type
  * needs to be added before writing the first message.
+ *
+ * The Writer is not thread-safe, unless it is opened with `concurrent_write`. All functions may
+ * then be called from several threads at once.
  */
 class ROSBAG2_CPP_PUBLIC SequentialWriter
   : public rosbag2_cpp::writer_interfaces::BaseWriterInterface
@@ -64,11 +84,13 @@ public:
   ~SequentialWriter() override;
 
   /**
-   * Opens a new bagfile and prepare it for writing messages. The bagfile must not exist.
+   * Opens a new bagfile and prepare it for writing messages. The bagfile must not exist, unless
+   * `append` is set in the storage options.
    * This must be called before any other function is used.
    *
    * \param storage_options Options to configure the storage
    * \param converter_options options to define in which format incoming messages are stored
+   * \throws runtime_error if the bag exists and cannot be appended to.
    **/
   void open(
     const StorageOptions & storage_options, const ConverterOptions & converter_options) override;
@@ -80,9 +102,10 @@ public:
    * a message which is passed to write(...).
    *
    * \param topic_with_type name and type identifier of topic to be created
+   * \return handle to write messages of the topic with; valid until the topic is removed
    * \throws runtime_error if the Writer is not open.
    */
-  void create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) override;
+  TopicHandle create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) override;
 
   /**
    * Remove a new topic in the underlying storage.
@@ -102,8 +125,64 @@ public:
    */
   void write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> message) override;
 
+  /**
+   * Write a message handed over by value. The message is moved into a recycled message object,
+   * so no object is allocated per message once as many have been allocated as are in flight.
+   *
+   * \param message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open.
+   */
+  void write(rosbag2_storage::SerializedBagMessage && message) override;
+
+  /**
+   * Write a message handed over by unique ownership, like write(SerializedBagMessage &&).
+   *
+   * \param message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open or the message is null.
+   */
+  void write(std::unique_ptr<rosbag2_storage::SerializedBagMessage> message) override;
+
+  /**
+   * Write a message on the topic with the given handle. The topic is resolved by its handle, and
+   * the message reaches the storage with the storage's topic id instead of the topic name.
+   *
+   * \param topic handle returned by create_topic
+   * \param time_stamp time stamp of the message
+   * \param serialized_data serialized message to be written to the bagfile
+   * \throws runtime_error if the Writer is not open or the handle does not belong to a topic.
+   */
+  void write(
+    TopicHandle topic,
+    rcutils_time_point_value_t time_stamp,
+    std::shared_ptr<rcutils_uint8_array_t> serialized_data) override;
+
+  /**
+   * Write a message and get notified of the id the storage assigns to it.
+   * With caching enabled, the callback runs when the cache holding the message is flushed,
+   * on the flush thread if `async_cache_flush` is set. With `concurrent_write`, it runs on the
+   * write thread unless the message is cached.
+   *
+   * \param message to be written to the bagfile
+   * \param on_written callback receiving the assigned id
+   * \throws runtime_error if the Writer is not open.
+   */
+  void write_with_id(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    MessageIdCallback on_written) override;
+
+  /**
+   * Id of the last message inserted into the current bagfile.
+   * Only meaningful without caching; use write_with_id otherwise.
+   */
   int32_t get_last_inserted_id();
 
+  /**
+   * Messages dropped so far per topic, under the backpressure of `concurrent_write` or on a full
+   * cache with `drop_messages_on_full_cache`. Topics without dropped messages are left out.
+   * May be called from any thread.
+   */
+  std::unordered_map<std::string, DroppedMessages> get_dropped_messages() const;
+
 protected:
   std::string base_folder_;
   std::unique_ptr<rosbag2_storage::StorageFactoryInterface> storage_factory_;
@@ -112,33 +191,268 @@ protected:
   std::unique_ptr<rosbag2_storage::MetadataIo> metadata_io_;
   std::unique_ptr<Converter> converter_;
 
+  // Index in the name of the next bagfile to open.
+  uint64_t next_storage_index_ = 0;
+
   // Used in bagfile splitting; specifies the best-effort maximum sub-section of a bagfile in bytes.
   uint64_t max_bagfile_size_;
+  // Messages checked against the maximum bagfile size since the real size was last queried.
+  uint64_t messages_since_size_reconciliation_ = 0;
 
   // Used in bagfile splitting;
   // specifies the best-effort maximum duration of a bagfile in seconds.
   std::chrono::seconds max_bagfile_duration;
+  // Used in bagfile splitting; split by duration at multiples of max_bagfile_duration.
+  bool align_bagfile_duration_ = false;
+  // Message timestamp from which on messages are written to the next bagfile when splitting by
+  // duration. Set by the first message written to each bagfile.
+  rcutils_time_point_value_t duration_split_time_ =
+    std::numeric_limits<rcutils_time_point_value_t>::max();
+
+  // Metadata snapshots are written at every split and once this much time passed since the last
+  // one, checked whenever a message is written. Zero if snapshots are disabled.
+  std::chrono::seconds metadata_snapshot_interval_{0};
+  std::chrono::steady_clock::time_point next_metadata_snapshot_time_{};
+  MetadataSnapshotWriter metadata_snapshot_writer_;
+
+  // Holds the messages written by value or by handle, recycled once they have been written.
+  MessagePool message_pool_;
 
   // Intermediate cache to write multiple messages into the storage.
   // `max_cache_size` is the amount of messages to hold in storage before writing to disk.
   uint64_t max_cache_size_;
+  // `max_cache_bytes` is the amount of serialized data to hold before writing to disk.
+  uint64_t max_cache_bytes_ = 0;
+  // Serialized data held in `cache_`, in bytes.
+  uint64_t cache_bytes_ = 0;
   std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> cache_;
+  // Id callbacks of the cached messages, index-aligned with `cache_`. Empty if none was given.
+  std::vector<MessageIdCallback> cache_id_callbacks_;
+
+  // With `async_cache_flush`, full caches are handed over to the flush thread, which writes them
+  // to the storage they were collected for. All members below are guarded by `flush_mutex_`.
+  bool async_cache_flush_ = false;
+  bool drop_messages_on_full_cache_ = false;
+  std::thread flush_thread_;
+  std::mutex flush_mutex_;
+  std::condition_variable flush_condition_;
+  bool flush_pending_ = false;
+  bool stop_flush_thread_ = false;
+  std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> flush_cache_;
+  std::vector<MessageIdCallback> flush_id_callbacks_;
+  std::shared_ptr<rosbag2_storage::storage_interfaces::ReadWriteInterface> flush_storage_;
+  // Failure of the flush thread, rethrown on the writing thread.
+  std::exception_ptr flush_error_;
+  uint64_t dropped_message_count_ = 0;
+
+  // With `concurrent_write`, messages are pushed to `write_queue_` by any thread and written by
+  // the write thread. The write thread holds `write_mutex_` while writing, which other functions
+  // changing the state of the writer take as well.
+  // Backpressure state of a created topic, shared with the threads queueing messages.
+  struct TopicIngestion
+  {
+    TopicHandle handle = 0;
+    TopicBackpressure backpressure;
+    // Messages of the topic in `write_queue_`.
+    std::atomic<uint64_t> queued_message_count{0};
+    // Queued messages of the topic to drop instead of writing them, for DROP_OLDEST.
+    std::atomic<uint64_t> pending_drop_count{0};
+    // Messages of the topic offered while over budget, for KEEP_EVERY_NTH.
+    std::atomic<uint64_t> over_budget_count{0};
+    std::atomic<uint64_t> dropped_message_count{0};
+    std::atomic<uint64_t> dropped_bytes{0};
+  };
+  struct TopicIngestionIndex
+  {
+    std::unordered_map<std::string, std::shared_ptr<TopicIngestion>> by_name;
+    // Indexed by topic handle; null where a topic was removed.
+    std::vector<std::shared_ptr<TopicIngestion>> by_handle;
+  };
+  struct QueuedMessage
+  {
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message;
+    MessageIdCallback on_written;
+    std::shared_ptr<TopicIngestion> topic;
+    uint64_t size = 0;
+  };
+  bool concurrent_write_ = false;
+  // Budget of serialized data in `write_queue_`, in bytes. 0 if unlimited.
+  uint64_t max_queued_bytes_ = 0;
+  std::atomic<uint64_t> queued_bytes_{0};
+  TopicBackpressure default_backpressure_;
+  std::unordered_map<std::string, TopicBackpressure> topic_backpressure_;
+  MpscQueue<QueuedMessage> write_queue_;
+  // Messages pushed to `write_queue_` and not popped yet. A message can be popped before it is
+  // counted, so the count can temporarily drop below zero.
+  std::atomic<int64_t> queued_message_count_{0};
+  std::thread write_thread_;
+  std::mutex write_mutex_;
+  // Signals queued messages to the write thread and an emptied queue to waiting threads.
+  // `stop_write_thread_` and `write_error_` are guarded by `queue_mutex_`. Messages are pushed
+  // under it as well, and only while `accepting_queued_messages_`, which is cleared under it.
+  std::mutex queue_mutex_;
+  std::condition_variable queue_condition_;
+  bool stop_write_thread_ = false;
+  // Failure of the write thread, rethrown on the next thread to write.
+  std::exception_ptr write_error_;
+  std::atomic_bool has_write_error_{false};
+  std::atomic_bool accepting_queued_messages_{false};
+  // State of the created topics, for producers to check messages against without locking.
+  // Replaced as a whole when topics change; null before the writer is opened.
+  std::shared_ptr<const TopicIngestionIndex> topic_ingestion_;
 
   // Used to track topic -> message count
   std::unordered_map<std::string, rosbag2_storage::TopicInformation> topics_names_to_info_;
+  // Topics of an appended bag which have not been created again. A created topic continues the
+  // statistics of its entry here.
+  std::unordered_map<std::string, rosbag2_storage::TopicInformation> appended_topics_;
+
+  struct TopicEntry
+  {
+    // Points into `topics_names_to_info_`; null once the topic was removed.
+    rosbag2_storage::TopicInformation * information = nullptr;
+    // Id the current storage assigned to the topic; -1 if it does not identify topics by id.
+    int32_t storage_topic_id = -1;
+  };
+  // Created topics, indexed by their handle.
+  std::vector<TopicEntry> topics_by_handle_;
+  std::unordered_map<std::string, TopicHandle> topic_handles_;
 
   rosbag2_storage::BagMetadata metadata_;
 
+  // Bagfile following the current one, opened in the background if `prepare_next_file` is set.
+  bool prepare_next_file_ = false;
+  std::future<std::shared_ptr<rosbag2_storage::storage_interfaces::ReadWriteInterface>>
+  next_storage_;
+  // Topics registered in the next bagfile while it was prepared.
+  std::vector<rosbag2_storage::TopicMetadata> next_storage_topics_;
+
+  // Checks the message against the created topics and pushes it to the write queue.
+  void queue_message(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    MessageIdCallback on_written);
+
+  void queue_message(
+    const std::shared_ptr<TopicIngestion> & topic,
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    MessageIdCallback on_written);
+
+  // Rethrows a failure of the write thread and returns the created topics to queue messages on.
+  std::shared_ptr<const TopicIngestionIndex> load_topic_ingestion();
+
+  // Waits until the write thread has written all queued messages.
+  void wait_for_queued_messages();
+
+  void rethrow_write_error();
+
+  void run_write_thread();
+
+  void stop_write_thread();
+
+  // Applies the backpressure of the topic if the message does not fit into the ingestion budget.
+  // Returns false if the message is dropped.
+  bool admit_message(TopicIngestion & topic, uint64_t size);
+
+  bool try_reserve_queued_bytes(uint64_t size);
+
+  // Writes a popped message, unless it is dropped in favor of a newer one.
+  void write_queued_message(QueuedMessage & queued);
+
+  // Publishes the currently created topics to the threads queueing messages.
+  void update_topic_ingestion();
+
+  // Accounts a message the topic dropped.
+  void record_dropped_message(
+    TopicHandle topic, const rosbag2_storage::SerializedBagMessage & message);
+
+  // Returns the handle of a created topic.
+  TopicHandle get_topic_handle(const std::string & topic_name) const;
+
+  // Returns the created topic with the given handle.
+  TopicEntry & get_topic_entry(TopicHandle topic);
+
+  // Writes a message directly or through the cache, reporting its id if requested.
+  void write_message(
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    const MessageIdCallback & on_written);
+
+  // Messages written by handle come without a topic name; they are bound to the topic of the
+  // storage they are written to here.
+  void write_message(
+    TopicHandle topic,
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+    const MessageIdCallback & on_written);
+
+  // Looks up the ids the current storage assigned to the created topics.
+  void update_storage_topic_ids();
+
+  // Writes all cached messages to the current storage, after any cache handed over to the flush
+  // thread has been written.
+  void flush_cache();
+
+  bool cache_is_full() const;
+
+  // Passes the full cache on to be written. With `async_cache_flush`, it is handed over to the
+  // flush thread; returns false if that is still busy and messages are dropped on a full cache.
+  bool hand_over_cache();
+
+  // Waits until the flush thread has written the cache handed over to it.
+  void wait_for_pending_flush();
+
+  void run_flush_thread();
+
+  void stop_flush_thread();
+
+  static void write_cached_messages(
+    rosbag2_storage::storage_interfaces::ReadWriteInterface & storage,
+    const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> & messages,
+    const std::vector<MessageIdCallback> & id_callbacks);
+
+  // Accounts a message in the summary of the file it is written to.
+  void record_in_current_file(
+    const std::string & topic_name, const rosbag2_storage::SerializedBagMessage & message);
+
   // Closes the current backed storage and opens the next bagfile.
   void split_bagfile();
 
-  // Checks if the current recording bagfile needs to be split and rolled over to a new file.
-  bool should_split_bagfile() const;
+  // Starts opening the bagfile following the current one in the background, registering the
+  // current topics. The previous storage, if given, is closed in the background as well.
+  void prepare_next_storage(
+    std::shared_ptr<rosbag2_storage::storage_interfaces::ReadWriteInterface> previous_storage);
+
+  // Closes a prepared bagfile that was not rolled over to and removes it.
+  void discard_next_storage();
+
+  // Checks if the current recording bagfile needs to be split and rolled over to a new file
+  // before writing the given message.
+  bool should_split_bagfile(const rosbag2_storage::SerializedBagMessage & message);
+
+  // Returns the message timestamp at which a bagfile starting with the given timestamp is split
+  // by duration.
+  rcutils_time_point_value_t get_duration_split_time(
+    rcutils_time_point_value_t file_starting_time) const;
+
+  // Returns the size of the current bagfile: the storage's estimate on most messages, and the
+  // real size every BAGFILE_SIZE_RECONCILIATION_INTERVAL messages.
+  uint64_t get_current_bagfile_size();
 
   // Prepares the metadata by setting initial values.
   void init_metadata();
 
+  // Reads the metadata of the bag to append to and checks that it can be appended to.
+  rosbag2_storage::BagMetadata read_appended_metadata(const StorageOptions & storage_options);
+
+  // Prepares the metadata by continuing the one of the appended bag with the current bagfile.
+  void resume_metadata(rosbag2_storage::BagMetadata appended_metadata);
+
   // Record TopicInformation into metadata
+  void update_metadata();
+
+  // Hands the metadata of the bag recorded so far, marked as not finalized, to the snapshot
+  // writer.
+  void write_metadata_snapshot();
+
+  // Updates the metadata and marks it as finalized.
   void finalize_metadata();
 };
 
@@ -25,7 +25,7 @@
 #include "rosbag2_cpp/storage_options.hpp"
 
 #include "rosbag2_storage/metadata_io.hpp"
-#include "rosbag2_storage/ros_helper.hpp"
+#include "rosbag2_storage/serialized_buffer_pool.hpp"
 
 namespace rosbag2_cpp
 {
@@ -66,16 +66,25 @@ Converter::~Converter()
 std::shared_ptr<rosbag2_storage::SerializedBagMessage> Converter::convert(
   std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message)
 {
-  auto ts = topics_and_types_.at(message->topic_name).rmw_type_support;
-  auto introspection_ts = topics_and_types_.at(message->topic_name).introspection_type_support;
+  const auto & type_support = topics_and_types_.at(message->topic_name);
+  auto ts = type_support.rmw_type_support;
+  auto introspection_ts = type_support.introspection_type_support;
   auto allocator = rcutils_get_default_allocator();
   std::shared_ptr<rosbag2_introspection_message_t> allocated_ros_message =
     allocate_introspection_message(introspection_ts, &allocator);
 
   input_converter_->deserialize(message, ts, allocated_ros_message);
   auto output_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
-  output_message->serialized_data = rosbag2_storage::make_empty_serialized_message(0);
+  // Serializing in another format rarely changes the size much, so the input size is a good
+  // guess for the capacity the serializer needs.
+  output_message->serialized_data = rosbag2_storage::make_pooled_empty_serialized_message(
+    message->serialized_data ? message->serialized_data->buffer_length : 0u);
   output_converter_->serialize(allocated_ros_message, ts, output_message);
+  output_message->time_stamp = message->time_stamp;
+  output_message->topic_name = message->topic_name;
+  output_message->topic_id = message->topic_id;
+  output_message->has_key = message->has_key;
+  output_message->key = message->key;
   return output_message;
 }
 
@@ -64,6 +64,12 @@ std::shared_ptr<rosbag2_storage::SerializedBagMessage> Reader::read_next()
   return reader_impl_->read_next();
 }
 
+std::shared_ptr<rosbag2_storage::MessageBatch> Reader::read_next_batch(
+  size_t max_messages, uint64_t max_payload_bytes)
+{
+  return reader_impl_->read_next_batch(max_messages, max_payload_bytes);
+}
+
 const rosbag2_storage::BagMetadata & Reader::get_metadata() const
 {
   return reader_impl_->get_metadata();
@@ -84,4 +90,31 @@ void Reader::reset_filter()
   reader_impl_->reset_filter();
 }
 
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+Reader::read_latest_before(
+  const std::vector<std::string> & topic_names, rcutils_time_point_value_t timestamp)
+{
+  return reader_impl_->read_latest_before(topic_names, timestamp);
+}
+
+void Reader::seek(rcutils_time_point_value_t timestamp)
+{
+  reader_impl_->seek(timestamp);
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+Reader::read_range(
+  rcutils_time_point_value_t timestamp_begin,
+  rcutils_time_point_value_t timestamp_end,
+  const std::vector<std::string> & topic_names)
+{
+  return reader_impl_->read_range(timestamp_begin, timestamp_end, topic_names);
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage> Reader::read_closest(
+  const std::string & topic_name, rcutils_time_point_value_t timestamp)
+{
+  return reader_impl_->read_closest(topic_name, timestamp);
+}
+
 }  // namespace rosbag2_cpp
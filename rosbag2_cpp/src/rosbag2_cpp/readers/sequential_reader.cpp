@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -74,6 +77,7 @@ SequentialReader::~SequentialReader()
 
 void SequentialReader::reset()
 {
+  close_open_storages();
   if (storage_) {
     storage_.reset();
   }
@@ -85,8 +89,11 @@ void SequentialReader::open(
   // If there is a metadata.yaml file present, load it.
   // If not, let's ask the storage with the given URI for its metadata.
   // This is necessary for non ROS2 bags (aka ROS1 legacy bags).
+  close_open_storages();
+  read_immutable_ = storage_options.read_immutable;
   if (metadata_io_->metadata_file_exists(storage_options.uri)) {
     metadata_ = metadata_io_->read_metadata(storage_options.uri);
+    read_immutable_ = read_immutable_ || metadata_.finalized;
     if (metadata_.relative_file_paths.empty()) {
       ROSBAG2_CPP_LOG_WARN("No file paths were found in metadata.");
       return;
@@ -96,13 +103,14 @@ void SequentialReader::open(
       storage_options.uri, metadata_.relative_file_paths, metadata_.version);
     current_file_iterator_ = file_paths_.begin();
 
-    storage_ = storage_factory_->open_read_only(
+    storage_ = open_read_only_storage(
       get_current_file(), storage_options.storage_id);
     if (!storage_) {
       throw std::runtime_error{"No storage could be initialized. Abort"};
     }
+    add_open_storage(get_current_file(), storage_);
   } else {
-    storage_ = storage_factory_->open_read_only(
+    storage_ = open_read_only_storage(
       storage_options.uri, storage_options.storage_id);
     if (!storage_) {
       throw std::runtime_error{"No storage could be initialized. Abort"};
@@ -114,6 +122,7 @@ void SequentialReader::open(
     }
     file_paths_ = metadata_.relative_file_paths;
     current_file_iterator_ = file_paths_.begin();
+    add_open_storage(get_current_file(), storage_);
   }
   auto topics = metadata_.topics_with_message_count;
   if (topics.empty()) {
@@ -135,9 +144,17 @@ bool SequentialReader::has_next()
     // If there's no new message, check if there's at least another file to read and update storage
     // to read from there. Otherwise, check if there's another message.
     if (!storage_->has_next() && has_next_file()) {
+      // Files known to hold none of the filtered topics are passed over before being loaded, so
+      // they are neither opened nor decompressed. The last file is loaded in any case.
+      while (current_file_index() + 2 < file_paths_.size() &&
+        !file_has_topics(current_file_index() + 1, storage_filter_.topics))
+      {
+        ++current_file_iterator_;
+      }
       load_next_file();
-      storage_ = storage_factory_->open_read_only(
-        get_current_file(), metadata_.storage_identifier);
+      use_storage_for_reading(get_storage(get_current_file()));
+      // The storage may have been read from before, when it was accessed at random.
+      storage_->seek(std::numeric_limits<rcutils_time_point_value_t>::min());
     }
 
     return storage_->has_next();
@@ -154,6 +171,25 @@ std::shared_ptr<rosbag2_storage::SerializedBagMessage> SequentialReader::read_ne
   throw std::runtime_error("Bag is not open. Call open() before reading.");
 }
 
+std::shared_ptr<rosbag2_storage::MessageBatch> SequentialReader::read_next_batch(
+  size_t max_messages, uint64_t max_payload_bytes)
+{
+  if (!storage_) {
+    throw std::runtime_error("Bag is not open. Call open() before reading.");
+  }
+
+  auto batch = std::make_shared<rosbag2_storage::MessageBatch>();
+  // has_next moves on to the next file once the storage has no message left.
+  while (!batch->is_full(max_messages, max_payload_bytes) && has_next()) {
+    if (reads_messages_as_stored()) {
+      storage_->read_next_batch(*batch, max_messages, max_payload_bytes);
+    } else {
+      batch->add_message(*read_next());
+    }
+  }
+  return batch;
+}
+
 const rosbag2_storage::BagMetadata & SequentialReader::get_metadata() const
 {
   rcpputils::check_true(storage_ != nullptr, "Bag is not open. Call open() before reading.");
@@ -170,6 +206,7 @@ void SequentialReader::set_filter(
   const rosbag2_storage::StorageFilter & storage_filter)
 {
   if (storage_) {
+    storage_filter_ = storage_filter;
     storage_->set_filter(storage_filter);
     return;
   }
@@ -180,6 +217,7 @@ void SequentialReader::set_filter(
 void SequentialReader::reset_filter()
 {
   if (storage_) {
+    storage_filter_ = rosbag2_storage::StorageFilter();
     storage_->reset_filter();
     return;
   }
@@ -187,6 +225,344 @@ void SequentialReader::reset_filter()
           "Bag is not open. Call open() before resetting filter.");
 }
 
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+SequentialReader::read_latest_before(
+  const std::vector<std::string> & topic_names, rcutils_time_point_value_t timestamp)
+{
+  check_random_access();
+
+  auto latest_messages =
+    std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>();
+  auto missing_topics = topic_names;
+  // With file summaries, files starting at or after the timestamp are known to hold no earlier
+  // message and are not opened. The walk starts at the file holding the timestamp and only
+  // includes later files if they overlap it.
+  const bool skip_by_time_range = has_file_summaries();
+  auto starts_before_timestamp = [this, timestamp](size_t file_index) {
+      const auto & time_range = get_file_time_range(file_index);
+      return !time_range.empty && time_range.start < timestamp;
+    };
+  size_t end_index = file_paths_.size();
+  if (skip_by_time_range && !file_paths_.empty()) {
+    end_index = find_file_index(timestamp) + 1;
+    for (size_t file_index = end_index; file_index < file_paths_.size(); ++file_index) {
+      if (starts_before_timestamp(file_index)) {
+        end_index = file_index + 1;
+      } else if (!get_file_time_range(file_index).empty) {
+        break;
+      }
+    }
+  }
+  // Walk the files backwards, so that each topic is resolved by the latest file containing it.
+  for (size_t file_index = end_index; file_index-- > 0 && !missing_topics.empty(); ) {
+    if ((skip_by_time_range && !starts_before_timestamp(file_index)) ||
+      !file_has_topics(file_index, missing_topics))
+    {
+      continue;
+    }
+    auto file_messages =
+      get_storage(file_paths_[file_index])->read_latest_before(missing_topics, timestamp);
+    if (!file_messages) {
+      continue;
+    }
+    for (const auto & message : *file_messages) {
+      missing_topics.erase(
+        std::remove(missing_topics.begin(), missing_topics.end(), message->topic_name),
+        missing_topics.end());
+      latest_messages->push_back(message);
+    }
+  }
+
+  std::stable_sort(
+    latest_messages->begin(), latest_messages->end(),
+    [](const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & lhs,
+    const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & rhs) {
+      return lhs->time_stamp < rhs->time_stamp;
+    });
+  for (auto & message : *latest_messages) {
+    message = decode_stored_message(message);
+  }
+  return latest_messages;
+}
+
+void SequentialReader::seek(rcutils_time_point_value_t timestamp)
+{
+  check_random_access();
+
+  current_file_iterator_ = file_paths_.begin() + find_file_index(timestamp);
+  use_storage_for_reading(get_storage(get_current_file()));
+  storage_->seek(timestamp);
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+SequentialReader::read_range(
+  rcutils_time_point_value_t timestamp_begin,
+  rcutils_time_point_value_t timestamp_end,
+  const std::vector<std::string> & topic_names)
+{
+  check_random_access();
+
+  auto range_messages =
+    std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>();
+  for (size_t file_index = 0; file_index < file_paths_.size(); ++file_index) {
+    const auto & time_range = get_file_time_range(file_index);
+    if (time_range.empty || time_range.end < timestamp_begin) {
+      continue;
+    }
+    if (time_range.start > timestamp_end) {
+      break;
+    }
+    if (!file_has_topics(file_index, topic_names)) {
+      continue;
+    }
+    auto file_messages = get_storage(file_paths_[file_index])->read_topics_at_timestamp_range(
+      topic_names, timestamp_begin, timestamp_end);
+    if (!file_messages) {
+      continue;
+    }
+    for (const auto & message : *file_messages) {
+      range_messages->push_back(decode_stored_message(message));
+    }
+  }
+  return range_messages;
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage> SequentialReader::read_closest(
+  const std::string & topic_name, rcutils_time_point_value_t timestamp)
+{
+  check_random_access();
+
+  auto distance = [timestamp](const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & m) {
+      return m->time_stamp < timestamp ? timestamp - m->time_stamp : m->time_stamp - timestamp;
+    };
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> closest_message;
+  auto consider = [&closest_message, &distance](
+    const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & message) {
+      if (message && (!closest_message || distance(message) < distance(closest_message) ||
+        (distance(message) == distance(closest_message) &&
+        message->time_stamp < closest_message->time_stamp)))
+      {
+        closest_message = message;
+      }
+    };
+
+  // Files are ordered in time: earlier files can only contribute messages before the timestamp
+  // and later files only messages after it, so each side stops at the first file with a hit.
+  const auto file_index = find_file_index(timestamp);
+  const auto topic_names = std::vector<std::string>{topic_name};
+  for (size_t i = file_index + 1; i-- > 0; ) {
+    if (!file_has_topics(i, topic_names)) {
+      continue;
+    }
+    auto message = get_storage(file_paths_[i])->read_closest(topic_name, timestamp);
+    consider(message);
+    if (message && message->time_stamp <= timestamp) {
+      break;
+    }
+  }
+  if (!closest_message || closest_message->time_stamp < timestamp) {
+    for (size_t i = file_index + 1; i < file_paths_.size(); ++i) {
+      if (!file_has_topics(i, topic_names)) {
+        continue;
+      }
+      auto message = get_storage(file_paths_[i])->read_closest(topic_name, timestamp);
+      consider(message);
+      if (message) {
+        break;
+      }
+    }
+  }
+  return closest_message ? decode_stored_message(closest_message) : closest_message;
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage> SequentialReader::decode_stored_message(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message)
+{
+  if (!converter_) {
+    return message;
+  }
+  auto converted_message = converter_->convert(message);
+  converted_message->topic_name = message->topic_name;
+  converted_message->time_stamp = message->time_stamp;
+  converted_message->database_index = message->database_index;
+  return converted_message;
+}
+
+bool SequentialReader::supports_random_access() const
+{
+  return true;
+}
+
+bool SequentialReader::reads_messages_as_stored() const
+{
+  return !converter_;
+}
+
+void SequentialReader::check_random_access() const
+{
+  rcpputils::check_true(storage_ != nullptr, "Bag is not open. Call open() before reading.");
+  if (!supports_random_access()) {
+    throw std::runtime_error{"Random access is not supported for this bag."};
+  }
+}
+
+std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface>
+SequentialReader::get_storage(const std::string & file)
+{
+  for (auto open_storage = open_storages_.begin(); open_storage != open_storages_.end();
+    ++open_storage)
+  {
+    if (open_storage->first == file) {
+      // Move to the front, the least recently used storage is at the back.
+      open_storages_.splice(open_storages_.begin(), open_storages_, open_storage);
+      return open_storages_.front().second;
+    }
+  }
+
+  auto storage = open_read_only_storage(file, metadata_.storage_identifier);
+  if (!storage) {
+    throw std::runtime_error{"No storage could be initialized for file " + file + "."};
+  }
+  add_open_storage(file, storage);
+  return storage;
+}
+
+void SequentialReader::add_open_storage(
+  const std::string & file,
+  std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> storage)
+{
+  open_storages_.emplace_front(file, std::move(storage));
+  if (open_storages_.size() > max_open_storages_) {
+    open_storages_.pop_back();
+  }
+}
+
+void SequentialReader::close_open_storages()
+{
+  open_storages_.clear();
+  file_time_ranges_.clear();
+  file_end_bounds_.clear();
+  storage_filter_ = rosbag2_storage::StorageFilter();
+}
+
+void SequentialReader::use_storage_for_reading(
+  std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> storage)
+{
+  if (storage == storage_) {
+    // The filter was applied when the storage became the current one.
+    return;
+  }
+  storage_ = std::move(storage);
+  if (storage_filter_.topics.empty()) {
+    storage_->reset_filter();
+  } else {
+    storage_->set_filter(storage_filter_);
+  }
+}
+
+bool SequentialReader::has_file_summaries() const
+{
+  return !file_paths_.empty() && metadata_.files.size() == file_paths_.size();
+}
+
+size_t SequentialReader::current_file_index() const
+{
+  return static_cast<size_t>(
+    std::vector<std::string>::const_iterator(current_file_iterator_) - file_paths_.cbegin());
+}
+
+bool SequentialReader::file_has_topics(
+  size_t file_index, const std::vector<std::string> & topic_names) const
+{
+  if (topic_names.empty() || !has_file_summaries()) {
+    return true;
+  }
+  const auto & topics_message_count = metadata_.files[file_index].topics_message_count;
+  return std::any_of(
+    topic_names.begin(), topic_names.end(),
+    [&topics_message_count](const std::string & topic_name) {
+      return topics_message_count.find(topic_name) != topics_message_count.end();
+    });
+}
+
+const SequentialReader::FileTimeRange & SequentialReader::get_file_time_range(size_t file_index)
+{
+  if (file_time_ranges_.size() != file_paths_.size()) {
+    file_time_ranges_.assign(file_paths_.size(), FileTimeRange{});
+  }
+  auto & time_range = file_time_ranges_[file_index];
+  if (!time_range.known) {
+    // Prefer the summary recorded in the metadata, older bags require opening the file.
+    const auto file_information = has_file_summaries() ?
+      metadata_.files[file_index] : file_information_from_storage(file_index);
+    time_range.known = true;
+    time_range.empty = file_information.message_count == 0;
+    time_range.start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      file_information.starting_time.time_since_epoch()).count();
+    time_range.end = time_range.start + file_information.duration.count();
+  }
+  return time_range;
+}
+
+rosbag2_storage::FileInformation SequentialReader::file_information_from_storage(
+  size_t file_index)
+{
+  const auto file_metadata = get_storage(file_paths_[file_index])->get_metadata();
+  rosbag2_storage::FileInformation file_information{};
+  file_information.path = file_paths_[file_index];
+  file_information.starting_time = file_metadata.starting_time;
+  file_information.duration = file_metadata.duration;
+  file_information.message_count = file_metadata.message_count;
+  return file_information;
+}
+
+size_t SequentialReader::find_file_index(rcutils_time_point_value_t timestamp)
+{
+  if (file_paths_.empty()) {
+    return 0;
+  }
+  if (!has_file_summaries()) {
+    for (size_t file_index = 0; file_index < file_paths_.size(); ++file_index) {
+      const auto & time_range = get_file_time_range(file_index);
+      if (!time_range.empty && time_range.end >= timestamp) {
+        return file_index;
+      }
+    }
+    return file_paths_.size() - 1;
+  }
+
+  if (file_end_bounds_.empty()) {
+    // Running maximum of the file end times, empty files repeat the bound of their predecessor.
+    // This keeps the bounds sorted, so that the file can be found by bisection.
+    auto end_bound = std::numeric_limits<rcutils_time_point_value_t>::min();
+    for (size_t file_index = 0; file_index < file_paths_.size(); ++file_index) {
+      const auto & time_range = get_file_time_range(file_index);
+      if (!time_range.empty) {
+        end_bound = std::max(end_bound, time_range.end);
+      }
+      file_end_bounds_.push_back(end_bound);
+    }
+  }
+  auto file_index = std::min(
+    static_cast<size_t>(
+      std::lower_bound(file_end_bounds_.begin(), file_end_bounds_.end(), timestamp) -
+      file_end_bounds_.begin()),
+    file_paths_.size() - 1);
+  while (file_index + 1 < file_paths_.size() && get_file_time_range(file_index).empty) {
+    ++file_index;
+  }
+  return file_index;
+}
+
+std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface>
+SequentialReader::open_read_only_storage(const std::string & uri, const std::string & storage_id)
+{
+  if (read_immutable_) {
+    return storage_factory_->open_read_only_immutable(uri, storage_id);
+  }
+  return storage_factory_->open_read_only(uri, storage_id);
+}
+
 bool SequentialReader::has_next_file() const
 {
   return current_file_iterator_ + 1 != file_paths_.end();
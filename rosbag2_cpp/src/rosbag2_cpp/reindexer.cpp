@@ -0,0 +1,463 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rosbag2_cpp/reindexer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+# include <Windows.h>
+#else
+# include <dirent.h>
+#endif
+
+#include "rcpputils/filesystem_helper.hpp"
+
+#include "rosbag2_cpp/logging.hpp"
+
+#include "rosbag2_storage/storage_interfaces/read_only_interface.hpp"
+
+namespace rosbag2_cpp
+{
+
+namespace
+{
+// Indices are bounded so that they fit into int64_t.
+constexpr size_t MAX_BAGFILE_INDEX_DIGITS = 18;
+
+std::vector<std::string> list_directory(const std::string & directory)
+{
+  std::vector<std::string> file_names;
+#ifdef _WIN32
+  WIN32_FIND_DATAA find_data;
+  const auto pattern = (rcpputils::fs::path(directory) / "*").string();
+  HANDLE find_handle = FindFirstFileA(pattern.c_str(), &find_data);
+  if (find_handle == INVALID_HANDLE_VALUE) {
+    return file_names;
+  }
+  do {
+    if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      file_names.emplace_back(find_data.cFileName);
+    }
+  } while (FindNextFileA(find_handle, &find_data));
+  FindClose(find_handle);
+#else
+  DIR * dir = opendir(directory.c_str());
+  if (!dir) {
+    return file_names;
+  }
+  struct dirent * directory_entry;
+  while ((directory_entry = readdir(dir)) != nullptr) {
+    if (directory_entry->d_type != DT_DIR) {
+      file_names.emplace_back(directory_entry->d_name);
+    }
+  }
+  closedir(dir);
+#endif
+  return file_names;
+}
+
+// Index of a bagfile named `<prefix><index>` with an optional extension, or -1 for other files,
+// e.g. the journals the storage keeps next to its files.
+int64_t get_bagfile_index_by_prefix(const std::string & file_name, const std::string & prefix)
+{
+  if (file_name.compare(0, prefix.size(), prefix) != 0) {
+    return -1;
+  }
+  auto index_end = prefix.size();
+  while (index_end < file_name.size() &&
+    std::isdigit(static_cast<unsigned char>(file_name[index_end])))
+  {
+    ++index_end;
+  }
+  const auto digits = index_end - prefix.size();
+  if (digits == 0 || digits > MAX_BAGFILE_INDEX_DIGITS) {
+    return -1;
+  }
+  const auto extension = file_name.substr(index_end);
+  if (!extension.empty() && (extension[0] != '.' || extension.find('-') != std::string::npos)) {
+    return -1;
+  }
+  return std::stoll(file_name.substr(prefix.size(), digits));
+}
+
+// Whether the bagfile was compressed as a whole, which appends the extension of the compression
+// format to the one of the storage, e.g. `bag_0.db3.zstd`.
+bool is_compressed_bagfile(const std::string & file_name, const std::string & prefix)
+{
+  const auto extension_start = file_name.find('.', prefix.size());
+  return extension_start != std::string::npos &&
+         file_name.find('.', extension_start + 1) != std::string::npos;
+}
+
+bool is_file_compression_mode(std::string compression_mode)
+{
+  std::transform(
+    compression_mode.begin(), compression_mode.end(), compression_mode.begin(),
+    [](unsigned char c) {return static_cast<char>(std::toupper(c));});
+  return compression_mode == "FILE";
+}
+
+// Whether the storage left a non-empty journal next to the bagfile, e.g. after a crash.
+// Readers of finalized bags open their files as immutable and ignore such journals.
+bool has_pending_journal(const std::string & path)
+{
+  for (const auto suffix : {"-wal", "-journal"}) {
+    const rcpputils::fs::path journal(path + suffix);
+    if (journal.exists() && journal.file_size() > 0u) {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct FileSummary
+{
+  bool summarized = false;
+  // The journal of the file could not be merged into it.
+  bool journal_pending = false;
+  rosbag2_storage::BagMetadata metadata{};
+  // Also holds the topics without messages in the file.
+  std::vector<rosbag2_storage::TopicMetadata> topics{};
+  std::string error{};
+};
+
+FileSummary summarize_file(
+  rosbag2_storage::StorageFactoryInterface & storage_factory,
+  const std::string & path,
+  const std::string & storage_id)
+{
+  FileSummary summary;
+  if (has_pending_journal(path)) {
+    // Opening the bagfile for writing lets the storage recover it, merging the committed data of
+    // the journal into the file.
+    try {
+      storage_factory.open_read_write(
+        rcpputils::fs::remove_extension(rcpputils::fs::path(path)).string(), storage_id).reset();
+    } catch (const std::exception & e) {
+      ROSBAG2_CPP_LOG_WARN_STREAM("Failed to recover bagfile " << path << ": " << e.what());
+    }
+    summary.journal_pending = has_pending_journal(path);
+  }
+  try {
+    auto storage = storage_factory.open_read_only(path, storage_id);
+    if (!storage) {
+      summary.error = "the storage could not be opened";
+      return summary;
+    }
+    summary.metadata = storage->get_metadata();
+    summary.topics = storage->get_all_topics_and_types();
+    summary.summarized = true;
+  } catch (const std::exception & e) {
+    summary.error = e.what();
+  }
+  return summary;
+}
+
+// Summaries of the files which a metadata snapshot of an unfinished recording lists as complete,
+// i.e. all of its files but the last one, by file name. Empty for any other metadata.
+std::map<std::string, rosbag2_storage::FileInformation> get_closed_file_summaries(
+  const rosbag2_storage::BagMetadata & metadata)
+{
+  std::map<std::string, rosbag2_storage::FileInformation> closed_files;
+  // Topic statistics, which complete the file summaries, are written since version 8.
+  if (metadata.finalized || metadata.version < 8 || metadata.files.empty() ||
+    metadata.files.size() != metadata.relative_file_paths.size())
+  {
+    return closed_files;
+  }
+  for (size_t file = 0; file + 1 < metadata.files.size(); ++file) {
+    closed_files.emplace(
+      rcpputils::fs::path(metadata.files[file].path).filename().string(), metadata.files[file]);
+  }
+  return closed_files;
+}
+
+// Summary of a complete file taken from a metadata snapshot, without opening the file. The
+// snapshot only holds statistics of each topic over all of its files, which also cover the part
+// of the last file written before the snapshot. So the time range of a topic in the file is
+// bounded by the one of the file, and its bytes are split in proportion to its messages.
+FileSummary summarize_closed_file(
+  const rosbag2_storage::FileInformation & file_information,
+  const std::vector<rosbag2_storage::TopicInformation> & snapshot_topics)
+{
+  FileSummary summary;
+  summary.metadata.starting_time = file_information.starting_time;
+  summary.metadata.duration = file_information.duration;
+  summary.metadata.message_count = file_information.message_count;
+  const auto file_end_time = file_information.starting_time + file_information.duration;
+  for (const auto & snapshot_topic : snapshot_topics) {
+    summary.topics.push_back(snapshot_topic.topic_metadata);
+    const auto topic_message_count =
+      file_information.topics_message_count.find(snapshot_topic.topic_metadata.name);
+    if (topic_message_count == file_information.topics_message_count.end() ||
+      snapshot_topic.message_count == 0)
+    {
+      continue;
+    }
+    rosbag2_storage::TopicInformation file_topic{
+      snapshot_topic.topic_metadata, topic_message_count->second};
+    file_topic.starting_time =
+      std::max(snapshot_topic.starting_time, file_information.starting_time);
+    const auto topic_end_time =
+      std::min(snapshot_topic.starting_time + snapshot_topic.duration, file_end_time);
+    file_topic.duration = std::max<std::chrono::nanoseconds>(
+      topic_end_time - file_topic.starting_time, std::chrono::nanoseconds(0));
+    file_topic.total_bytes = static_cast<uint64_t>(
+      std::llround(
+        static_cast<double>(snapshot_topic.total_bytes) *
+        static_cast<double>(topic_message_count->second) /
+        static_cast<double>(snapshot_topic.message_count)));
+    summary.metadata.topics_with_message_count.push_back(std::move(file_topic));
+  }
+  summary.summarized = true;
+  return summary;
+}
+
+void merge_topic_information(
+  rosbag2_storage::TopicInformation & merged,
+  const rosbag2_storage::TopicInformation & file_topic)
+{
+  if (file_topic.message_count == 0) {
+    return;
+  }
+  if (merged.message_count == 0) {
+    merged.starting_time = file_topic.starting_time;
+    merged.duration = file_topic.duration;
+  } else {
+    const auto end_time = std::max(
+      merged.starting_time + merged.duration, file_topic.starting_time + file_topic.duration);
+    merged.starting_time = std::min(merged.starting_time, file_topic.starting_time);
+    merged.duration = end_time - merged.starting_time;
+  }
+  merged.message_count += file_topic.message_count;
+  merged.total_bytes += file_topic.total_bytes;
+}
+
+}  // namespace
+
+Reindexer::Reindexer(
+  std::unique_ptr<rosbag2_storage::StorageFactoryInterface> storage_factory,
+  std::unique_ptr<rosbag2_storage::MetadataIo> metadata_io)
+: storage_factory_(std::move(storage_factory)),
+  metadata_io_(std::move(metadata_io))
+{}
+
+std::vector<std::string> Reindexer::find_bagfiles(const std::string & uri)
+{
+  const auto prefix = rcpputils::fs::path(uri).filename().string() + "_";
+  std::vector<std::pair<int64_t, std::string>> indexed_file_names;
+  for (const auto & file_name : list_directory(uri)) {
+    const auto index = get_bagfile_index_by_prefix(file_name, prefix);
+    if (index >= 0) {
+      indexed_file_names.emplace_back(index, file_name);
+    }
+  }
+  std::sort(indexed_file_names.begin(), indexed_file_names.end());
+
+  std::vector<std::string> bagfiles;
+  bagfiles.reserve(indexed_file_names.size());
+  for (const auto & indexed_file_name : indexed_file_names) {
+    bagfiles.push_back((rcpputils::fs::path(uri) / indexed_file_name.second).string());
+  }
+  return bagfiles;
+}
+
+int64_t Reindexer::get_bagfile_index(const std::string & uri, const std::string & path)
+{
+  return get_bagfile_index_by_prefix(
+    rcpputils::fs::path(path).filename().string(),
+    rcpputils::fs::path(uri).filename().string() + "_");
+}
+
+rosbag2_storage::BagMetadata Reindexer::reindex(
+  const StorageOptions & storage_options, size_t thread_count)
+{
+  const auto & uri = storage_options.uri;
+  if (!rcpputils::fs::path(uri).is_directory()) {
+    throw std::runtime_error("Bag directory " + uri + " does not exist.");
+  }
+
+  // The existing metadata may be stale or incomplete, but still knows how the bag was written.
+  rosbag2_storage::BagMetadata previous_metadata{};
+  bool has_previous_metadata = false;
+  if (metadata_io_->metadata_file_exists(uri)) {
+    try {
+      previous_metadata = metadata_io_->read_metadata(uri);
+      has_previous_metadata = true;
+    } catch (const std::exception & e) {
+      ROSBAG2_CPP_LOG_WARN_STREAM("Ignoring unreadable metadata of " << uri << ": " << e.what());
+    }
+  }
+  auto storage_id = storage_options.storage_id;
+  if (storage_id.empty() && has_previous_metadata) {
+    storage_id = previous_metadata.storage_identifier;
+  }
+  if (storage_id.empty()) {
+    throw std::runtime_error(
+            "The storage id of the bag " + uri + " is unknown. Please specify it.");
+  }
+
+  const auto bagfiles = find_bagfiles(uri);
+  if (bagfiles.empty()) {
+    throw std::runtime_error("No bagfiles found in " + uri + ".");
+  }
+  // The storage cannot open files compressed as a whole, and leaving them out would describe a
+  // compressed bag with only some of its files.
+  const auto prefix = rcpputils::fs::path(uri).filename().string() + "_";
+  const bool has_compressed_bagfile = std::any_of(
+    bagfiles.begin(), bagfiles.end(), [&prefix](const std::string & bagfile) {
+      return is_compressed_bagfile(rcpputils::fs::path(bagfile).filename().string(), prefix);
+    });
+  if (has_compressed_bagfile ||
+    (has_previous_metadata && is_file_compression_mode(previous_metadata.compression_mode)))
+  {
+    throw std::runtime_error(
+            "The bag " + uri + " is compressed per file, which cannot be reindexed. "
+            "Decompress its bagfiles first.");
+  }
+
+  // A snapshot of a recording which did not finish summarizes all files it lists but the last
+  // one, which may have been written to afterwards. Only that file and the files created after
+  // the snapshot are opened.
+  const auto closed_files = get_closed_file_summaries(previous_metadata);
+  std::vector<FileSummary> summaries(bagfiles.size());
+  size_t unsummarized_file_count = 0;
+  for (size_t file = 0; file < bagfiles.size(); ++file) {
+    const auto closed_file =
+      closed_files.find(rcpputils::fs::path(bagfiles[file]).filename().string());
+    if (closed_file != closed_files.end()) {
+      summaries[file] =
+        summarize_closed_file(closed_file->second, previous_metadata.topics_with_message_count);
+    } else {
+      ++unsummarized_file_count;
+    }
+  }
+
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, unsummarized_file_count);
+
+  // Each file is summarized by the first thread to take it; the calling thread helps out.
+  std::atomic<size_t> next_file{0};
+  auto summarize_files = [&]() {
+      for (size_t file = next_file++; file < bagfiles.size(); file = next_file++) {
+        if (!summaries[file].summarized) {
+          summaries[file] = summarize_file(*storage_factory_, bagfiles[file], storage_id);
+        }
+      }
+    };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(summarize_files);
+  }
+  summarize_files();
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  rosbag2_storage::BagMetadata metadata{};
+  metadata.storage_identifier = storage_id;
+  metadata.compression_format = previous_metadata.compression_format;
+  metadata.compression_mode = previous_metadata.compression_mode;
+  metadata.message_count = 0;
+  metadata.duration = std::chrono::nanoseconds(0);
+  metadata.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+    std::chrono::nanoseconds::max());
+  auto end_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+    std::chrono::nanoseconds::min());
+  // Ordered by name, so that reindexing the same files yields the same metadata.
+  std::map<std::string, rosbag2_storage::TopicInformation> topics;
+  bool journals_merged = true;
+
+  for (size_t file = 0; file < bagfiles.size(); ++file) {
+    const auto & summary = summaries[file];
+    if (!summary.summarized) {
+      ROSBAG2_CPP_LOG_WARN_STREAM(
+        "Leaving out bagfile " << bagfiles[file] << ", which could not be read: " <<
+          summary.error);
+      continue;
+    }
+    if (summary.journal_pending) {
+      ROSBAG2_CPP_LOG_WARN_STREAM(
+        "Bagfile " << bagfiles[file] << " has a journal which could not be merged into it. " <<
+          "The bag is not marked as finalized.");
+      journals_merged = false;
+    }
+
+    rosbag2_storage::FileInformation file_information{};
+    file_information.path = rcpputils::fs::path(bagfiles[file]).filename().string();
+    file_information.starting_time = summary.metadata.starting_time;
+    file_information.duration = summary.metadata.duration;
+    file_information.message_count = summary.metadata.message_count;
+
+    for (const auto & topic : summary.topics) {
+      topics.emplace(topic.name, rosbag2_storage::TopicInformation{topic, 0});
+    }
+    for (const auto & file_topic : summary.metadata.topics_with_message_count) {
+      if (file_topic.message_count == 0) {
+        continue;
+      }
+      file_information.topics_message_count[file_topic.topic_metadata.name] =
+        file_topic.message_count;
+      auto topic = topics.emplace(
+        file_topic.topic_metadata.name,
+        rosbag2_storage::TopicInformation{file_topic.topic_metadata, 0});
+      merge_topic_information(topic.first->second, file_topic);
+    }
+
+    if (file_information.message_count > 0) {
+      metadata.starting_time = std::min(metadata.starting_time, file_information.starting_time);
+      end_time = std::max(end_time, file_information.starting_time + file_information.duration);
+      metadata.message_count += file_information.message_count;
+    }
+    metadata.bag_size += rcpputils::fs::path(bagfiles[file]).file_size();
+    metadata.relative_file_paths.push_back(file_information.path);
+    metadata.files.push_back(std::move(file_information));
+  }
+
+  if (metadata.files.empty()) {
+    throw std::runtime_error("None of the bagfiles in " + uri + " could be read.");
+  }
+  if (metadata.message_count > 0) {
+    metadata.duration = end_time - metadata.starting_time;
+  } else {
+    metadata.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+      std::chrono::nanoseconds(0));
+  }
+  for (auto & topic : topics) {
+    metadata.topics_with_message_count.push_back(std::move(topic.second));
+  }
+  // The files are complete as they are on disk now, and are not written to anymore. Readers of
+  // finalized bags would miss data still held in a journal, though.
+  metadata.finalized = journals_merged;
+
+  metadata_io_->write_metadata(uri, metadata);
+  return metadata;
+}
+
+}  // namespace rosbag2_cpp
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <future>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -58,9 +59,10 @@ void Writer::open(
   writer_impl_->open(storage_options, converter_options);
 }
 
-void Writer::create_topic(const rosbag2_storage::TopicMetadata & topic_with_type)
+writer_interfaces::BaseWriterInterface::TopicHandle
+Writer::create_topic(const rosbag2_storage::TopicMetadata & topic_with_type)
 {
-  writer_impl_->create_topic(topic_with_type);
+  return writer_impl_->create_topic(topic_with_type);
 }
 
 void Writer::remove_topic(const rosbag2_storage::TopicMetadata & topic_with_type)
@@ -73,4 +75,41 @@ void Writer::write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> messag
   writer_impl_->write(message);
 }
 
+void Writer::write(rosbag2_storage::SerializedBagMessage && message)
+{
+  writer_impl_->write(std::move(message));
+}
+
+void Writer::write(std::unique_ptr<rosbag2_storage::SerializedBagMessage> message)
+{
+  writer_impl_->write(std::move(message));
+}
+
+void Writer::write(
+  writer_interfaces::BaseWriterInterface::TopicHandle topic,
+  rcutils_time_point_value_t time_stamp,
+  std::shared_ptr<rcutils_uint8_array_t> serialized_data)
+{
+  writer_impl_->write(topic, time_stamp, std::move(serialized_data));
+}
+
+void Writer::write_with_id(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+  writer_interfaces::BaseWriterInterface::MessageIdCallback on_written)
+{
+  writer_impl_->write_with_id(message, std::move(on_written));
+}
+
+std::future<int32_t> Writer::write_with_id(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message)
+{
+  auto id_promise = std::make_shared<std::promise<int32_t>>();
+  auto id_future = id_promise->get_future();
+  writer_impl_->write_with_id(
+    message, [id_promise](int32_t id) {
+      id_promise->set_value(id);
+    });
+  return id_future;
+}
+
 }  // namespace rosbag2_cpp
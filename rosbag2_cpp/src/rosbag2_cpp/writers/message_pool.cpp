@@ -0,0 +1,205 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rosbag2_cpp/writers/message_pool.hpp"
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace rosbag2_cpp
+{
+namespace writers
+{
+
+struct MessagePool::State
+{
+  explicit State(size_t max_size)
+  : max_size(max_size)
+  {}
+
+  ~State()
+  {
+    for (auto message : free_messages) {
+      delete message;
+    }
+    for (auto block : free_control_blocks) {
+      ::operator delete(block);
+    }
+  }
+
+  void * allocate_control_block(size_t size)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (size == control_block_size && !free_control_blocks.empty()) {
+        auto block = free_control_blocks.back();
+        free_control_blocks.pop_back();
+        return block;
+      }
+    }
+    return ::operator new(size);
+  }
+
+  void deallocate_control_block(void * block, size_t size)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      // All pooled messages share the type of control block, so its size is found once.
+      if (control_block_size == 0) {
+        control_block_size = size;
+      }
+      if (size == control_block_size && free_control_blocks.size() < max_size) {
+        free_control_blocks.push_back(block);
+        return;
+      }
+    }
+    ::operator delete(block);
+  }
+
+  std::mutex mutex;
+  // Messages and control blocks are reused most recently returned first, while still in cache.
+  std::vector<rosbag2_storage::SerializedBagMessage *> free_messages;
+  std::vector<void *> free_control_blocks;
+  size_t control_block_size = 0;
+  // Messages owned by the pool, free or not.
+  size_t size = 0;
+  const size_t max_size;
+};
+
+// Allocates the control blocks of pooled messages from the free list of the pool.
+template<typename T>
+class MessagePool::ControlBlockAllocator
+{
+public:
+  using value_type = T;
+
+  explicit ControlBlockAllocator(std::shared_ptr<State> state)
+  : state_(std::move(state))
+  {}
+
+  template<typename U>
+  ControlBlockAllocator(const ControlBlockAllocator<U> & other)  // NOLINT
+  : state_(other.state_)
+  {}
+
+  T * allocate(size_t count)
+  {
+    return static_cast<T *>(state_->allocate_control_block(count * sizeof(T)));
+  }
+
+  void deallocate(T * block, size_t count)
+  {
+    state_->deallocate_control_block(block, count * sizeof(T));
+  }
+
+  template<typename U>
+  bool operator==(const ControlBlockAllocator<U> & other) const
+  {
+    return state_ == other.state_;
+  }
+
+  template<typename U>
+  bool operator!=(const ControlBlockAllocator<U> & other) const
+  {
+    return state_ != other.state_;
+  }
+
+private:
+  template<typename U>
+  friend class ControlBlockAllocator;
+
+  // Keeps the pool state alive until the control block is deallocated.
+  std::shared_ptr<State> state_;
+};
+
+// Resets a pooled message once its last reference is gone and puts it on the free list.
+class MessagePool::Recycler
+{
+public:
+  explicit Recycler(std::shared_ptr<State> state)
+  : state_(std::move(state))
+  {}
+
+  void operator()(rosbag2_storage::SerializedBagMessage * message) const
+  {
+    message->serialized_data.reset();
+    message->time_stamp = 0;
+    message->topic_name.clear();
+    message->database_index = 0;
+    message->has_key = false;
+    message->key = 0;
+    message->topic_id = -1;
+
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->free_messages.push_back(message);
+  }
+
+private:
+  std::shared_ptr<State> state_;
+};
+
+constexpr size_t MessagePool::DEFAULT_MAX_SIZE;
+
+MessagePool::MessagePool(size_t max_size)
+: state_(std::make_shared<State>(max_size))
+{}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage> MessagePool::acquire()
+{
+  rosbag2_storage::SerializedBagMessage * message = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (!state_->free_messages.empty()) {
+      message = state_->free_messages.back();
+      state_->free_messages.pop_back();
+    } else if (state_->size < state_->max_size) {
+      ++state_->size;
+    } else {
+      return std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    }
+  }
+  if (message == nullptr) {
+    try {
+      message = new rosbag2_storage::SerializedBagMessage();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      --state_->size;
+      throw;
+    }
+  }
+  // Should the control block fail to allocate, the recycler returns the message to the pool.
+  return std::shared_ptr<rosbag2_storage::SerializedBagMessage>(
+    message, Recycler(state_),
+    ControlBlockAllocator<rosbag2_storage::SerializedBagMessage>(state_));
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage> MessagePool::acquire(
+  rosbag2_storage::SerializedBagMessage && message)
+{
+  auto pooled_message = acquire();
+  *pooled_message = std::move(message);
+  return pooled_message;
+}
+
+size_t MessagePool::size() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->size;
+}
+
+}  // namespace writers
+}  // namespace rosbag2_cpp
@@ -0,0 +1,94 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rosbag2_cpp/writers/metadata_snapshot_writer.hpp"
+
+#include <exception>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rosbag2_cpp/logging.hpp"
+
+namespace rosbag2_cpp
+{
+namespace writers
+{
+
+MetadataSnapshotWriter::~MetadataSnapshotWriter()
+{
+  stop();
+}
+
+void MetadataSnapshotWriter::start(
+  rosbag2_storage::MetadataIo & metadata_io, const std::string & uri)
+{
+  stop();
+  metadata_io_ = &metadata_io;
+  uri_ = uri;
+  stop_ = false;
+  thread_ = std::thread(&MetadataSnapshotWriter::run, this);
+}
+
+void MetadataSnapshotWriter::write(rosbag2_storage::BagMetadata metadata)
+{
+  if (!thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_snapshots_.push_back(std::move(metadata));
+  }
+  condition_.notify_one();
+}
+
+void MetadataSnapshotWriter::stop()
+{
+  if (!thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+  metadata_io_ = nullptr;
+}
+
+void MetadataSnapshotWriter::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    condition_.wait(lock, [this] {return !pending_snapshots_.empty() || stop_;});
+    if (pending_snapshots_.empty()) {
+      return;
+    }
+
+    auto snapshot = std::move(pending_snapshots_.front());
+    pending_snapshots_.pop_front();
+    lock.unlock();
+    try {
+      metadata_io_->write_metadata(uri_, snapshot);
+    } catch (const std::exception & e) {
+      ROSBAG2_CPP_LOG_WARN_STREAM("Failed to write a metadata snapshot: " << e.what());
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace writers
+}  // namespace rosbag2_cpp
@@ -16,17 +16,26 @@
 
 #include <algorithm>
 #include <chrono>
+#include <future>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <iostream>
 
 #include "rcpputils/filesystem_helper.hpp"
 
 #include "rosbag2_cpp/info.hpp"
+#include "rosbag2_cpp/logging.hpp"
+#include "rosbag2_cpp/reindexer.hpp"
 #include "rosbag2_cpp/storage_options.hpp"
 
+#include "rosbag2_storage/topic_statistics.hpp"
+
 namespace rosbag2_cpp
 {
 namespace writers
@@ -50,6 +59,13 @@ std::string strip_parent_path(const std::string & relative_path)
   return rcpputils::fs::path(relative_path).filename().string();
 }
 
+rosbag2_storage::FileInformation make_file_information(const std::string & path)
+{
+  rosbag2_storage::FileInformation file_information{};
+  file_information.path = path;
+  return file_information;
+}
+
 }  // namespace
 
 SequentialWriter::SequentialWriter(
@@ -80,6 +96,68 @@ void SequentialWriter::init_metadata()
   metadata_.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
     std::chrono::nanoseconds::max());
   metadata_.relative_file_paths = {strip_parent_path(storage_->get_relative_file_path())};
+  metadata_.files = {make_file_information(metadata_.relative_file_paths.back())};
+  appended_topics_.clear();
+}
+
+rosbag2_storage::BagMetadata SequentialWriter::read_appended_metadata(
+  const StorageOptions & storage_options)
+{
+  if (!metadata_io_->metadata_file_exists(base_folder_)) {
+    throw std::runtime_error(
+            "Cannot append to bag " + base_folder_ + " without metadata. "
+            "Run `ros2 bag reindex` on it first.");
+  }
+
+  auto metadata = metadata_io_->read_metadata(base_folder_);
+  if (!metadata.compression_format.empty()) {
+    throw std::runtime_error(
+            "Cannot append to bag " + base_folder_ + " because it is compressed.");
+  }
+  // Files are summarized since version 6, topic statistics since version 8.
+  if (metadata.version < 8 || metadata.files.size() != metadata.relative_file_paths.size()) {
+    throw std::runtime_error(
+            "Cannot append to bag " + base_folder_ + " because its metadata does not summarize "
+            "its files and topics. Run `ros2 bag reindex` on it first.");
+  }
+  // Metadata of a recording which did not finish, e.g. a snapshot, is stale and its last file
+  // may be incomplete.
+  if (!metadata.finalized) {
+    throw std::runtime_error(
+            "Cannot append to bag " + base_folder_ + " because its recording did not finish. "
+            "Run `ros2 bag reindex` on it first.");
+  }
+  if (!storage_options.storage_id.empty() &&
+    storage_options.storage_id != metadata.storage_identifier)
+  {
+    throw std::runtime_error(
+            "Cannot append to bag " + base_folder_ + " with storage " +
+            storage_options.storage_id + " because it is stored with " +
+            metadata.storage_identifier + ".");
+  }
+  return metadata;
+}
+
+void SequentialWriter::resume_metadata(rosbag2_storage::BagMetadata appended_metadata)
+{
+  metadata_ = std::move(appended_metadata);
+  metadata_.version = rosbag2_storage::BagMetadata{}.version;
+  metadata_.finalized = false;
+  // Bags written before version 4 store file paths relative to the parent of the bag.
+  for (auto & path : metadata_.relative_file_paths) {
+    path = strip_parent_path(path);
+  }
+  for (auto & file : metadata_.files) {
+    file.path = strip_parent_path(file.path);
+  }
+  metadata_.relative_file_paths.push_back(strip_parent_path(storage_->get_relative_file_path()));
+  metadata_.files.push_back(make_file_information(metadata_.relative_file_paths.back()));
+
+  appended_topics_.clear();
+  for (auto & topic : metadata_.topics_with_message_count) {
+    appended_topics_.emplace(topic.topic_metadata.name, std::move(topic));
+  }
+  metadata_.topics_with_message_count.clear();
 }
 
 void SequentialWriter::open(
@@ -89,9 +167,25 @@ void SequentialWriter::open(
   base_folder_ = storage_options.uri;
   max_bagfile_size_ = storage_options.max_bagfile_size;
   max_bagfile_duration = std::chrono::seconds(storage_options.max_bagfile_duration);
+  align_bagfile_duration_ = storage_options.align_bagfile_duration;
+  metadata_snapshot_interval_ = std::chrono::seconds(storage_options.metadata_snapshot_interval);
+  duration_split_time_ = std::numeric_limits<rcutils_time_point_value_t>::max();
   max_cache_size_ = storage_options.max_cache_size;
+  max_cache_bytes_ = storage_options.max_cache_bytes;
+  async_cache_flush_ = storage_options.async_cache_flush &&
+    (max_cache_size_ != 0u || max_cache_bytes_ != 0u);
+  drop_messages_on_full_cache_ = storage_options.drop_messages_on_full_cache;
+  concurrent_write_ = storage_options.concurrent_write;
+  max_queued_bytes_ = storage_options.max_queued_bytes;
+  default_backpressure_ = storage_options.default_backpressure;
+  topic_backpressure_ = storage_options.topic_backpressure;
+  prepare_next_file_ = storage_options.prepare_next_file &&
+    (max_bagfile_size_ != rosbag2_storage::storage_interfaces::MAX_BAGFILE_SIZE_NO_SPLIT ||
+    max_bagfile_duration != std::chrono::seconds(
+      rosbag2_storage::storage_interfaces::MAX_BAGFILE_DURATION_NO_SPLIT));
 
   cache_.reserve(max_cache_size_);
+  cache_id_callbacks_.reserve(max_cache_size_);
 
   if (converter_options.output_serialization_format !=
     converter_options.input_serialization_format)
@@ -99,24 +193,45 @@ void SequentialWriter::open(
     converter_ = std::make_unique<Converter>(converter_options, converter_factory_);
   }
 
+  // Until a bagfile is opened, there is no metadata to write for it. In particular, the metadata
+  // of a bag which cannot be appended to is left as it is.
+  metadata_ = rosbag2_storage::BagMetadata{};
+
   rcpputils::fs::path db_path(base_folder_);
-  if (db_path.is_directory()) {
+  const bool append = storage_options.append && db_path.is_directory();
+  rosbag2_storage::BagMetadata appended_metadata{};
+  next_storage_index_ = 0;
+  if (append) {
+    appended_metadata = read_appended_metadata(storage_options);
+    // The appended bagfile follows every bagfile of the bag, listed in its metadata or not.
+    auto bagfiles = Reindexer::find_bagfiles(base_folder_);
+    bagfiles.insert(
+      bagfiles.end(), appended_metadata.relative_file_paths.begin(),
+      appended_metadata.relative_file_paths.end());
+    for (const auto & bagfile : bagfiles) {
+      const auto index = Reindexer::get_bagfile_index(base_folder_, bagfile);
+      if (index >= 0) {
+        next_storage_index_ = std::max(next_storage_index_, static_cast<uint64_t>(index) + 1);
+      }
+    }
+  } else if (db_path.is_directory()) {
     std::stringstream error;
     error << "Database directory already exists (" << db_path.string() <<
       "), can't overwrite existing database";
     throw std::runtime_error{error.str()};
+  } else {
+    bool dir_created = rcpputils::fs::create_directories(db_path);
+    if (!dir_created) {
+      std::stringstream error;
+      error << "Failed to create database directory (" << db_path.string() << ").";
+      throw std::runtime_error{error.str()};
+    }
   }
 
-  bool dir_created = rcpputils::fs::create_directories(db_path);
-  if (!dir_created) {
-    std::stringstream error;
-    error << "Failed to create database directory (" << db_path.string() << ").";
-    throw std::runtime_error{error.str()};
-  }
-
-  const auto storage_uri = format_storage_uri(base_folder_, 0);
+  const auto storage_uri = format_storage_uri(base_folder_, next_storage_index_++);
 
-  storage_ = storage_factory_->open_read_write(storage_uri, storage_options.storage_id);
+  storage_ = storage_factory_->open_read_write(
+    storage_uri, append ? appended_metadata.storage_identifier : storage_options.storage_id);
   if (!storage_) {
     throw std::runtime_error("No storage could be initialized. Abort");
   }
@@ -131,22 +246,67 @@ void SequentialWriter::open(
     throw std::runtime_error{error.str()};
   }
 
-  init_metadata();
+  if (append) {
+    resume_metadata(std::move(appended_metadata));
+  } else {
+    init_metadata();
+  }
+  if (metadata_snapshot_interval_ != std::chrono::seconds::zero()) {
+    metadata_snapshot_writer_.start(*metadata_io_, base_folder_);
+    write_metadata_snapshot();
+  }
+  std::atomic_store(&topic_ingestion_, std::make_shared<const TopicIngestionIndex>());
+
+  if (async_cache_flush_) {
+    flush_cache_.reserve(max_cache_size_);
+    flush_id_callbacks_.reserve(max_cache_size_);
+    stop_flush_thread_ = false;
+    flush_thread_ = std::thread(&SequentialWriter::run_flush_thread, this);
+  }
+
+  if (concurrent_write_) {
+    stop_write_thread_ = false;
+    queued_bytes_ = 0;
+    accepting_queued_messages_ = true;
+    write_thread_ = std::thread(&SequentialWriter::run_write_thread, this);
+  }
 }
 
 void SequentialWriter::reset()
 {
-  if (!base_folder_.empty()) {
+  // Queued messages are written before the cache is flushed.
+  stop_write_thread();
+  if (storage_) {
+    flush_cache();
+  }
+  stop_flush_thread();
+  if (dropped_message_count_ > 0) {
+    ROSBAG2_CPP_LOG_WARN_STREAM(
+      "Dropped " << dropped_message_count_ << " messages because the cache was full.");
+    dropped_message_count_ = 0;
+  }
+  discard_next_storage();
+
+  // Close the storage before the metadata marks the bag as finalized, so that readers relying
+  // on that flag find completely written files.
+  storage_.reset();  // Necessary to ensure that the storage is destroyed before the factory
+  metadata_snapshot_writer_.stop();
+  if (!base_folder_.empty() && !metadata_.relative_file_paths.empty()) {
     finalize_metadata();
     metadata_io_->write_metadata(base_folder_, metadata_);
   }
 
-  storage_.reset();  // Necessary to ensure that the storage is destroyed before the factory
   storage_factory_.reset();
 }
 
-void SequentialWriter::create_topic(const rosbag2_storage::TopicMetadata & topic_with_type)
+SequentialWriter::TopicHandle SequentialWriter::create_topic(
+  const rosbag2_storage::TopicMetadata & topic_with_type)
 {
+  std::unique_lock<std::mutex> write_lock(write_mutex_, std::defer_lock);
+  if (concurrent_write_) {
+    write_lock.lock();
+  }
+
   if (!storage_) {
     throw std::runtime_error("Bag is not open. Call open() before writing.");
   }
@@ -155,33 +315,71 @@ void SequentialWriter::create_topic(const rosbag2_storage::TopicMetadata & topic
     converter_->add_topic(topic_with_type.name, topic_with_type.type);
   }
 
-  if (topics_names_to_info_.find(topic_with_type.name) ==
-    topics_names_to_info_.end())
-  {
-    rosbag2_storage::TopicInformation info{};
-    info.topic_metadata = topic_with_type;
-
-    const auto insert_res = topics_names_to_info_.insert(
-      std::make_pair(topic_with_type.name, info));
+  const auto existing_handle = topic_handles_.find(topic_with_type.name);
+  if (existing_handle != topic_handles_.end()) {
+    return existing_handle->second;
+  }
 
-    if (!insert_res.second) {
+  rosbag2_storage::TopicInformation info{};
+  // A topic of an appended bag continues its statistics.
+  const auto appended_topic = appended_topics_.find(topic_with_type.name);
+  if (appended_topic != appended_topics_.end()) {
+    if (appended_topic->second.topic_metadata.type != topic_with_type.type) {
       std::stringstream errmsg;
-      errmsg << "Failed to insert topic \"" << topic_with_type.name << "\"!";
+      errmsg << "Topic \"" << topic_with_type.name << "\" was recorded with type " <<
+        appended_topic->second.topic_metadata.type << ", cannot append messages of type " <<
+        topic_with_type.type << "!";
 
       throw std::runtime_error(errmsg.str());
     }
+    info = std::move(appended_topic->second);
+    appended_topics_.erase(appended_topic);
+  }
+  info.topic_metadata = topic_with_type;
+
+  const auto insert_res = topics_names_to_info_.insert(
+    std::make_pair(topic_with_type.name, info));
 
-    storage_->create_topic(topic_with_type);
+  if (!insert_res.second) {
+    std::stringstream errmsg;
+    errmsg << "Failed to insert topic \"" << topic_with_type.name << "\"!";
+
+    throw std::runtime_error(errmsg.str());
   }
+
+  const auto handle = static_cast<TopicHandle>(topics_by_handle_.size());
+  topics_by_handle_.push_back({&insert_res.first->second, -1});
+  topic_handles_.emplace(topic_with_type.name, handle);
+
+  // The storage must not be used concurrently with the flush thread.
+  wait_for_pending_flush();
+  storage_->create_topic(topic_with_type);
+  topics_by_handle_[handle].storage_topic_id = storage_->get_topic_id(topic_with_type.name);
+
+  update_topic_ingestion();
+  return handle;
 }
 
 void SequentialWriter::remove_topic(const rosbag2_storage::TopicMetadata & topic_with_type)
 {
+  std::unique_lock<std::mutex> write_lock(write_mutex_, std::defer_lock);
+  if (concurrent_write_) {
+    // Messages queued on the topic are written before it is removed.
+    wait_for_queued_messages();
+    write_lock.lock();
+  }
+
   if (!storage_) {
     throw std::runtime_error("Bag is not open. Call open() before removing.");
   }
 
-  if (topics_names_to_info_.erase(topic_with_type.name) > 0) {
+  const auto handle = topic_handles_.find(topic_with_type.name);
+  if (handle != topic_handles_.end()) {
+    topics_by_handle_[handle->second] = TopicEntry{};
+    topic_handles_.erase(handle);
+    topics_names_to_info_.erase(topic_with_type.name);
+    update_topic_ingestion();
+    wait_for_pending_flush();
     storage_->remove_topic(topic_with_type);
   } else {
     std::stringstream errmsg;
@@ -194,10 +392,20 @@ void SequentialWriter::remove_topic(const rosbag2_storage::TopicMetadata & topic
 
 void SequentialWriter::split_bagfile()
 {
-  const auto storage_uri = format_storage_uri(
-    base_folder_,
-    metadata_.relative_file_paths.size());
-  storage_ = storage_factory_->open_read_write(storage_uri, metadata_.storage_identifier);
+  // Cached messages belong to the bagfile being closed.
+  flush_cache();
+  messages_since_size_reconciliation_ = 0;
+  duration_split_time_ = std::numeric_limits<rcutils_time_point_value_t>::max();
+
+  const auto storage_uri = format_storage_uri(base_folder_, next_storage_index_++);
+  auto previous_storage = std::move(storage_);
+  std::vector<rosbag2_storage::TopicMetadata> registered_topics;
+  if (next_storage_.valid()) {
+    storage_ = next_storage_.get();
+    registered_topics.swap(next_storage_topics_);
+  } else {
+    storage_ = storage_factory_->open_read_write(storage_uri, metadata_.storage_identifier);
+  }
 
   if (!storage_) {
     std::stringstream errmsg;
@@ -207,34 +415,494 @@ void SequentialWriter::split_bagfile()
   }
 
   metadata_.relative_file_paths.push_back(strip_parent_path(storage_->get_relative_file_path()));
+  metadata_.files.push_back(make_file_information(metadata_.relative_file_paths.back()));
 
-  // Re-register all topics since we rolled-over to a new bagfile.
+  // Re-register all topics since we rolled-over to a new bagfile. A prepared bagfile only misses
+  // the topics that changed since it was prepared.
+  for (const auto & registered_topic : registered_topics) {
+    if (topics_names_to_info_.find(registered_topic.name) == topics_names_to_info_.end()) {
+      storage_->remove_topic(registered_topic);
+    }
+  }
   for (const auto & topic : topics_names_to_info_) {
-    storage_->create_topic(topic.second.topic_metadata);
+    const auto is_registered = std::any_of(
+      registered_topics.begin(), registered_topics.end(),
+      [&topic](const rosbag2_storage::TopicMetadata & registered_topic) {
+        return registered_topic.name == topic.first;
+      });
+    if (!is_registered) {
+      storage_->create_topic(topic.second.topic_metadata);
+    }
+  }
+  update_storage_topic_ids();
+
+  if (prepare_next_file_) {
+    prepare_next_storage(std::move(previous_storage));
+  }
+
+  if (metadata_snapshot_interval_ != std::chrono::seconds::zero()) {
+    write_metadata_snapshot();
   }
 }
 
-void SequentialWriter::write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> message)
+void SequentialWriter::update_storage_topic_ids()
 {
-  if (!storage_) {
-    throw std::runtime_error("Bag is not open. Call open() before writing.");
+  for (auto & topic_entry : topics_by_handle_) {
+    if (topic_entry.information) {
+      topic_entry.storage_topic_id =
+        storage_->get_topic_id(topic_entry.information->topic_metadata.name);
+    }
+  }
+}
+
+void SequentialWriter::prepare_next_storage(
+  std::shared_ptr<rosbag2_storage::storage_interfaces::ReadWriteInterface> previous_storage)
+{
+  next_storage_topics_.clear();
+  for (const auto & topic : topics_names_to_info_) {
+    next_storage_topics_.push_back(topic.second.topic_metadata);
+  }
+
+  const auto storage_uri = format_storage_uri(base_folder_, next_storage_index_);
+  // The task only touches the storage factory, which is not used otherwise until the prepared
+  // storage is taken over or discarded.
+  next_storage_ = std::async(
+    std::launch::async,
+    [this, storage_uri, storage_id = metadata_.storage_identifier, topics = next_storage_topics_,
+    previous_storage = std::move(previous_storage)]() mutable {
+      previous_storage.reset();
+      auto storage = storage_factory_->open_read_write(storage_uri, storage_id);
+      if (storage) {
+        for (const auto & topic : topics) {
+          storage->create_topic(topic);
+        }
+      }
+      return storage;
+    });
+}
+
+void SequentialWriter::discard_next_storage()
+{
+  if (!next_storage_.valid()) {
+    return;
   }
 
-  // Update the message count for the Topic.
   try {
-    ++topics_names_to_info_.at(message->topic_name).message_count;
-  } catch (const std::out_of_range & /* oor */) {
+    auto storage = next_storage_.get();
+    if (storage) {
+      const auto path = rcpputils::fs::path(storage->get_relative_file_path());
+      storage.reset();
+      rcpputils::fs::remove(path);
+    }
+  } catch (const std::exception & e) {
+    // Nothing was written to the prepared bagfile yet, so its failure does not affect the bag.
+    ROSBAG2_CPP_LOG_WARN_STREAM("Failed to prepare the next bagfile: " << e.what());
+  }
+  next_storage_topics_.clear();
+}
+
+void SequentialWriter::write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> message)
+{
+  if (concurrent_write_) {
+    queue_message(std::move(message), nullptr);
+  } else {
+    write_message(message, nullptr);
+  }
+}
+
+void SequentialWriter::write(rosbag2_storage::SerializedBagMessage && message)
+{
+  write(message_pool_.acquire(std::move(message)));
+}
+
+void SequentialWriter::write(std::unique_ptr<rosbag2_storage::SerializedBagMessage> message)
+{
+  if (!message) {
+    throw std::runtime_error("Cannot write a null message.");
+  }
+  write(std::move(*message));
+}
+
+void SequentialWriter::write(
+  TopicHandle topic,
+  rcutils_time_point_value_t time_stamp,
+  std::shared_ptr<rcutils_uint8_array_t> serialized_data)
+{
+  auto message = message_pool_.acquire();
+  message->serialized_data = std::move(serialized_data);
+  message->time_stamp = time_stamp;
+
+  if (concurrent_write_) {
+    const auto topic_ingestion = load_topic_ingestion();
+    if (topic >= topic_ingestion->by_handle.size() || !topic_ingestion->by_handle[topic]) {
+      std::stringstream errmsg;
+      errmsg << "Failed to write on topic handle " << topic <<
+        ". Call create_topic() before first write.";
+      throw std::runtime_error(errmsg.str());
+    }
+    queue_message(topic_ingestion->by_handle[topic], std::move(message), nullptr);
+  } else {
+    write_message(topic, std::move(message), nullptr);
+  }
+}
+
+void SequentialWriter::write_with_id(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+  MessageIdCallback on_written)
+{
+  if (concurrent_write_) {
+    queue_message(std::move(message), std::move(on_written));
+  } else {
+    write_message(message, on_written);
+  }
+}
+
+void SequentialWriter::queue_message(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+  MessageIdCallback on_written)
+{
+  const auto topic_ingestion = load_topic_ingestion();
+  const auto topic = topic_ingestion->by_name.find(message->topic_name);
+  if (topic == topic_ingestion->by_name.end()) {
     std::stringstream errmsg;
     errmsg << "Failed to write on topic '" << message->topic_name <<
       "'. Call create_topic() before first write.";
     throw std::runtime_error(errmsg.str());
   }
+  queue_message(topic->second, std::move(message), std::move(on_written));
+}
+
+std::shared_ptr<const SequentialWriter::TopicIngestionIndex>
+SequentialWriter::load_topic_ingestion()
+{
+  rethrow_write_error();
+
+  if (!accepting_queued_messages_) {
+    throw std::runtime_error("Bag is not open. Call open() before writing.");
+  }
+  return std::atomic_load(&topic_ingestion_);
+}
+
+void SequentialWriter::queue_message(
+  const std::shared_ptr<TopicIngestion> & topic,
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+  MessageIdCallback on_written)
+{
+  const uint64_t size = message->serialized_data ? message->serialized_data->buffer_length : 0u;
+  if (!admit_message(*topic, size)) {
+    return;
+  }
+
+  bool wake_write_thread = false;
+  {
+    // The writer may have been closed since load_topic_ingestion(). stop_write_thread() stops
+    // accepting under this lock, so every message pushed here is still written.
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (!accepting_queued_messages_) {
+      queued_bytes_ -= size;
+      ++topic->dropped_message_count;
+      topic->dropped_bytes += size;
+      return;
+    }
+    ++topic->queued_message_count;
+    write_queue_.push({std::move(message), std::move(on_written), topic, size});
+    // The write thread only waits once it found the queue empty, so it needs to be woken up for
+    // the first message queued after that.
+    wake_write_thread = queued_message_count_.fetch_add(1) == 0;
+  }
+  if (wake_write_thread) {
+    queue_condition_.notify_all();
+  }
+}
+
+bool SequentialWriter::admit_message(TopicIngestion & topic, uint64_t size)
+{
+  if (max_queued_bytes_ == 0u || try_reserve_queued_bytes(size)) {
+    return true;
+  }
 
-  if (should_split_bagfile()) {
+  switch (topic.backpressure.policy) {
+    case BackpressurePolicy::BLOCK:
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_condition_.wait(
+          lock, [this, size] {return stop_write_thread_ || try_reserve_queued_bytes(size);});
+        if (!stop_write_thread_) {
+          return true;
+        }
+        // The writer is closing and would not write the message anymore.
+        break;
+      }
+    case BackpressurePolicy::DROP_NEWEST:
+      break;
+    case BackpressurePolicy::DROP_OLDEST:
+      // The write thread drops the oldest queued message of the topic in place of this one.
+      if (topic.queued_message_count > topic.pending_drop_count) {
+        ++topic.pending_drop_count;
+        queued_bytes_ += size;
+        return true;
+      }
+      break;
+    case BackpressurePolicy::KEEP_EVERY_NTH:
+      if (topic.over_budget_count++ % std::max<uint64_t>(topic.backpressure.keep_every_nth, 1u) ==
+        0u)
+      {
+        queued_bytes_ += size;
+        return true;
+      }
+      break;
+  }
+
+  ++topic.dropped_message_count;
+  topic.dropped_bytes += size;
+  return false;
+}
+
+bool SequentialWriter::try_reserve_queued_bytes(uint64_t size)
+{
+  auto queued_bytes = queued_bytes_.load();
+  do {
+    // A single message exceeding the budget is still accepted into an empty queue.
+    if (queued_bytes != 0u && queued_bytes + size > max_queued_bytes_) {
+      return false;
+    }
+  } while (!queued_bytes_.compare_exchange_weak(queued_bytes, queued_bytes + size));
+  return true;
+}
+
+void SequentialWriter::wait_for_queued_messages()
+{
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  queue_condition_.wait(lock, [this] {return queued_message_count_ <= 0;});
+}
+
+void SequentialWriter::rethrow_write_error()
+{
+  if (!has_write_error_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  has_write_error_ = false;
+  if (write_error_) {
+    std::rethrow_exception(std::exchange(write_error_, nullptr));
+  }
+}
+
+void SequentialWriter::run_write_thread()
+{
+  std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+  while (true) {
+    queue_condition_.wait(
+      queue_lock, [this] {return queued_message_count_ > 0 || stop_write_thread_;});
+    if (queued_message_count_ <= 0) {
+      return;
+    }
+
+    queue_lock.unlock();
+    {
+      std::lock_guard<std::mutex> write_lock(write_mutex_);
+      // Only the messages queued so far are written in one go, so that other threads waiting
+      // for the lock get their turn.
+      for (auto remaining = queued_message_count_.load(); remaining > 0; --remaining) {
+        QueuedMessage queued;
+        // A counted message has been pushed, but may not be linked into the queue yet.
+        while (!write_queue_.try_pop(queued)) {
+          std::this_thread::yield();
+        }
+        --queued_message_count_;
+        try {
+          write_queued_message(queued);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(queue_mutex_);
+          write_error_ = std::current_exception();
+          has_write_error_ = true;
+        }
+      }
+    }
+    queue_lock.lock();
+    queue_condition_.notify_all();
+  }
+}
+
+void SequentialWriter::write_queued_message(QueuedMessage & queued)
+{
+  auto & topic = *queued.topic;
+  --topic.queued_message_count;
+  auto pending_drop_count = topic.pending_drop_count.load();
+  while (pending_drop_count > 0u &&
+    !topic.pending_drop_count.compare_exchange_weak(pending_drop_count, pending_drop_count - 1))
+  {}
+
+  if (pending_drop_count > 0u) {
+    ++topic.dropped_message_count;
+    topic.dropped_bytes += queued.size;
+  } else {
+    write_message(topic.handle, std::move(queued.message), queued.on_written);
+  }
+  queued_bytes_ -= queued.size;
+}
+
+void SequentialWriter::stop_write_thread()
+{
+  if (!write_thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    accepting_queued_messages_ = false;
+    stop_write_thread_ = true;
+  }
+  queue_condition_.notify_all();
+  write_thread_.join();
+
+  // Producers only push while accepting, so the write thread has written every queued message.
+  // Should one remain nonetheless, it is accounted as dropped rather than lost silently.
+  QueuedMessage queued;
+  while (write_queue_.try_pop(queued)) {
+    --queued_message_count_;
+    --queued.topic->queued_message_count;
+    ++queued.topic->dropped_message_count;
+    queued.topic->dropped_bytes += queued.size;
+    queued_bytes_ -= queued.size;
+  }
+
+  // There is no writing thread left to rethrow to.
+  if (write_error_) {
+    try {
+      std::rethrow_exception(std::exchange(write_error_, nullptr));
+    } catch (const std::exception & e) {
+      ROSBAG2_CPP_LOG_ERROR_STREAM("Failed to write queued messages: " << e.what());
+    }
+  }
+  has_write_error_ = false;
+}
+
+void SequentialWriter::update_topic_ingestion()
+{
+  const auto current_topic_ingestion = std::atomic_load(&topic_ingestion_);
+  auto topic_ingestion = std::make_shared<TopicIngestionIndex>();
+  topic_ingestion->by_handle.resize(topics_by_handle_.size());
+  for (const auto & topic : topic_handles_) {
+    std::shared_ptr<TopicIngestion> ingestion;
+    // Keep the state, including the drop counters, of topics which remain.
+    const auto current = current_topic_ingestion->by_name.find(topic.first);
+    if (current != current_topic_ingestion->by_name.end()) {
+      ingestion = current->second;
+    } else {
+      ingestion = std::make_shared<TopicIngestion>();
+      ingestion->handle = topic.second;
+      const auto backpressure = topic_backpressure_.find(topic.first);
+      ingestion->backpressure = backpressure != topic_backpressure_.end() ?
+        backpressure->second : default_backpressure_;
+    }
+    topic_ingestion->by_name.emplace(topic.first, ingestion);
+    topic_ingestion->by_handle[topic.second] = std::move(ingestion);
+  }
+  std::atomic_store(
+    &topic_ingestion_, std::shared_ptr<const TopicIngestionIndex>(std::move(topic_ingestion)));
+}
+
+void SequentialWriter::record_dropped_message(
+  TopicHandle topic, const rosbag2_storage::SerializedBagMessage & message)
+{
+  const auto topic_ingestion = std::atomic_load(&topic_ingestion_);
+  if (topic < topic_ingestion->by_handle.size() && topic_ingestion->by_handle[topic]) {
+    auto & ingestion = *topic_ingestion->by_handle[topic];
+    ++ingestion.dropped_message_count;
+    ingestion.dropped_bytes +=
+      message.serialized_data ? message.serialized_data->buffer_length : 0u;
+  }
+}
+
+std::unordered_map<std::string, DroppedMessages> SequentialWriter::get_dropped_messages() const
+{
+  std::unordered_map<std::string, DroppedMessages> dropped_messages;
+  const auto topic_ingestion = std::atomic_load(&topic_ingestion_);
+  if (!topic_ingestion) {
+    return dropped_messages;
+  }
+  for (const auto & topic : topic_ingestion->by_name) {
+    if (topic.second->dropped_message_count > 0u) {
+      dropped_messages[topic.first] = {
+        topic.second->dropped_message_count, topic.second->dropped_bytes};
+    }
+  }
+  return dropped_messages;
+}
+
+SequentialWriter::TopicHandle SequentialWriter::get_topic_handle(
+  const std::string & topic_name) const
+{
+  const auto handle = topic_handles_.find(topic_name);
+  if (handle == topic_handles_.end()) {
+    std::stringstream errmsg;
+    errmsg << "Failed to write on topic '" << topic_name <<
+      "'. Call create_topic() before first write.";
+    throw std::runtime_error(errmsg.str());
+  }
+  return handle->second;
+}
+
+SequentialWriter::TopicEntry & SequentialWriter::get_topic_entry(TopicHandle topic)
+{
+  if (topic >= topics_by_handle_.size() || !topics_by_handle_[topic].information) {
+    std::stringstream errmsg;
+    errmsg << "Failed to write on topic handle " << topic <<
+      ". Call create_topic() before first write.";
+    throw std::runtime_error(errmsg.str());
+  }
+  return topics_by_handle_[topic];
+}
+
+void SequentialWriter::write_message(
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+  const MessageIdCallback & on_written)
+{
+  if (!storage_) {
+    throw std::runtime_error("Bag is not open. Call open() before writing.");
+  }
+
+  const auto topic = get_topic_handle(message->topic_name);
+  write_message(topic, std::move(message), on_written);
+}
+
+void SequentialWriter::write_message(
+  TopicHandle topic,
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> message,
+  const MessageIdCallback & on_written)
+{
+  if (!storage_) {
+    throw std::runtime_error("Bag is not open. Call open() before writing.");
+  }
+
+  auto & topic_entry = get_topic_entry(topic);
+  auto & topic_information = *topic_entry.information;
+
+  // The cache only remains full if it could not be handed over for writing.
+  if (cache_is_full() && !hand_over_cache()) {
+    ++dropped_message_count_;
+    record_dropped_message(topic, *message);
+    return;
+  }
+
+  // Update the message count and statistics for the Topic.
+  ++topic_information.message_count;
+  rosbag2_storage::update_topic_statistics(topic_information, *message);
+
+  if (should_split_bagfile(*message)) {
     split_bagfile();
+  } else if (prepare_next_file_ && !next_storage_.valid()) {
+    // Prepare once the first messages come in, as most topics are created by then.
+    prepare_next_storage(nullptr);
+  }
 
-    // Update bagfile starting time
-    metadata_.starting_time = std::chrono::high_resolution_clock::now();
+  if (duration_split_time_ == std::numeric_limits<rcutils_time_point_value_t>::max() &&
+    max_bagfile_duration != std::chrono::seconds(
+      rosbag2_storage::storage_interfaces::MAX_BAGFILE_DURATION_NO_SPLIT))
+  {
+    duration_split_time_ = get_duration_split_time(message->time_stamp);
   }
 
   const auto message_timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>(
@@ -244,52 +912,256 @@ void SequentialWriter::write(std::shared_ptr<rosbag2_storage::SerializedBagMessa
   const auto duration = message_timestamp - metadata_.starting_time;
   metadata_.duration = std::max(metadata_.duration, duration);
 
-  // if cache size is set to zero, we directly call write
-  if (max_cache_size_ == 0u) {
+  record_in_current_file(topic_information.topic_metadata.name, *message);
+
+  // Splitting may have changed the storage, so the topic id is only taken now.
+  if (message->topic_name.empty()) {
+    message->topic_id = topic_entry.storage_topic_id;
+    // Converters and storages without topic ids still go by the topic name.
+    if (message->topic_id < 0 || converter_) {
+      message->topic_name = topic_information.topic_metadata.name;
+    }
+  }
+
+  // if both cache limits are set to zero, we directly call write
+  if (max_cache_size_ == 0u && max_cache_bytes_ == 0u) {
     storage_->write(converter_ ? converter_->convert(message) : message);
+    if (on_written) {
+      on_written(storage_->get_last_inserted_id());
+    }
   } else {
-    cache_.push_back(converter_ ? converter_->convert(message) : message);
-    if (cache_.size() >= max_cache_size_) {
-      storage_->write(cache_);
-      // reset cache
-      cache_.clear();
-      cache_.reserve(max_cache_size_);
+    auto cached_message = converter_ ? converter_->convert(message) : message;
+    if (cached_message->serialized_data) {
+      cache_bytes_ += cached_message->serialized_data->buffer_length;
+    }
+    cache_.push_back(cached_message);
+    cache_id_callbacks_.push_back(on_written);
+    if (cache_is_full()) {
+      hand_over_cache();
     }
   }
+
+  if (metadata_snapshot_interval_ != std::chrono::seconds::zero() &&
+    std::chrono::steady_clock::now() >= next_metadata_snapshot_time_)
+  {
+    write_metadata_snapshot();
+  }
+}
+
+bool SequentialWriter::cache_is_full() const
+{
+  return (max_cache_size_ != 0u && cache_.size() >= max_cache_size_) ||
+         (max_cache_bytes_ != 0u && cache_bytes_ >= max_cache_bytes_);
+}
+
+bool SequentialWriter::hand_over_cache()
+{
+  if (!async_cache_flush_) {
+    flush_cache();
+    return true;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    if (flush_pending_ && drop_messages_on_full_cache_) {
+      return false;
+    }
+    flush_condition_.wait(lock, [this] {return !flush_pending_;});
+    if (flush_error_) {
+      std::rethrow_exception(std::exchange(flush_error_, nullptr));
+    }
+    // The flush thread left its cache empty, so both caches keep their capacity.
+    cache_.swap(flush_cache_);
+    cache_id_callbacks_.swap(flush_id_callbacks_);
+    flush_storage_ = storage_;
+    flush_pending_ = true;
+  }
+  flush_condition_.notify_all();
+  cache_bytes_ = 0;
+  return true;
+}
+
+void SequentialWriter::wait_for_pending_flush()
+{
+  if (!async_cache_flush_) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(flush_mutex_);
+  flush_condition_.wait(lock, [this] {return !flush_pending_;});
+  if (flush_error_) {
+    std::rethrow_exception(std::exchange(flush_error_, nullptr));
+  }
+}
+
+void SequentialWriter::run_flush_thread()
+{
+  std::unique_lock<std::mutex> lock(flush_mutex_);
+  while (true) {
+    flush_condition_.wait(lock, [this] {return flush_pending_ || stop_flush_thread_;});
+    if (!flush_pending_) {
+      return;
+    }
+
+    // Write without holding the lock, so that the writing thread can keep filling its cache.
+    lock.unlock();
+    try {
+      write_cached_messages(*flush_storage_, flush_cache_, flush_id_callbacks_);
+    } catch (...) {
+      lock.lock();
+      flush_error_ = std::current_exception();
+      lock.unlock();
+    }
+    flush_cache_.clear();
+    flush_id_callbacks_.clear();
+    lock.lock();
+    flush_storage_.reset();
+    flush_pending_ = false;
+    flush_condition_.notify_all();
+  }
+}
+
+void SequentialWriter::stop_flush_thread()
+{
+  if (!flush_thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(flush_mutex_);
+    stop_flush_thread_ = true;
+  }
+  flush_condition_.notify_all();
+  flush_thread_.join();
+}
+
+void SequentialWriter::record_in_current_file(
+  const std::string & topic_name, const rosbag2_storage::SerializedBagMessage & message)
+{
+  auto & file_information = metadata_.files.back();
+  const auto message_timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>(
+    std::chrono::nanoseconds(message.time_stamp));
+  if (file_information.message_count == 0) {
+    file_information.starting_time = message_timestamp;
+    file_information.duration = std::chrono::nanoseconds(0);
+  } else {
+    const auto file_end = std::max(
+      file_information.starting_time + file_information.duration, message_timestamp);
+    file_information.starting_time = std::min(file_information.starting_time, message_timestamp);
+    file_information.duration = file_end - file_information.starting_time;
+  }
+  ++file_information.message_count;
+  ++file_information.topics_message_count[topic_name];
+}
+
+void SequentialWriter::flush_cache()
+{
+  // Keep the order of messages: the handed over cache was filled first.
+  wait_for_pending_flush();
+  if (cache_.empty()) {
+    return;
+  }
+
+  write_cached_messages(*storage_, cache_, cache_id_callbacks_);
+
+  // reset cache
+  cache_bytes_ = 0;
+  cache_.clear();
+  cache_.reserve(max_cache_size_);
+  cache_id_callbacks_.clear();
+  cache_id_callbacks_.reserve(max_cache_size_);
+}
+
+void SequentialWriter::write_cached_messages(
+  rosbag2_storage::storage_interfaces::ReadWriteInterface & storage,
+  const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> & messages,
+  const std::vector<MessageIdCallback> & id_callbacks)
+{
+  const bool report_ids = std::any_of(
+    id_callbacks.begin(), id_callbacks.end(),
+    [](const MessageIdCallback & on_written) {return static_cast<bool>(on_written);});
+
+  if (report_ids) {
+    const auto ids = storage.write_and_get_ids(messages);
+    for (size_t i = 0; i < ids.size() && i < id_callbacks.size(); ++i) {
+      if (id_callbacks[i]) {
+        id_callbacks[i](ids[i]);
+      }
+    }
+  } else {
+    storage.write(messages);
+  }
 }
 
 int32_t SequentialWriter::get_last_inserted_id()
 {
+  std::unique_lock<std::mutex> write_lock(write_mutex_, std::defer_lock);
+  if (concurrent_write_) {
+    wait_for_queued_messages();
+    write_lock.lock();
+  }
+
   if (!storage_) {
     throw std::runtime_error("Bag is not open. Call open() before writing.");
   }
+  wait_for_pending_flush();
   return storage_->get_last_inserted_id();
 }
 
-bool SequentialWriter::should_split_bagfile() const
+bool SequentialWriter::should_split_bagfile(
+  const rosbag2_storage::SerializedBagMessage & message)
 {
   // Assume we aren't splitting
   bool should_split = false;
 
   // Splitting by size
   if (max_bagfile_size_ != rosbag2_storage::storage_interfaces::MAX_BAGFILE_SIZE_NO_SPLIT) {
-    should_split = should_split || (storage_->get_bagfile_size() > max_bagfile_size_);
+    should_split = should_split || (get_current_bagfile_size() > max_bagfile_size_);
   }
 
   // Splitting by time
   if (max_bagfile_duration != std::chrono::seconds(
       rosbag2_storage::storage_interfaces::MAX_BAGFILE_DURATION_NO_SPLIT))
   {
-    auto max_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-      max_bagfile_duration);
-    should_split = should_split ||
-      ((std::chrono::high_resolution_clock::now() - metadata_.starting_time) > max_duration_ns);
+    // Only message timestamps are compared, so that bagfiles cover well-defined time windows
+    // regardless of when the messages are written.
+    should_split = should_split || (message.time_stamp >= duration_split_time_);
   }
 
   return should_split;
 }
 
-void SequentialWriter::finalize_metadata()
+rcutils_time_point_value_t SequentialWriter::get_duration_split_time(
+  rcutils_time_point_value_t file_starting_time) const
+{
+  const auto max_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    max_bagfile_duration).count();
+  if (!align_bagfile_duration_) {
+    return file_starting_time + max_duration_ns;
+  }
+
+  // Round down to the multiple of the duration the bagfile starts in.
+  auto window_start = file_starting_time - file_starting_time % max_duration_ns;
+  if (file_starting_time % max_duration_ns < 0) {
+    window_start -= max_duration_ns;
+  }
+  return window_start + max_duration_ns;
+}
+
+uint64_t SequentialWriter::get_current_bagfile_size()
+{
+  // Asking the storage for its real size is a file system call, which is too costly to make
+  // for every message. The estimate is corrected whenever the real size is queried.
+  if (++messages_since_size_reconciliation_ >=
+    rosbag2_storage::storage_interfaces::BAGFILE_SIZE_RECONCILIATION_INTERVAL)
+  {
+    messages_since_size_reconciliation_ = 0;
+    return storage_->get_bagfile_size();
+  }
+  return storage_->get_bagfile_size_estimate();
+}
+
+void SequentialWriter::update_metadata()
 {
   metadata_.bag_size = 0;
 
@@ -302,14 +1174,42 @@ void SequentialWriter::finalize_metadata()
   }
 
   metadata_.topics_with_message_count.clear();
-  metadata_.topics_with_message_count.reserve(topics_names_to_info_.size());
+  metadata_.topics_with_message_count.reserve(
+    topics_names_to_info_.size() + appended_topics_.size());
   metadata_.message_count = 0;
 
+  for (const auto & topic : appended_topics_) {
+    metadata_.topics_with_message_count.push_back(topic.second);
+    metadata_.message_count += topic.second.message_count;
+  }
+
+  const auto dropped_messages = get_dropped_messages();
   for (const auto & topic : topics_names_to_info_) {
     metadata_.topics_with_message_count.push_back(topic.second);
     metadata_.message_count += topic.second.message_count;
+
+    const auto dropped = dropped_messages.find(topic.first);
+    if (dropped != dropped_messages.end()) {
+      metadata_.topics_with_message_count.back().dropped_message_count +=
+        dropped->second.message_count;
+      metadata_.topics_with_message_count.back().dropped_bytes += dropped->second.bytes;
+    }
   }
 }
 
+void SequentialWriter::write_metadata_snapshot()
+{
+  next_metadata_snapshot_time_ = std::chrono::steady_clock::now() + metadata_snapshot_interval_;
+  update_metadata();
+  metadata_.finalized = false;
+  metadata_snapshot_writer_.write(metadata_);
+}
+
+void SequentialWriter::finalize_metadata()
+{
+  update_metadata();
+  metadata_.finalized = true;
+}
+
 }  // namespace writers
 }  // namespace rosbag2_cpp
@@ -39,11 +39,27 @@ public:
   MOCK_METHOD1(
     write,
     void(const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>&));
+  MOCK_METHOD0(get_last_inserted_id, int32_t());
+  MOCK_METHOD1(get_topic_id, int32_t(const std::string &));
   MOCK_METHOD0(get_all_topics_and_types, std::vector<rosbag2_storage::TopicMetadata>());
   MOCK_METHOD0(get_metadata, rosbag2_storage::BagMetadata());
+  MOCK_METHOD2(
+    read_latest_before,
+    std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>(
+      const std::vector<std::string> &, rcutils_time_point_value_t));
+  MOCK_METHOD3(
+    read_topics_at_timestamp_range,
+    std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>(
+      const std::vector<std::string> &, rcutils_time_point_value_t, rcutils_time_point_value_t));
+  MOCK_METHOD2(
+    read_closest,
+    std::shared_ptr<rosbag2_storage::SerializedBagMessage>(
+      const std::string &, rcutils_time_point_value_t));
+  MOCK_METHOD1(seek, void(rcutils_time_point_value_t));
   MOCK_METHOD0(reset_filter, void());
   MOCK_METHOD1(set_filter, void(const rosbag2_storage::StorageFilter &));
   MOCK_CONST_METHOD0(get_bagfile_size, uint64_t());
+  MOCK_CONST_METHOD0(get_bagfile_size_estimate, uint64_t());
   MOCK_CONST_METHOD0(get_relative_file_path, std::string());
   MOCK_CONST_METHOD0(get_storage_identifier, std::string());
   MOCK_CONST_METHOD0(get_minimum_split_file_size, uint64_t());
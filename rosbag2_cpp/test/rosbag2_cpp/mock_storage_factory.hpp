@@ -35,6 +35,10 @@ public:
     open_read_write,
     std::shared_ptr<rosbag2_storage::storage_interfaces::ReadWriteInterface>(
       const std::string &, const std::string &));
+  MOCK_METHOD2(
+    open_read_only_immutable,
+    std::shared_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface>(
+      const std::string &, const std::string &));
 };
 
 #endif  // ROSBAG2_CPP__MOCK_STORAGE_FACTORY_HPP_
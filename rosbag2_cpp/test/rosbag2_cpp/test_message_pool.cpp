@@ -0,0 +1,138 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rosbag2_cpp/writers/message_pool.hpp"
+
+#include "rosbag2_storage/serialized_bag_message.hpp"
+
+using namespace ::testing;  // NOLINT
+using rosbag2_cpp::writers::MessagePool;
+using rosbag2_storage::SerializedBagMessage;
+
+TEST(MessagePoolTest, released_messages_are_reused) {
+  MessagePool pool;
+  auto message = pool.acquire();
+  const auto * first_message = message.get();
+  message.reset();
+
+  message = pool.acquire();
+  EXPECT_THAT(message.get(), Eq(first_message));
+  EXPECT_THAT(pool.size(), Eq(1u));
+}
+
+TEST(MessagePoolTest, messages_in_use_are_not_handed_out_again) {
+  MessagePool pool;
+  auto first_message = pool.acquire();
+  auto second_message = pool.acquire();
+
+  EXPECT_THAT(second_message.get(), Ne(first_message.get()));
+  EXPECT_THAT(pool.size(), Eq(2u));
+}
+
+TEST(MessagePoolTest, reused_messages_hold_default_values) {
+  MessagePool pool;
+  auto message = pool.acquire();
+  message->serialized_data = std::make_shared<rcutils_uint8_array_t>();
+  message->time_stamp = 42;
+  message->topic_name = "a_topic_name_too_long_for_small_string_storage";
+  message->has_key = true;
+  message->key = 7;
+  message->topic_id = 3;
+  message.reset();
+
+  message = pool.acquire();
+  EXPECT_THAT(message->serialized_data, IsNull());
+  EXPECT_THAT(message->time_stamp, Eq(0));
+  EXPECT_THAT(message->topic_name, IsEmpty());
+  EXPECT_FALSE(message->has_key);
+  EXPECT_THAT(message->key, Eq(0));
+  EXPECT_THAT(message->topic_id, Eq(-1));
+}
+
+TEST(MessagePoolTest, released_messages_drop_their_payload_at_once) {
+  MessagePool pool;
+  auto serialized_data = std::make_shared<rcutils_uint8_array_t>();
+  auto message = pool.acquire();
+  message->serialized_data = serialized_data;
+  message.reset();
+
+  EXPECT_THAT(serialized_data.use_count(), Eq(1));
+}
+
+TEST(MessagePoolTest, messages_can_outlive_the_pool) {
+  auto pool = std::make_unique<MessagePool>();
+  auto message = pool->acquire();
+  message->time_stamp = 42;
+  pool.reset();
+
+  EXPECT_THAT(message->time_stamp, Eq(42));
+  message.reset();
+}
+
+TEST(MessagePoolTest, acquire_moves_the_given_message_into_a_pooled_one) {
+  MessagePool pool;
+  auto released_message = pool.acquire();
+  const auto * pooled_message = released_message.get();
+  released_message.reset();
+
+  SerializedBagMessage message;
+  message.serialized_data = std::make_shared<rcutils_uint8_array_t>();
+  const auto * serialized_data = message.serialized_data.get();
+  message.time_stamp = 42;
+  message.topic_name = "topic";
+
+  auto acquired_message = pool.acquire(std::move(message));
+  EXPECT_THAT(acquired_message.get(), Eq(pooled_message));
+  EXPECT_THAT(acquired_message->serialized_data.get(), Eq(serialized_data));
+  EXPECT_THAT(acquired_message->time_stamp, Eq(42));
+  EXPECT_THAT(acquired_message->topic_name, StrEq("topic"));
+}
+
+TEST(MessagePoolTest, messages_beyond_the_maximum_size_are_allocated) {
+  MessagePool pool(1);
+  auto first_message = pool.acquire();
+  auto second_message = pool.acquire();
+
+  ASSERT_THAT(second_message, NotNull());
+  EXPECT_THAT(second_message.get(), Ne(first_message.get()));
+  EXPECT_THAT(pool.size(), Eq(1u));
+}
+
+TEST(MessagePoolTest, messages_can_be_acquired_and_released_from_several_threads) {
+  MessagePool pool(16);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back(
+      [&pool, t]() {
+        for (int i = 0; i < 1000; ++i) {
+          SerializedBagMessage message;
+          message.time_stamp = t * 1000 + i;
+          auto acquired_message = pool.acquire(std::move(message));
+          EXPECT_THAT(acquired_message->time_stamp, Eq(t * 1000 + i));
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_THAT(pool.size(), Le(4u));
+}
@@ -0,0 +1,94 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rosbag2_cpp/writers/metadata_snapshot_writer.hpp"
+
+#include "rosbag2_storage/bag_metadata.hpp"
+
+#include "mock_metadata_io.hpp"
+
+using namespace ::testing;  // NOLINT
+using rosbag2_cpp::writers::MetadataSnapshotWriter;
+
+rosbag2_storage::BagMetadata make_metadata(size_t message_count)
+{
+  rosbag2_storage::BagMetadata metadata;
+  metadata.message_count = message_count;
+  return metadata;
+}
+
+TEST(MetadataSnapshotWriterTest, queued_snapshots_are_written_in_order_before_stop_returns) {
+  NiceMock<MockMetadataIo> metadata_io;
+  // The first snapshot is not written until released, so that the others queue up.
+  std::promise<void> release_write;
+  auto write_released = release_write.get_future().share();
+  std::vector<std::string> written_uris;
+  std::vector<size_t> written_message_counts;
+  ON_CALL(metadata_io, write_metadata).WillByDefault(
+    [&](const std::string & uri, const rosbag2_storage::BagMetadata & metadata) {
+      write_released.wait();
+      written_uris.push_back(uri);
+      written_message_counts.push_back(metadata.message_count);
+    });
+
+  MetadataSnapshotWriter snapshot_writer;
+  snapshot_writer.start(metadata_io, "bag");
+  for (size_t i = 0; i < 3; ++i) {
+    snapshot_writer.write(make_metadata(i));
+  }
+  release_write.set_value();
+  snapshot_writer.stop();
+
+  EXPECT_THAT(written_uris, ElementsAre("bag", "bag", "bag"));
+  EXPECT_THAT(written_message_counts, ElementsAre(0u, 1u, 2u));
+}
+
+TEST(MetadataSnapshotWriterTest, failed_snapshots_do_not_stop_the_writer) {
+  NiceMock<MockMetadataIo> metadata_io;
+  std::vector<size_t> written_message_counts;
+  ON_CALL(metadata_io, write_metadata).WillByDefault(
+    [&](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      if (metadata.message_count == 0u) {
+        throw std::runtime_error("disk full");
+      }
+      written_message_counts.push_back(metadata.message_count);
+    });
+
+  MetadataSnapshotWriter snapshot_writer;
+  snapshot_writer.start(metadata_io, "bag");
+  snapshot_writer.write(make_metadata(0));
+  snapshot_writer.write(make_metadata(1));
+  snapshot_writer.stop();
+
+  EXPECT_THAT(written_message_counts, ElementsAre(1u));
+}
+
+TEST(MetadataSnapshotWriterTest, snapshots_are_ignored_unless_started) {
+  NiceMock<MockMetadataIo> metadata_io;
+  EXPECT_CALL(metadata_io, write_metadata).Times(0);
+
+  MetadataSnapshotWriter snapshot_writer;
+  snapshot_writer.write(make_metadata(1));
+  snapshot_writer.start(metadata_io, "bag");
+  snapshot_writer.stop();
+  snapshot_writer.write(make_metadata(2));
+  snapshot_writer.stop();
+}
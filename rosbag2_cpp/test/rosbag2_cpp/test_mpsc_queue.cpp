@@ -0,0 +1,86 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rosbag2_cpp/writers/mpsc_queue.hpp"
+
+using namespace ::testing;  // NOLINT
+using rosbag2_cpp::writers::MpscQueue;
+
+TEST(MpscQueueTest, elements_are_popped_in_push_order) {
+  MpscQueue<int> queue;
+  int value = 0;
+  EXPECT_FALSE(queue.try_pop(value));
+
+  for (int i = 1; i <= 3; ++i) {
+    queue.push(i);
+  }
+  std::vector<int> popped;
+  while (queue.try_pop(value)) {
+    popped.push_back(value);
+  }
+  EXPECT_THAT(popped, ElementsAre(1, 2, 3));
+}
+
+TEST(MpscQueueTest, remaining_elements_are_released_with_the_queue) {
+  auto element = std::make_shared<int>(42);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.push(element);
+    queue.push(element);
+    EXPECT_EQ(element.use_count(), 3);
+  }
+  EXPECT_EQ(element.use_count(), 1);
+}
+
+TEST(MpscQueueTest, elements_of_concurrent_producers_are_popped_in_order_per_producer) {
+  const int producer_count = 4;
+  const int elements_per_producer = 10000;
+  MpscQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < producer_count; ++producer) {
+    producers.emplace_back(
+      [&queue, producer]() {
+        for (int i = 0; i < elements_per_producer; ++i) {
+          queue.push({producer, i});
+        }
+      });
+  }
+
+  std::vector<int> next_expected(producer_count, 0);
+  int popped_count = 0;
+  std::pair<int, int> element;
+  while (popped_count < producer_count * elements_per_producer) {
+    if (!queue.try_pop(element)) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_EQ(element.second, next_expected[element.first]);
+    next_expected[element.first] = element.second + 1;
+    ++popped_count;
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_FALSE(queue.try_pop(element));
+  EXPECT_THAT(next_expected, Each(elements_per_producer));
+}
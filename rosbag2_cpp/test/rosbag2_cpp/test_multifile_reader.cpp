@@ -14,6 +14,8 @@
 
 #include <gmock/gmock.h>
 
+#include <chrono>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -25,6 +27,7 @@
 #include "rosbag2_cpp/readers/sequential_reader.hpp"
 
 #include "rosbag2_storage/bag_metadata.hpp"
+#include "rosbag2_storage/ros_helper.hpp"
 #include "rosbag2_storage/topic_metadata.hpp"
 
 #include "mock_converter_factory.hpp"
@@ -228,3 +231,302 @@ TEST_F(MultifileReaderTest, get_all_topics_and_types_returns_from_io_metadata)
   const auto all_topics_and_types = reader_->get_all_topics_and_types();
   EXPECT_FALSE(all_topics_and_types.empty());
 }
+
+TEST_F(MultifileReaderTest, read_latest_before_stops_at_latest_file_holding_each_topic)
+{
+  init();
+  reader_->open(default_storage_options_, {"", storage_serialization_format_});
+
+  auto make_messages = [](const std::string & topic_name, rcutils_time_point_value_t time_stamp) {
+      auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+      message->topic_name = topic_name;
+      message->time_stamp = time_stamp;
+      return std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>(
+        1, message);
+    };
+  {
+    InSequence s;
+    EXPECT_CALL(
+      *storage_, read_latest_before(ElementsAre("topic", "other"), 30))
+    .WillOnce(Return(make_messages("topic", 20)));
+    EXPECT_CALL(*storage_, read_latest_before(ElementsAre("other"), 30))
+    .WillOnce(Return(make_messages("other", 5)));
+  }
+
+  auto latest_messages = reader_->read_latest_before({"topic", "other"}, 30);
+
+  ASSERT_THAT(*latest_messages, SizeIs(2));
+  EXPECT_THAT((*latest_messages)[0]->topic_name, Eq("other"));
+  EXPECT_THAT((*latest_messages)[1]->time_stamp, Eq(20));
+}
+
+TEST_F(MultifileReaderTest, read_latest_before_skips_files_starting_after_the_timestamp)
+{
+  auto resolved_paths = std::vector<std::string>{
+    (rcpputils::fs::path(storage_uri_) / relative_path_1_).string(),
+    (rcpputils::fs::path(storage_uri_) / relative_path_2_).string(),
+    rcpputils::fs::path(absolute_path_1_).string()};
+  auto make_message = [](const std::string & topic_name, rcutils_time_point_value_t time_stamp) {
+      auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+      message->topic_name = topic_name;
+      message->time_stamp = time_stamp;
+      return message;
+    };
+  using Messages = std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>;
+
+  // The files hold messages on both topics stamped within [0, 10], [20, 30] and [40, 50].
+  auto metadata = get_metadata();
+  metadata.topics_with_message_count.push_back(
+    {{"topic", "test_msgs/BasicTypes", storage_serialization_format_, ""}, 6});
+  metadata.topics_with_message_count.push_back(
+    {{"other", "test_msgs/BasicTypes", storage_serialization_format_, ""}, 6});
+  for (size_t i = 0; i < metadata.relative_file_paths.size(); ++i) {
+    rosbag2_storage::FileInformation file_information{};
+    file_information.path = metadata.relative_file_paths[i];
+    file_information.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+      std::chrono::nanoseconds(20 * i));
+    file_information.duration = std::chrono::nanoseconds(10);
+    file_information.topics_message_count = {{"topic", 2}, {"other", 2}};
+    file_information.message_count = 4;
+    metadata.files.push_back(file_information);
+  }
+
+  auto storage_factory = std::make_unique<StrictMock<MockStorageFactory>>();
+  std::vector<std::shared_ptr<NiceMock<MockStorage>>> storages;
+  for (size_t i = 0; i < resolved_paths.size(); ++i) {
+    storages.push_back(std::make_shared<NiceMock<MockStorage>>());
+  }
+  EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[0], _))
+  .WillOnce(Return(storages[0]));
+  EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[1], _))
+  .WillOnce(Return(storages[1]));
+  // The last file starts after both timestamps, so it is never opened.
+  EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[2], _)).Times(0);
+  auto metadata_io = std::make_unique<NiceMock<MockMetadataIo>>();
+  ON_CALL(*metadata_io, read_metadata(_)).WillByDefault(Return(metadata));
+  ON_CALL(*metadata_io, metadata_file_exists(_)).WillByDefault(Return(true));
+  reader_ = std::make_unique<rosbag2_cpp::Reader>(
+    std::make_unique<rosbag2_cpp::readers::SequentialReader>(
+      std::move(storage_factory), converter_factory_, std::move(metadata_io)));
+  reader_->open(default_storage_options_, {"", storage_serialization_format_});
+
+  // The second file starts at 20, only the first one can hold messages before 15.
+  EXPECT_CALL(*storages[0], read_latest_before(ElementsAre("topic", "other"), 15))
+  .WillOnce(Return(std::make_shared<Messages>(Messages{make_message("topic", 8)})));
+  auto latest_messages = reader_->read_latest_before({"topic", "other"}, 15);
+  ASSERT_THAT(*latest_messages, SizeIs(1));
+  EXPECT_THAT((*latest_messages)[0]->time_stamp, Eq(8));
+
+  EXPECT_CALL(*storages[1], read_latest_before(ElementsAre("topic", "other"), 25))
+  .WillOnce(
+    Return(
+      std::make_shared<Messages>(Messages{make_message("topic", 22), make_message("other", 24)})));
+  EXPECT_CALL(*storages[0], read_latest_before(_, 25)).Times(0);
+  latest_messages = reader_->read_latest_before({"topic", "other"}, 25);
+  ASSERT_THAT(*latest_messages, SizeIs(2));
+  EXPECT_THAT((*latest_messages)[0]->time_stamp, Eq(22));
+  EXPECT_THAT((*latest_messages)[1]->time_stamp, Eq(24));
+}
+
+TEST_F(MultifileReaderTest, random_access_is_routed_by_file_time_range)
+{
+  auto resolved_paths = std::vector<std::string>{
+    (rcpputils::fs::path(storage_uri_) / relative_path_1_).string(),
+    (rcpputils::fs::path(storage_uri_) / relative_path_2_).string(),
+    rcpputils::fs::path(absolute_path_1_).string()};
+  auto make_message = [](rcutils_time_point_value_t time_stamp) {
+      auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+      message->topic_name = "topic";
+      message->time_stamp = time_stamp;
+      return message;
+    };
+
+  // The files hold messages stamped within [0, 10], [20, 30] and [40, 50].
+  auto storage_factory = std::make_unique<StrictMock<MockStorageFactory>>();
+  std::vector<std::shared_ptr<NiceMock<MockStorage>>> storages;
+  for (size_t i = 0; i < resolved_paths.size(); ++i) {
+    auto storage = std::make_shared<NiceMock<MockStorage>>();
+    rosbag2_storage::BagMetadata file_metadata;
+    file_metadata.message_count = 2;
+    file_metadata.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+      std::chrono::nanoseconds(20 * i));
+    file_metadata.duration = std::chrono::nanoseconds(10);
+    ON_CALL(*storage, get_metadata()).WillByDefault(Return(file_metadata));
+    // Each file is opened once, the storages are kept open between accesses.
+    EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[i], _))
+    .WillOnce(Return(storage));
+    storages.push_back(storage);
+  }
+  auto metadata_io = std::make_unique<NiceMock<MockMetadataIo>>();
+  auto metadata = get_metadata();
+  metadata.topics_with_message_count.push_back(
+    {{"topic", "test_msgs/BasicTypes", storage_serialization_format_, ""}, 6});
+  ON_CALL(*metadata_io, read_metadata(_)).WillByDefault(Return(metadata));
+  ON_CALL(*metadata_io, metadata_file_exists(_)).WillByDefault(Return(true));
+  reader_ = std::make_unique<rosbag2_cpp::Reader>(
+    std::make_unique<rosbag2_cpp::readers::SequentialReader>(
+      std::move(storage_factory), converter_factory_, std::move(metadata_io)));
+  reader_->open(default_storage_options_, {"", storage_serialization_format_});
+
+  EXPECT_CALL(*storages[0], read_topics_at_timestamp_range(_, _, _)).Times(0);
+  EXPECT_CALL(*storages[1], read_topics_at_timestamp_range(ElementsAre("topic"), 25, 45))
+  .WillOnce(
+    Return(
+      std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>(
+        1, make_message(30))));
+  EXPECT_CALL(*storages[2], read_topics_at_timestamp_range(ElementsAre("topic"), 25, 45))
+  .WillOnce(
+    Return(
+      std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>(
+        1, make_message(40))));
+  auto range_messages = reader_->read_range(25, 45, {"topic"});
+  ASSERT_THAT(*range_messages, SizeIs(2));
+  EXPECT_THAT((*range_messages)[0]->time_stamp, Eq(30));
+  EXPECT_THAT((*range_messages)[1]->time_stamp, Eq(40));
+
+  // Both neighbours are 5ns away, the earlier one wins.
+  EXPECT_CALL(*storages[0], read_closest(_, _)).Times(0);
+  EXPECT_CALL(*storages[1], read_closest("topic", 35)).WillOnce(Return(make_message(30)));
+  EXPECT_CALL(*storages[2], read_closest("topic", 35)).WillOnce(Return(make_message(40)));
+  auto closest_message = reader_->read_closest("topic", 35);
+  ASSERT_THAT(closest_message, NotNull());
+  EXPECT_THAT(closest_message->time_stamp, Eq(30));
+
+  EXPECT_CALL(*storages[1], seek(22));
+  reader_->seek(22);
+  auto & sr = static_cast<rosbag2_cpp::readers::SequentialReader &>(
+    reader_->get_implementation_handle());
+  EXPECT_EQ(sr.get_current_file(), resolved_paths[1]);
+}
+
+TEST_F(MultifileReaderTest, file_summaries_skip_files_without_filtered_topics)
+{
+  auto resolved_paths = std::vector<std::string>{
+    (rcpputils::fs::path(storage_uri_) / relative_path_1_).string(),
+    (rcpputils::fs::path(storage_uri_) / relative_path_2_).string(),
+    rcpputils::fs::path(absolute_path_1_).string()};
+
+  // The files hold messages stamped within [0, 10], [20, 30] and [40, 50]; the second file
+  // holds no messages on "other".
+  auto metadata = get_metadata();
+  metadata.topics_with_message_count.push_back(
+    {{"topic", "test_msgs/BasicTypes", storage_serialization_format_, ""}, 4});
+  metadata.topics_with_message_count.push_back(
+    {{"other", "test_msgs/BasicTypes", storage_serialization_format_, ""}, 3});
+  const std::vector<std::map<std::string, uint64_t>> topics_message_counts{
+    {{"topic", 2}, {"other", 1}}, {{"topic", 2}}, {{"other", 2}}};
+  for (size_t i = 0; i < metadata.relative_file_paths.size(); ++i) {
+    rosbag2_storage::FileInformation file_information{};
+    file_information.path = metadata.relative_file_paths[i];
+    file_information.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+      std::chrono::nanoseconds(20 * i));
+    file_information.duration = std::chrono::nanoseconds(10);
+    file_information.topics_message_count = topics_message_counts[i];
+    for (const auto & topic_message_count : file_information.topics_message_count) {
+      file_information.message_count += topic_message_count.second;
+    }
+    metadata.files.push_back(file_information);
+  }
+
+  auto storage_factory = std::make_unique<StrictMock<MockStorageFactory>>();
+  std::vector<std::shared_ptr<NiceMock<MockStorage>>> storages;
+  for (size_t i = 0; i < resolved_paths.size(); ++i) {
+    auto storage = std::make_shared<NiceMock<MockStorage>>();
+    // The summaries make opening files to look up their time range unnecessary.
+    EXPECT_CALL(*storage, get_metadata()).Times(0);
+    storages.push_back(storage);
+  }
+  EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[0], _))
+  .WillOnce(Return(storages[0]));
+  EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[1], _)).Times(0);
+  EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[2], _))
+  .WillOnce(Return(storages[2]));
+  auto metadata_io = std::make_unique<NiceMock<MockMetadataIo>>();
+  ON_CALL(*metadata_io, read_metadata(_)).WillByDefault(Return(metadata));
+  ON_CALL(*metadata_io, metadata_file_exists(_)).WillByDefault(Return(true));
+  reader_ = std::make_unique<rosbag2_cpp::Reader>(
+    std::make_unique<rosbag2_cpp::readers::SequentialReader>(
+      std::move(storage_factory), converter_factory_, std::move(metadata_io)));
+  reader_->open(default_storage_options_, {"", storage_serialization_format_});
+
+  rosbag2_storage::StorageFilter storage_filter;
+  storage_filter.topics = {"other"};
+  reader_->set_filter(storage_filter);
+
+  EXPECT_CALL(*storages[0], has_next()).WillRepeatedly(Return(false));
+  EXPECT_CALL(
+    *storages[2],
+    set_filter(Field(&rosbag2_storage::StorageFilter::topics, ElementsAre("other"))));
+  EXPECT_CALL(*storages[2], has_next()).WillRepeatedly(Return(true));
+  EXPECT_TRUE(reader_->has_next());
+  auto & sr = static_cast<rosbag2_cpp::readers::SequentialReader &>(
+    reader_->get_implementation_handle());
+  EXPECT_EQ(sr.get_current_file(), resolved_paths[2]);
+
+  EXPECT_CALL(*storages[2], seek(35));
+  reader_->seek(35);
+}
+
+TEST_F(MultifileReaderTest, read_next_batch_reads_messages_across_files)
+{
+  auto resolved_paths = std::vector<std::string>{
+    (rcpputils::fs::path(storage_uri_) / relative_path_1_).string(),
+    (rcpputils::fs::path(storage_uri_) / relative_path_2_).string(),
+    rcpputils::fs::path(absolute_path_1_).string()};
+  auto metadata = get_metadata();
+  metadata.topics_with_message_count.push_back(
+    {{"topic", "test_msgs/BasicTypes", storage_serialization_format_, ""}, 6});
+
+  // Each file holds two messages with a payload of 10 bytes, stamped in order.
+  auto storage_factory = std::make_unique<StrictMock<MockStorageFactory>>();
+  std::vector<std::shared_ptr<NiceMock<MockStorage>>> storages;
+  auto remaining_messages = std::make_shared<std::vector<int>>(resolved_paths.size(), 2);
+  const std::vector<uint8_t> payload(10, 42);
+  for (size_t i = 0; i < resolved_paths.size(); ++i) {
+    auto storage = std::make_shared<NiceMock<MockStorage>>();
+    ON_CALL(*storage, has_next()).WillByDefault(
+      [remaining_messages, i]() {return (*remaining_messages)[i] > 0;});
+    ON_CALL(*storage, read_next()).WillByDefault(
+      [remaining_messages, i, &payload]() {
+        auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+        message->topic_name = "topic";
+        message->time_stamp = static_cast<rcutils_time_point_value_t>(
+          2 * i + 2 - (*remaining_messages)[i]--);
+        message->serialized_data =
+          rosbag2_storage::make_serialized_message(payload.data(), payload.size());
+        return message;
+      });
+    EXPECT_CALL(*storage_factory, open_read_only(resolved_paths[i], _))
+    .WillOnce(Return(storage));
+    storages.push_back(storage);
+  }
+  auto metadata_io = std::make_unique<NiceMock<MockMetadataIo>>();
+  ON_CALL(*metadata_io, read_metadata(_)).WillByDefault(Return(metadata));
+  ON_CALL(*metadata_io, metadata_file_exists(_)).WillByDefault(Return(true));
+  reader_ = std::make_unique<rosbag2_cpp::Reader>(
+    std::make_unique<rosbag2_cpp::readers::SequentialReader>(
+      std::move(storage_factory), converter_factory_, std::move(metadata_io)));
+  reader_->open(default_storage_options_, {"", storage_serialization_format_});
+
+  auto batch = reader_->read_next_batch(3);
+  ASSERT_THAT(batch->get_records(), SizeIs(3));
+  EXPECT_THAT(batch->get_topic_names(), ElementsAre("topic"));
+  for (size_t i = 0; i < batch->size(); ++i) {
+    const auto & record = batch->get_records()[i];
+    EXPECT_EQ(record.time_stamp, static_cast<rcutils_time_point_value_t>(i));
+    EXPECT_EQ(record.offset, 10u * i);
+    EXPECT_EQ(record.length, 10u);
+  }
+  EXPECT_THAT(batch->get_payloads(), SizeIs(30));
+
+  // Reading stops once the batch holds at least the given payload bytes.
+  batch = reader_->read_next_batch(10, 15);
+  ASSERT_THAT(batch->get_records(), SizeIs(2));
+  EXPECT_EQ(batch->get_records()[0].time_stamp, 3);
+
+  batch = reader_->read_next_batch(10);
+  ASSERT_THAT(batch->get_records(), SizeIs(1));
+  EXPECT_EQ(batch->get_records()[0].time_stamp, 5);
+
+  EXPECT_TRUE(reader_->read_next_batch(10)->empty());
+}
@@ -0,0 +1,300 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rcpputils/filesystem_helper.hpp"
+
+#include "rosbag2_cpp/reindexer.hpp"
+
+#include "rosbag2_storage/bag_metadata.hpp"
+
+#include "rosbag2_test_common/temporary_directory_fixture.hpp"
+
+#include "mock_metadata_io.hpp"
+#include "mock_storage.hpp"
+#include "mock_storage_factory.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace rosbag2_test_common;  // NOLINT
+
+class ReindexerTest : public TemporaryDirectoryFixture
+{
+public:
+  ReindexerTest()
+  : storage_factory_(std::make_unique<StrictMock<MockStorageFactory>>()),
+    metadata_io_(std::make_unique<NiceMock<MockMetadataIo>>())
+  {
+    bag_path_ = (rcpputils::fs::path(temporary_dir_path_) / "bag").string();
+    rcpputils::fs::create_directories(rcpputils::fs::path(bag_path_));
+    storage_options_.uri = bag_path_;
+    storage_options_.storage_id = "storage_id";
+
+    ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+      [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+        written_metadata_.push_back(metadata);
+      });
+  }
+
+  std::string create_file(const std::string & file_name)
+  {
+    const auto path = (rcpputils::fs::path(bag_path_) / file_name).string();
+    std::ofstream(path) << "content";
+    return path;
+  }
+
+  // Storage of a file with one message per time stamp, all on the given topic.
+  std::shared_ptr<MockStorage> make_storage(
+    const std::string & topic_name, const std::vector<int64_t> & time_stamps)
+  {
+    rosbag2_storage::BagMetadata metadata{};
+    metadata.message_count = time_stamps.size();
+    metadata.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+      std::chrono::nanoseconds(time_stamps.front()));
+    metadata.duration = std::chrono::nanoseconds(time_stamps.back() - time_stamps.front());
+    rosbag2_storage::TopicInformation topic_information{
+      {topic_name, "type", "rmw_format", ""}, time_stamps.size()};
+    topic_information.starting_time = metadata.starting_time;
+    topic_information.duration = metadata.duration;
+    topic_information.total_bytes = 10 * time_stamps.size();
+    metadata.topics_with_message_count = {topic_information};
+
+    auto storage = std::make_shared<NiceMock<MockStorage>>();
+    ON_CALL(*storage, get_metadata).WillByDefault(Return(metadata));
+    ON_CALL(*storage, get_all_topics_and_types).WillByDefault(
+      Return(std::vector<rosbag2_storage::TopicMetadata>{topic_information.topic_metadata}));
+    return storage;
+  }
+
+  std::unique_ptr<StrictMock<MockStorageFactory>> storage_factory_;
+  std::unique_ptr<NiceMock<MockMetadataIo>> metadata_io_;
+  std::vector<rosbag2_storage::BagMetadata> written_metadata_;
+  std::string bag_path_;
+  rosbag2_cpp::StorageOptions storage_options_;
+};
+
+TEST_F(ReindexerTest, find_bagfiles_orders_bagfiles_by_index_and_skips_other_files) {
+  const auto first_file = create_file("bag_0.db3");
+  const auto tenth_file = create_file("bag_10.db3");
+  const auto second_file = create_file("bag_1.db3");
+  create_file("bag_1.db3-wal");
+  create_file("bag_x.db3");
+  create_file("metadata.yaml.tmp");
+
+  EXPECT_THAT(
+    rosbag2_cpp::Reindexer::find_bagfiles(bag_path_),
+    ElementsAre(first_file, second_file, tenth_file));
+}
+
+TEST_F(ReindexerTest, reindex_merges_the_summaries_of_all_readable_bagfiles) {
+  const auto first_file = create_file("bag_0.db3");
+  const auto corrupt_file = create_file("bag_1.db3");
+  const auto last_file = create_file("bag_2.db3");
+
+  EXPECT_CALL(*storage_factory_, open_read_only(first_file, "storage_id"))
+  .WillOnce(Return(make_storage("topic", {100, 200})));
+  EXPECT_CALL(*storage_factory_, open_read_only(corrupt_file, "storage_id"))
+  .WillOnce(Throw(std::runtime_error("database disk image is malformed")));
+  EXPECT_CALL(*storage_factory_, open_read_only(last_file, "storage_id"))
+  .WillOnce(Return(make_storage("topic", {300, 350, 400})));
+
+  rosbag2_cpp::Reindexer reindexer(std::move(storage_factory_), std::move(metadata_io_));
+  const auto metadata = reindexer.reindex(storage_options_, 3);
+
+  ASSERT_THAT(written_metadata_, SizeIs(1));
+  EXPECT_TRUE(written_metadata_[0].finalized);
+  EXPECT_THAT(metadata.storage_identifier, Eq("storage_id"));
+  EXPECT_THAT(metadata.relative_file_paths, ElementsAre("bag_0.db3", "bag_2.db3"));
+  EXPECT_THAT(metadata.message_count, Eq(5u));
+  EXPECT_THAT(metadata.starting_time.time_since_epoch().count(), Eq(100));
+  EXPECT_THAT(metadata.duration.count(), Eq(300));
+
+  ASSERT_THAT(metadata.files, SizeIs(2));
+  EXPECT_THAT(metadata.files[1].path, Eq("bag_2.db3"));
+  EXPECT_THAT(metadata.files[1].message_count, Eq(3u));
+  EXPECT_THAT(metadata.files[1].starting_time.time_since_epoch().count(), Eq(300));
+  EXPECT_THAT(metadata.files[1].topics_message_count, ElementsAre(Pair("topic", 3u)));
+
+  ASSERT_THAT(metadata.topics_with_message_count, SizeIs(1));
+  const auto & topic = metadata.topics_with_message_count[0];
+  EXPECT_THAT(topic.topic_metadata.name, Eq("topic"));
+  EXPECT_THAT(topic.message_count, Eq(5u));
+  EXPECT_THAT(topic.total_bytes, Eq(50u));
+  EXPECT_THAT(topic.starting_time.time_since_epoch().count(), Eq(100));
+  EXPECT_THAT(topic.duration.count(), Eq(300));
+}
+
+TEST_F(ReindexerTest, reindex_keeps_storage_and_compression_of_existing_metadata) {
+  const auto file = create_file("bag_0.db3");
+  rosbag2_storage::BagMetadata existing_metadata{};
+  existing_metadata.storage_identifier = "stored_id";
+  existing_metadata.compression_format = "zstd";
+  existing_metadata.compression_mode = "MESSAGE";
+  ON_CALL(*metadata_io_, metadata_file_exists(bag_path_)).WillByDefault(Return(true));
+  ON_CALL(*metadata_io_, read_metadata(bag_path_)).WillByDefault(Return(existing_metadata));
+
+  EXPECT_CALL(*storage_factory_, open_read_only(file, "stored_id"))
+  .WillOnce(Return(make_storage("topic", {100})));
+
+  rosbag2_cpp::Reindexer reindexer(std::move(storage_factory_), std::move(metadata_io_));
+  storage_options_.storage_id = "";
+  const auto metadata = reindexer.reindex(storage_options_);
+
+  EXPECT_THAT(metadata.storage_identifier, Eq("stored_id"));
+  EXPECT_THAT(metadata.compression_format, Eq("zstd"));
+  EXPECT_THAT(metadata.compression_mode, Eq("MESSAGE"));
+  EXPECT_THAT(metadata.message_count, Eq(1u));
+}
+
+TEST_F(ReindexerTest, reindex_takes_complete_files_from_the_snapshot_of_a_crashed_recording) {
+  create_file("bag_0.db3");
+  const auto last_listed_file = create_file("bag_1.db3");
+  const auto unlisted_file = create_file("bag_2.db3");
+
+  // The snapshot was taken after one message was written to the second file.
+  rosbag2_storage::BagMetadata snapshot{};
+  snapshot.storage_identifier = "storage_id";
+  snapshot.finalized = false;
+  snapshot.relative_file_paths = {"bag_0.db3", "bag_1.db3"};
+  snapshot.files.resize(2);
+  snapshot.files[0].path = "bag_0.db3";
+  snapshot.files[0].starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+    std::chrono::nanoseconds(100));
+  snapshot.files[0].duration = std::chrono::nanoseconds(100);
+  snapshot.files[0].message_count = 2;
+  snapshot.files[0].topics_message_count = {{"topic", 2}};
+  snapshot.files[1].path = "bag_1.db3";
+  snapshot.files[1].starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+    std::chrono::nanoseconds(300));
+  snapshot.files[1].message_count = 1;
+  snapshot.files[1].topics_message_count = {{"topic", 1}};
+  rosbag2_storage::TopicInformation snapshot_topic{{"topic", "type", "rmw_format", ""}, 3};
+  snapshot_topic.starting_time = snapshot.files[0].starting_time;
+  snapshot_topic.duration = std::chrono::nanoseconds(200);
+  snapshot_topic.total_bytes = 30;
+  snapshot.topics_with_message_count = {snapshot_topic};
+  ON_CALL(*metadata_io_, metadata_file_exists(bag_path_)).WillByDefault(Return(true));
+  ON_CALL(*metadata_io_, read_metadata(bag_path_)).WillByDefault(Return(snapshot));
+
+  // The first file is complete, so it is not opened again.
+  EXPECT_CALL(*storage_factory_, open_read_only(last_listed_file, "storage_id"))
+  .WillOnce(Return(make_storage("topic", {300, 350, 400})));
+  EXPECT_CALL(*storage_factory_, open_read_only(unlisted_file, "storage_id"))
+  .WillOnce(Return(make_storage("topic", {500})));
+
+  rosbag2_cpp::Reindexer reindexer(std::move(storage_factory_), std::move(metadata_io_));
+  const auto metadata = reindexer.reindex(storage_options_, 2);
+
+  EXPECT_TRUE(metadata.finalized);
+  EXPECT_THAT(metadata.relative_file_paths, ElementsAre("bag_0.db3", "bag_1.db3", "bag_2.db3"));
+  EXPECT_THAT(metadata.message_count, Eq(6u));
+  EXPECT_THAT(metadata.starting_time.time_since_epoch().count(), Eq(100));
+  EXPECT_THAT(metadata.duration.count(), Eq(400));
+  ASSERT_THAT(metadata.files, SizeIs(3));
+  EXPECT_THAT(metadata.files[0].message_count, Eq(2u));
+  EXPECT_THAT(metadata.files[0].duration.count(), Eq(100));
+  EXPECT_THAT(metadata.files[0].topics_message_count, ElementsAre(Pair("topic", 2u)));
+  EXPECT_THAT(metadata.files[1].message_count, Eq(3u));
+
+  ASSERT_THAT(metadata.topics_with_message_count, SizeIs(1));
+  const auto & topic = metadata.topics_with_message_count[0];
+  EXPECT_THAT(topic.topic_metadata.type, Eq("type"));
+  EXPECT_THAT(topic.message_count, Eq(6u));
+  // Two of the three messages in the snapshot belong to the first file.
+  EXPECT_THAT(topic.total_bytes, Eq(20u + 30u + 10u));
+  EXPECT_THAT(topic.starting_time.time_since_epoch().count(), Eq(100));
+  EXPECT_THAT(topic.duration.count(), Eq(400));
+}
+
+TEST_F(ReindexerTest, reindex_throws_for_bags_compressed_per_file) {
+  // A recording that stopped early: the last file was not compressed yet.
+  create_file("bag_0.db3.zstd");
+  create_file("bag_1.db3");
+  rosbag2_storage::BagMetadata existing_metadata{};
+  existing_metadata.storage_identifier = "storage_id";
+  existing_metadata.compression_format = "zstd";
+  existing_metadata.compression_mode = "FILE";
+  ON_CALL(*metadata_io_, metadata_file_exists(bag_path_)).WillByDefault(Return(true));
+  ON_CALL(*metadata_io_, read_metadata(bag_path_)).WillByDefault(Return(existing_metadata));
+  EXPECT_CALL(*metadata_io_, write_metadata(_, _)).Times(0);
+
+  rosbag2_cpp::Reindexer reindexer(std::move(storage_factory_), std::move(metadata_io_));
+  EXPECT_THROW(reindexer.reindex(storage_options_), std::runtime_error);
+
+  // The compressed files give the bag away without metadata as well.
+  rosbag2_cpp::Reindexer reindexer_without_metadata(
+    std::make_unique<StrictMock<MockStorageFactory>>(),
+    std::make_unique<NiceMock<MockMetadataIo>>());
+  EXPECT_THROW(reindexer_without_metadata.reindex(storage_options_), std::runtime_error);
+}
+
+TEST_F(ReindexerTest, reindex_throws_if_no_bagfile_can_be_read) {
+  rosbag2_cpp::Reindexer reindexer(std::move(storage_factory_), std::move(metadata_io_));
+  EXPECT_THROW(reindexer.reindex(storage_options_), std::runtime_error);
+
+  create_file("bag_0.db3");
+  rosbag2_cpp::Reindexer failing_reindexer(
+    std::make_unique<NiceMock<MockStorageFactory>>(), std::make_unique<NiceMock<MockMetadataIo>>());
+  EXPECT_THROW(failing_reindexer.reindex(storage_options_), std::runtime_error);
+}
+
+TEST_F(ReindexerTest, reindex_recovers_bagfiles_with_a_journal_before_reading_them) {
+  const auto file = create_file("bag_0.db3");
+  const auto journal = create_file("bag_0.db3-wal");
+
+  {
+    InSequence recovery_before_reading;
+    EXPECT_CALL(
+      *storage_factory_,
+      open_read_write((rcpputils::fs::path(bag_path_) / "bag_0").string(), "storage_id"))
+    .WillOnce(
+      InvokeWithoutArgs(
+        [journal]() {
+          // Recovering merges the journal into the file.
+          rcpputils::fs::remove(rcpputils::fs::path(journal));
+          return std::make_shared<NiceMock<MockStorage>>();
+        }));
+    EXPECT_CALL(*storage_factory_, open_read_only(file, "storage_id"))
+    .WillOnce(Return(make_storage("topic", {100})));
+  }
+
+  rosbag2_cpp::Reindexer reindexer(std::move(storage_factory_), std::move(metadata_io_));
+  const auto metadata = reindexer.reindex(storage_options_);
+
+  EXPECT_TRUE(metadata.finalized);
+  EXPECT_THAT(metadata.message_count, Eq(1u));
+}
+
+TEST_F(ReindexerTest, reindex_does_not_finalize_bags_with_a_journal_left_behind) {
+  const auto file = create_file("bag_0.db3");
+  create_file("bag_0.db3-wal");
+
+  EXPECT_CALL(*storage_factory_, open_read_write(_, "storage_id"))
+  .WillOnce(Throw(std::runtime_error("database is locked")));
+  EXPECT_CALL(*storage_factory_, open_read_only(file, "storage_id"))
+  .WillOnce(Return(make_storage("topic", {100})));
+
+  rosbag2_cpp::Reindexer reindexer(std::move(storage_factory_), std::move(metadata_io_));
+  const auto metadata = reindexer.reindex(storage_options_);
+
+  ASSERT_THAT(written_metadata_, SizeIs(1));
+  EXPECT_FALSE(written_metadata_[0].finalized);
+  EXPECT_THAT(metadata.message_count, Eq(1u));
+}
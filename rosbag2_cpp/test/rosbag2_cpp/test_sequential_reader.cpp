@@ -151,3 +151,25 @@ TEST_F(SequentialReaderTest, set_filter_calls_storage) {
   reader_->get_implementation_handle().reset_filter();
   reader_->read_next();
 }
+
+TEST(SequentialReaderImmutableTest, finalized_bags_are_opened_in_immutable_mode) {
+  auto storage = std::make_shared<NiceMock<MockStorage>>();
+  auto storage_factory = std::make_unique<StrictMock<MockStorageFactory>>();
+  auto metadata_io = std::make_unique<NiceMock<MockMetadataIo>>();
+  const auto storage_uri = rcpputils::fs::temp_directory_path().string();
+
+  rosbag2_storage::BagMetadata metadata;
+  metadata.relative_file_paths = {(rcpputils::fs::path(storage_uri) / "some/folder").string()};
+  metadata.topics_with_message_count.push_back({{"topic", "type", "rmw1_format", ""}, 1});
+  metadata.finalized = true;
+  EXPECT_CALL(*metadata_io, read_metadata(_)).WillRepeatedly(Return(metadata));
+  EXPECT_CALL(*metadata_io, metadata_file_exists(_)).WillRepeatedly(Return(true));
+
+  EXPECT_CALL(*storage_factory, open_read_only(_, _)).Times(0);
+  EXPECT_CALL(*storage_factory, open_read_only_immutable(_, _)).WillOnce(Return(storage));
+
+  rosbag2_cpp::readers::SequentialReader reader(
+    std::move(storage_factory), std::make_shared<StrictMock<MockConverterFactory>>(),
+    std::move(metadata_io));
+  reader.open({storage_uri, ""}, {"", "rmw1_format"});
+}
@@ -14,8 +14,16 @@
 
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -170,11 +178,12 @@ TEST_F(SequentialWriterTest, open_throws_error_on_invalid_splitting_size) {
   EXPECT_THROW(writer_->open(storage_options_, {rmw_format, rmw_format}), std::runtime_error);
 }
 
-TEST_F(SequentialWriterTest, bagfile_size_is_checked_on_every_write) {
+TEST_F(SequentialWriterTest, bagfile_size_estimate_is_checked_on_every_write) {
   const int counter = 10;
   const uint64_t max_bagfile_size = 100;
 
-  EXPECT_CALL(*storage_, get_bagfile_size()).Times(counter);
+  EXPECT_CALL(*storage_, get_bagfile_size_estimate()).Times(counter);
+  EXPECT_CALL(*storage_, get_bagfile_size()).Times(0);
 
   auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
     std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
@@ -195,6 +204,32 @@ TEST_F(SequentialWriterTest, bagfile_size_is_checked_on_every_write) {
   }
 }
 
+TEST_F(SequentialWriterTest, real_bagfile_size_is_checked_periodically) {
+  const auto interval = rosbag2_storage::storage_interfaces::BAGFILE_SIZE_RECONCILIATION_INTERVAL;
+  const uint64_t max_bagfile_size = 100;
+
+  EXPECT_CALL(*storage_, get_bagfile_size_estimate()).Times(static_cast<int>(2 * (interval - 1)));
+  EXPECT_CALL(*storage_, get_bagfile_size()).Times(2);
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+
+  storage_options_.max_bagfile_size = max_bagfile_size;
+
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  for (uint64_t i = 0; i < 2 * interval; ++i) {
+    writer_->write(message);
+  }
+}
+
 TEST_F(SequentialWriterTest, writer_splits_when_storage_bagfile_size_gt_max_bagfile_size) {
   const int message_count = 15;
   const int max_bagfile_size = 5;
@@ -212,6 +247,10 @@ TEST_F(SequentialWriterTest, writer_splits_when_storage_bagfile_size_gt_max_bagf
     [this]() {
       return fake_storage_size_;
     });
+  ON_CALL(*storage_, get_bagfile_size_estimate).WillByDefault(
+    [this]() {
+      return fake_storage_size_;
+    });
 
   ON_CALL(*storage_, get_relative_file_path).WillByDefault(
     [this]() {
@@ -264,6 +303,364 @@ TEST_F(SequentialWriterTest, writer_splits_when_storage_bagfile_size_gt_max_bagf
   }
 }
 
+TEST_F(SequentialWriterTest, finalized_metadata_summarizes_each_file) {
+  const int message_count = 15;
+  const int max_bagfile_size = 5;
+  fake_storage_size_ = 0;
+
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [this](std::shared_ptr<const rosbag2_storage::SerializedBagMessage>) {
+      fake_storage_size_ += 1;
+    });
+  ON_CALL(*storage_, get_bagfile_size).WillByDefault(
+    [this]() {
+      return fake_storage_size_;
+    });
+  ON_CALL(*storage_, get_bagfile_size_estimate).WillByDefault(
+    [this]() {
+      return fake_storage_size_;
+    });
+  ON_CALL(*storage_, get_relative_file_path).WillByDefault(
+    [this]() {
+      return fake_storage_uri_;
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_size = max_bagfile_size;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  writer_->create_topic({"other_topic", "test_msgs/BasicTypes", "", ""});
+
+  // The bagfile is split once it exceeds the maximum size, i.e. after every 6 messages.
+  for (auto i = 0; i < message_count; ++i) {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = i < 6 ? "test_topic" : "other_topic";
+    message->time_stamp = i * 10;
+    writer_->write(message);
+  }
+  writer_.reset();
+
+  ASSERT_THAT(fake_metadata_.files, SizeIs(3));
+  for (size_t i = 0; i < fake_metadata_.files.size(); ++i) {
+    EXPECT_EQ(fake_metadata_.files[i].path, fake_metadata_.relative_file_paths[i]);
+  }
+
+  const auto & first_file = fake_metadata_.files[0];
+  EXPECT_EQ(first_file.starting_time.time_since_epoch().count(), 0);
+  EXPECT_EQ(first_file.duration.count(), 50);
+  EXPECT_EQ(first_file.message_count, 6u);
+  EXPECT_THAT(first_file.topics_message_count, ElementsAre(Pair("test_topic", 6u)));
+
+  const auto & last_file = fake_metadata_.files[2];
+  EXPECT_EQ(last_file.starting_time.time_since_epoch().count(), 120);
+  EXPECT_EQ(last_file.duration.count(), 20);
+  EXPECT_EQ(last_file.message_count, 3u);
+  EXPECT_THAT(last_file.topics_message_count, ElementsAre(Pair("other_topic", 3u)));
+}
+
+TEST_F(SequentialWriterTest, metadata_snapshots_are_written_on_open_and_at_every_split) {
+  fake_storage_size_ = 0;
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [this](std::shared_ptr<const rosbag2_storage::SerializedBagMessage>) {
+      fake_storage_size_ += 1;
+    });
+  ON_CALL(*storage_, get_bagfile_size).WillByDefault(
+    [this]() {
+      return fake_storage_size_;
+    });
+  ON_CALL(*storage_, get_bagfile_size_estimate).WillByDefault(
+    [this]() {
+      return fake_storage_size_;
+    });
+  ON_CALL(*storage_, get_relative_file_path).WillByDefault(
+    [this]() {
+      return fake_storage_uri_;
+    });
+  std::vector<rosbag2_storage::BagMetadata> written_metadata;
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [&written_metadata](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      written_metadata.push_back(metadata);
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_size = 5;
+  // Long enough for the timer not to trigger during the test.
+  storage_options_.metadata_snapshot_interval = 3600;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  // The bagfile is split once it exceeds the maximum size, i.e. after every 6 messages.
+  for (auto i = 0; i < 15; ++i) {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = "test_topic";
+    writer_->write(message);
+  }
+  writer_.reset();
+
+  ASSERT_THAT(written_metadata, SizeIs(4));
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_FALSE(written_metadata[i].finalized);
+    EXPECT_THAT(written_metadata[i].files, SizeIs(i + 1));
+  }
+  EXPECT_THAT(written_metadata[1].files[0].message_count, Eq(6u));
+  EXPECT_THAT(written_metadata[2].files[1].message_count, Eq(6u));
+  EXPECT_TRUE(written_metadata[3].finalized);
+  EXPECT_THAT(written_metadata[3].files, SizeIs(3));
+  EXPECT_THAT(written_metadata[3].message_count, Eq(15u));
+}
+
+TEST_F(SequentialWriterTest, metadata_snapshots_are_written_on_a_timer) {
+  // Snapshots are written on a background thread.
+  std::mutex written_metadata_mutex;
+  std::condition_variable metadata_written;
+  std::vector<rosbag2_storage::BagMetadata> written_metadata;
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [&](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      {
+        std::lock_guard<std::mutex> lock(written_metadata_mutex);
+        written_metadata.push_back(metadata);
+      }
+      metadata_written.notify_all();
+    });
+  auto wait_for_written_metadata = [&](size_t count) {
+      std::unique_lock<std::mutex> lock(written_metadata_mutex);
+      metadata_written.wait_for(
+        lock, std::chrono::seconds(10), [&] {return written_metadata.size() >= count;});
+    };
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.metadata_snapshot_interval = 1;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+
+  writer_->write(message);
+  wait_for_written_metadata(1);
+  ASSERT_THAT(written_metadata, SizeIs(1));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  writer_->write(message);
+  wait_for_written_metadata(2);
+  ASSERT_THAT(written_metadata, SizeIs(2));
+  EXPECT_FALSE(written_metadata[1].finalized);
+  EXPECT_THAT(written_metadata[1].message_count, Eq(2u));
+
+  writer_.reset();
+  ASSERT_THAT(written_metadata, SizeIs(3));
+  EXPECT_TRUE(written_metadata[2].finalized);
+}
+
+TEST_F(SequentialWriterTest, finalized_metadata_holds_statistics_of_each_topic) {
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  writer_->create_topic({"other_topic", "test_msgs/BasicTypes", "", ""});
+
+  auto write_message = [this](const std::string & topic, size_t size, int64_t time_stamp) {
+      auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+      message->serialized_data = std::make_shared<rcutils_uint8_array_t>();
+      message->serialized_data->buffer_length = size;
+      message->topic_name = topic;
+      message->time_stamp = time_stamp;
+      writer_->write(message);
+    };
+  write_message("test_topic", 10, 300);
+  write_message("other_topic", 1000, 100);
+  write_message("test_topic", 12, 200);
+  write_message("test_topic", 100, 700);
+  writer_.reset();
+
+  std::map<std::string, rosbag2_storage::TopicInformation> topics;
+  for (const auto & topic : fake_metadata_.topics_with_message_count) {
+    topics[topic.topic_metadata.name] = topic;
+  }
+  ASSERT_THAT(topics, SizeIs(2));
+
+  const auto & test_topic = topics["test_topic"];
+  EXPECT_EQ(test_topic.total_bytes, 122u);
+  EXPECT_EQ(test_topic.starting_time.time_since_epoch().count(), 200);
+  EXPECT_EQ(test_topic.duration.count(), 500);
+  EXPECT_THAT(test_topic.size_histogram, ElementsAre(0u, 0u, 0u, 0u, 2u, 0u, 0u, 1u));
+
+  const auto & other_topic = topics["other_topic"];
+  EXPECT_EQ(other_topic.total_bytes, 1000u);
+  EXPECT_EQ(other_topic.starting_time.time_since_epoch().count(), 100);
+  EXPECT_EQ(other_topic.duration.count(), 0);
+  EXPECT_THAT(other_topic.size_histogram, SizeIs(11));
+}
+
+TEST_F(SequentialWriterTest, writer_splits_by_duration_of_message_timestamps) {
+  const int64_t second = 1000000000;
+  ON_CALL(*storage_, get_relative_file_path).WillByDefault(
+    [this]() {
+      return fake_storage_uri_;
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_duration = 1;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  // Each bagfile covers one second from its first message on.
+  for (const auto time_stamp : {5, 9, 10, 15, 22, 24}) {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = "test_topic";
+    message->time_stamp = time_stamp * second / 10;
+    writer_->write(message);
+  }
+  writer_.reset();
+
+  ASSERT_THAT(fake_metadata_.files, SizeIs(2));
+  EXPECT_EQ(fake_metadata_.files[0].message_count, 3u);
+  EXPECT_EQ(fake_metadata_.files[1].message_count, 3u);
+  EXPECT_EQ(fake_metadata_.starting_time.time_since_epoch().count(), 5 * second / 10);
+}
+
+TEST_F(SequentialWriterTest, aligned_duration_splits_happen_at_multiples_of_the_duration) {
+  const int64_t second = 1000000000;
+  ON_CALL(*storage_, get_relative_file_path).WillByDefault(
+    [this]() {
+      return fake_storage_uri_;
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_duration = 1;
+  storage_options_.align_bagfile_duration = true;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  // Bagfiles cover the full seconds [0, 1), [1, 2) and [2, 3).
+  for (const auto time_stamp : {5, 9, 10, 15, 22, 24}) {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = "test_topic";
+    message->time_stamp = time_stamp * second / 10;
+    writer_->write(message);
+  }
+  writer_.reset();
+
+  ASSERT_THAT(fake_metadata_.files, SizeIs(3));
+  for (const auto & file : fake_metadata_.files) {
+    EXPECT_EQ(file.message_count, 2u);
+  }
+  EXPECT_EQ(fake_metadata_.files[1].starting_time.time_since_epoch().count(), second);
+}
+
+TEST_F(SequentialWriterTest, prepared_next_file_is_rolled_over_to_with_topics_registered) {
+  const int message_count = 15;
+  const int max_bagfile_size = 5;
+
+  // Every opened bagfile gets its own storage, each counting the messages written to it.
+  std::vector<std::shared_ptr<NiceMock<MockStorage>>> storages;
+  std::vector<std::string> opened_uris;
+  std::vector<uint64_t> storage_sizes;
+  // Bagfiles are opened in the background, the sizes must not be reallocated meanwhile.
+  storage_sizes.reserve(message_count);
+  std::mutex storages_mutex;
+  EXPECT_CALL(*storage_factory_, open_read_write(_, _)).WillRepeatedly(
+    [&](const std::string & uri, const std::string &) {
+      std::lock_guard<std::mutex> lock(storages_mutex);
+      auto storage = std::make_shared<NiceMock<MockStorage>>();
+      const auto storage_index = storages.size();
+      ON_CALL(
+        *storage,
+        write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+        [&, storage_index](std::shared_ptr<const rosbag2_storage::SerializedBagMessage>) {
+          ++storage_sizes[storage_index];
+        });
+      ON_CALL(*storage, get_bagfile_size).WillByDefault(
+        [&, storage_index]() {
+          return storage_sizes[storage_index];
+        });
+      ON_CALL(*storage, get_bagfile_size_estimate).WillByDefault(
+        [&, storage_index]() {
+          return storage_sizes[storage_index];
+        });
+      ON_CALL(*storage, get_relative_file_path).WillByDefault(Return(uri));
+      EXPECT_CALL(*storage, create_topic(_)).Times(1);
+      storages.push_back(storage);
+      opened_uris.push_back(uri);
+      storage_sizes.push_back(0);
+      return storage;
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_size = max_bagfile_size;
+  storage_options_.prepare_next_file = true;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+  for (auto i = 0; i < message_count; ++i) {
+    writer_->write(message);
+  }
+  writer_.reset();
+
+  // Three bagfiles were written to, the one prepared after the last split was discarded.
+  ASSERT_THAT(opened_uris, SizeIs(4));
+  ASSERT_THAT(fake_metadata_.relative_file_paths, SizeIs(3));
+  for (size_t i = 0; i < fake_metadata_.relative_file_paths.size(); ++i) {
+    EXPECT_EQ(
+      fake_metadata_.relative_file_paths[i],
+      rcpputils::fs::path(opened_uris[i]).filename().string());
+  }
+  EXPECT_EQ(storage_sizes[3], 0u);
+}
+
 TEST_F(SequentialWriterTest, only_write_after_cache_is_full) {
   const size_t counter = 1000;
   const uint64_t max_cache_size = 100;
@@ -296,17 +693,20 @@ TEST_F(SequentialWriterTest, only_write_after_cache_is_full) {
   }
 }
 
-TEST_F(SequentialWriterTest, do_not_use_cache_if_cache_size_is_zero) {
+TEST_F(SequentialWriterTest, write_once_cache_holds_max_cache_bytes) {
   const size_t counter = 1000;
-  const uint64_t max_cache_size = 0;
+  const uint64_t max_cache_size = 100;
+  const uint64_t max_cache_bytes = 250;
+  const size_t message_size = 10;
 
+  // The byte limit is reached first, after 25 messages.
   EXPECT_CALL(
     *storage_,
     write(An<const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> &>())).
-  Times(0);
+  Times(counter * message_size / max_cache_bytes);
   EXPECT_CALL(
     *storage_,
-    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).Times(counter);
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).Times(0);
 
   auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
     std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
@@ -316,9 +716,12 @@ TEST_F(SequentialWriterTest, do_not_use_cache_if_cache_size_is_zero) {
 
   auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
   message->topic_name = "test_topic";
+  message->serialized_data = std::make_shared<rcutils_uint8_array_t>();
+  message->serialized_data->buffer_length = message_size;
 
   storage_options_.max_bagfile_size = 0;
   storage_options_.max_cache_size = max_cache_size;
+  storage_options_.max_cache_bytes = max_cache_bytes;
 
   writer_->open(storage_options_, {rmw_format, rmw_format});
   writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
@@ -327,3 +730,740 @@ TEST_F(SequentialWriterTest, do_not_use_cache_if_cache_size_is_zero) {
     writer_->write(message);
   }
 }
+
+TEST_F(SequentialWriterTest, async_cache_flush_writes_all_messages_in_order) {
+  const size_t counter = 1000;
+  const uint64_t max_cache_size = 10;
+
+  std::vector<rcutils_time_point_value_t> written_timestamps;
+  ON_CALL(
+    *storage_,
+    write(An<const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> &>())).
+  WillByDefault(
+    [&written_timestamps](
+      const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> & messages) {
+      for (const auto & message : messages) {
+        written_timestamps.push_back(message->time_stamp);
+      }
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_cache_size = max_cache_size;
+  storage_options_.async_cache_flush = true;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  // Leave a partially filled cache, which is written on reset.
+  for (auto i = 0u; i < counter + max_cache_size / 2; ++i) {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = "test_topic";
+    message->time_stamp = i;
+    writer_->write(message);
+  }
+  writer_.reset();
+
+  ASSERT_THAT(written_timestamps, SizeIs(counter + max_cache_size / 2));
+  for (size_t i = 0; i < written_timestamps.size(); ++i) {
+    EXPECT_EQ(written_timestamps[i], static_cast<rcutils_time_point_value_t>(i));
+  }
+  EXPECT_EQ(fake_metadata_.message_count, counter + max_cache_size / 2);
+}
+
+TEST_F(SequentialWriterTest, concurrent_write_writes_messages_of_all_threads_in_order) {
+  const int producer_count = 4;
+  const int messages_per_producer = 1000;
+
+  // Topic name -> timestamps in the order they were written to the storage.
+  std::map<std::string, std::vector<rcutils_time_point_value_t>> written_timestamps;
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&written_timestamps](std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      written_timestamps[message->topic_name].push_back(message->time_stamp);
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.concurrent_write = true;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < producer_count; ++producer) {
+    producers.emplace_back(
+      [this, producer]() {
+        const auto topic_name = "topic_" + std::to_string(producer);
+        writer_->create_topic({topic_name, "test_msgs/BasicTypes", "", ""});
+        for (int i = 0; i < messages_per_producer; ++i) {
+          auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+          message->topic_name = topic_name;
+          message->time_stamp = i;
+          writer_->write(message);
+        }
+      });
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+  writer_.reset();
+
+  ASSERT_THAT(written_timestamps, SizeIs(producer_count));
+  for (const auto & topic_timestamps : written_timestamps) {
+    ASSERT_THAT(topic_timestamps.second, SizeIs(messages_per_producer));
+    for (int i = 0; i < messages_per_producer; ++i) {
+      EXPECT_EQ(topic_timestamps.second[i], i);
+    }
+  }
+  EXPECT_EQ(fake_metadata_.message_count, 1u * producer_count * messages_per_producer);
+}
+
+TEST_F(SequentialWriterTest, concurrent_write_rejects_messages_on_unknown_topics) {
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.concurrent_write = true;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+  EXPECT_THROW(writer_->write(message), std::runtime_error);
+
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  EXPECT_NO_THROW(writer_->write(message));
+}
+
+TEST_F(SequentialWriterTest, create_topic_returns_a_dense_handle_per_topic) {
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+
+  EXPECT_EQ(writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""}), 0u);
+  EXPECT_EQ(writer_->create_topic({"other_topic", "test_msgs/BasicTypes", "", ""}), 1u);
+  EXPECT_EQ(writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""}), 0u);
+
+  writer_->remove_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  EXPECT_THROW(writer_->write(0, 0, nullptr), std::runtime_error);
+  EXPECT_EQ(writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""}), 2u);
+}
+
+TEST_F(SequentialWriterTest, write_by_handle_binds_messages_to_the_storage_topic_id) {
+  std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> written_messages;
+  ON_CALL(*storage_, get_topic_id("test_topic")).WillByDefault(Return(7));
+  ON_CALL(*storage_, get_topic_id("other_topic")).WillByDefault(Return(-1));
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&written_messages](std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      written_messages.push_back(message);
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  const auto test_topic = writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  const auto other_topic =
+    writer_->create_topic({"other_topic", "test_msgs/BasicTypes", "", ""});
+
+  writer_->write(test_topic, 42, std::make_shared<rcutils_uint8_array_t>());
+  // Storages without topic ids get the topic name instead.
+  writer_->write(other_topic, 43, std::make_shared<rcutils_uint8_array_t>());
+  EXPECT_THROW(
+    writer_->write(other_topic + 1, 44, std::make_shared<rcutils_uint8_array_t>()),
+    std::runtime_error);
+  writer_.reset();
+
+  ASSERT_THAT(written_messages, SizeIs(2));
+  EXPECT_EQ(written_messages[0]->topic_id, 7);
+  EXPECT_THAT(written_messages[0]->topic_name, IsEmpty());
+  EXPECT_EQ(written_messages[0]->time_stamp, 42);
+  EXPECT_EQ(written_messages[1]->topic_id, -1);
+  EXPECT_EQ(written_messages[1]->topic_name, "other_topic");
+  EXPECT_EQ(fake_metadata_.message_count, 2u);
+  EXPECT_EQ(fake_metadata_.files[0].topics_message_count["test_topic"], 1u);
+}
+
+TEST_F(SequentialWriterTest, write_by_handle_takes_topic_ids_of_the_storage_after_a_split) {
+  std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> written_messages;
+  int32_t storage_topic_id = 1;
+  ON_CALL(*storage_, get_topic_id(_)).WillByDefault(
+    [&storage_topic_id](const std::string &) {
+      return storage_topic_id;
+    });
+  ON_CALL(*storage_, create_topic(_)).WillByDefault(
+    [&storage_topic_id](const rosbag2_storage::TopicMetadata &) {
+      ++storage_topic_id;
+    });
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&written_messages](std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      written_messages.push_back(message);
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  const int64_t second = 1000000000;
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_duration = 1;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  const auto topic = writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  writer_->write(topic, 0, std::make_shared<rcutils_uint8_array_t>());
+  writer_->write(topic, 2 * second, std::make_shared<rcutils_uint8_array_t>());
+  writer_.reset();
+
+  ASSERT_THAT(written_messages, SizeIs(2));
+  EXPECT_EQ(written_messages[0]->topic_id, 2);
+  EXPECT_EQ(written_messages[1]->topic_id, 3);
+}
+
+TEST_F(SequentialWriterTest, concurrent_write_accepts_messages_by_handle) {
+  std::atomic<int> written_message_count{0};
+  ON_CALL(*storage_, get_topic_id(_)).WillByDefault(Return(1));
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&written_message_count](std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      EXPECT_EQ(message->topic_id, 1);
+      ++written_message_count;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.concurrent_write = true;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  EXPECT_THROW(writer_->write(0, 0, nullptr), std::runtime_error);
+
+  const auto topic = writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  for (int i = 0; i < 10; ++i) {
+    writer_->write(topic, i, std::make_shared<rcutils_uint8_array_t>());
+  }
+  writer_.reset();
+
+  EXPECT_EQ(written_message_count, 10);
+}
+
+TEST_F(SequentialWriterTest, messages_written_by_value_reuse_the_objects_of_written_messages) {
+  std::vector<const rosbag2_storage::SerializedBagMessage *> written_messages;
+  std::vector<rcutils_time_point_value_t> written_time_stamps;
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&](std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      written_messages.push_back(message.get());
+      written_time_stamps.push_back(message->time_stamp);
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  const auto topic = writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  rosbag2_storage::SerializedBagMessage message;
+  message.topic_name = "test_topic";
+  message.time_stamp = 1;
+  writer_->write(std::move(message));
+
+  auto unique_message = std::make_unique<rosbag2_storage::SerializedBagMessage>();
+  unique_message->topic_name = "test_topic";
+  unique_message->time_stamp = 2;
+  writer_->write(std::move(unique_message));
+
+  writer_->write(topic, 3, std::make_shared<rcutils_uint8_array_t>());
+
+  EXPECT_THROW(
+    writer_->write(std::unique_ptr<rosbag2_storage::SerializedBagMessage>()), std::runtime_error);
+  writer_.reset();
+
+  EXPECT_THAT(written_time_stamps, ElementsAre(1, 2, 3));
+  ASSERT_THAT(written_messages, SizeIs(3));
+  EXPECT_EQ(written_messages[1], written_messages[0]);
+  EXPECT_EQ(written_messages[2], written_messages[0]);
+}
+
+TEST_F(SequentialWriterTest, backpressure_drops_newest_messages_over_the_ingestion_budget) {
+  const uint64_t message_size = 10;
+
+  // The first message is not written until released, so that the queue fills up.
+  std::promise<void> release_write;
+  auto write_released = release_write.get_future().share();
+  std::vector<rcutils_time_point_value_t> written_timestamps;
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&written_timestamps, write_released](
+      std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      write_released.wait();
+      written_timestamps.push_back(message->time_stamp);
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  auto sequential_writer_ptr = sequential_writer.get();
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.concurrent_write = true;
+  storage_options_.max_queued_bytes = 3 * message_size;
+  storage_options_.default_backpressure.policy = rosbag2_cpp::BackpressurePolicy::DROP_NEWEST;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  // Messages are accounted until written, so only the first three fit into the budget.
+  for (auto i = 0; i < 5; ++i) {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = "test_topic";
+    message->time_stamp = i;
+    message->serialized_data = std::make_shared<rcutils_uint8_array_t>();
+    message->serialized_data->buffer_length = message_size;
+    writer_->write(message);
+  }
+
+  const auto dropped_messages = sequential_writer_ptr->get_dropped_messages();
+  ASSERT_THAT(dropped_messages, SizeIs(1));
+  EXPECT_EQ(dropped_messages.at("test_topic").message_count, 2u);
+  EXPECT_EQ(dropped_messages.at("test_topic").bytes, 2 * message_size);
+
+  release_write.set_value();
+  writer_.reset();
+
+  EXPECT_THAT(written_timestamps, ElementsAre(0, 1, 2));
+  ASSERT_THAT(fake_metadata_.topics_with_message_count, SizeIs(1));
+  EXPECT_EQ(fake_metadata_.topics_with_message_count[0].message_count, 3u);
+  EXPECT_EQ(fake_metadata_.topics_with_message_count[0].dropped_message_count, 2u);
+  EXPECT_EQ(fake_metadata_.topics_with_message_count[0].dropped_bytes, 2 * message_size);
+}
+
+TEST_F(SequentialWriterTest, backpressure_policies_apply_per_topic) {
+  const uint64_t message_size = 10;
+
+  // The first message is not written until released, so that the queue fills up.
+  std::promise<void> write_entered;
+  std::promise<void> release_write;
+  auto write_released = release_write.get_future().share();
+  std::vector<std::pair<std::string, rcutils_time_point_value_t>> written_messages;
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&written_messages, &write_entered, write_released](
+      std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      if (written_messages.empty()) {
+        write_entered.set_value();
+      }
+      write_released.wait();
+      written_messages.emplace_back(message->topic_name, message->time_stamp);
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  auto sequential_writer_ptr = sequential_writer.get();
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.concurrent_write = true;
+  storage_options_.max_queued_bytes = 3 * message_size;
+  storage_options_.topic_backpressure["oldest"].policy =
+    rosbag2_cpp::BackpressurePolicy::DROP_OLDEST;
+  storage_options_.topic_backpressure["nth"].policy =
+    rosbag2_cpp::BackpressurePolicy::KEEP_EVERY_NTH;
+  storage_options_.topic_backpressure["nth"].keep_every_nth = 2;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"oldest", "test_msgs/BasicTypes", "", ""});
+  writer_->create_topic({"nth", "test_msgs/BasicTypes", "", ""});
+
+  auto write = [this, message_size](const std::string & topic_name, int64_t time_stamp) {
+      auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+      message->topic_name = topic_name;
+      message->time_stamp = time_stamp;
+      message->serialized_data = std::make_shared<rcutils_uint8_array_t>();
+      message->serialized_data->buffer_length = message_size;
+      writer_->write(message);
+    };
+
+  write("oldest", 0);
+  write_entered.get_future().wait();
+  // Fills the budget.
+  write("oldest", 1);
+  write("oldest", 2);
+  // Every second message is kept.
+  for (auto i = 0; i < 4; ++i) {
+    write("nth", i);
+  }
+  // Replace the oldest queued messages of the topic.
+  write("oldest", 3);
+  write("oldest", 4);
+
+  const auto dropped_messages = sequential_writer_ptr->get_dropped_messages();
+  ASSERT_THAT(dropped_messages, SizeIs(1));
+  EXPECT_EQ(dropped_messages.at("nth").message_count, 2u);
+
+  release_write.set_value();
+  writer_.reset();
+
+  EXPECT_THAT(
+    written_messages, ElementsAre(
+      Pair("oldest", 0), Pair("nth", 0), Pair("nth", 2), Pair("oldest", 3), Pair("oldest", 4)));
+  for (const auto & topic : fake_metadata_.topics_with_message_count) {
+    EXPECT_EQ(topic.dropped_message_count, 2u);
+  }
+}
+
+TEST_F(SequentialWriterTest, backpressure_drops_blocked_messages_when_the_writer_closes) {
+  const uint64_t message_size = 10;
+
+  // The first message is not written until released, so that it holds the ingestion budget.
+  std::promise<void> write_entered;
+  std::promise<void> release_write;
+  auto write_released = release_write.get_future().share();
+  std::vector<rcutils_time_point_value_t> written_timestamps;
+  ON_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).WillByDefault(
+    [&written_timestamps, &write_entered, write_released](
+      std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message) {
+      if (written_timestamps.empty()) {
+        write_entered.set_value();
+      }
+      write_released.wait();
+      written_timestamps.push_back(message->time_stamp);
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.concurrent_write = true;
+  storage_options_.max_queued_bytes = message_size;
+  storage_options_.default_backpressure.policy = rosbag2_cpp::BackpressurePolicy::BLOCK;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  auto writer = writer_.get();
+  auto write = [writer, message_size](int64_t time_stamp) {
+      auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+      message->topic_name = "test_topic";
+      message->time_stamp = time_stamp;
+      message->serialized_data = std::make_shared<rcutils_uint8_array_t>();
+      message->serialized_data->buffer_length = message_size;
+      writer->write(message);
+    };
+
+  write(0);
+  write_entered.get_future().wait();
+  // Blocks until the writer closes, since the first message holds the budget until written.
+  std::thread producer([&write]() {write(1);});
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::thread closer([this]() {writer_.reset();});
+  producer.join();
+  release_write.set_value();
+  closer.join();
+
+  EXPECT_THAT(written_timestamps, ElementsAre(0));
+  ASSERT_THAT(fake_metadata_.topics_with_message_count, SizeIs(1));
+  EXPECT_EQ(fake_metadata_.topics_with_message_count[0].message_count, 1u);
+  EXPECT_EQ(fake_metadata_.topics_with_message_count[0].dropped_message_count, 1u);
+  EXPECT_EQ(fake_metadata_.topics_with_message_count[0].dropped_bytes, message_size);
+}
+
+TEST_F(SequentialWriterTest, async_cache_flush_drops_messages_while_both_caches_are_full) {
+  const uint64_t max_cache_size = 2;
+
+  // The first cache handed over is not written until released.
+  std::promise<void> release_write;
+  auto write_released = release_write.get_future().share();
+  std::vector<rcutils_time_point_value_t> written_timestamps;
+  ON_CALL(
+    *storage_,
+    write(An<const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> &>())).
+  WillByDefault(
+    [&written_timestamps, write_released](
+      const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> & messages) {
+      write_released.wait();
+      for (const auto & message : messages) {
+        written_timestamps.push_back(message->time_stamp);
+      }
+    });
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_cache_size = max_cache_size;
+  storage_options_.async_cache_flush = true;
+  storage_options_.drop_messages_on_full_cache = true;
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  // Messages 0 and 1 are handed over, 2 and 3 fill the second cache, 4 and 5 are dropped.
+  for (auto i = 0; i < 6; ++i) {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = "test_topic";
+    message->time_stamp = i;
+    writer_->write(message);
+  }
+  release_write.set_value();
+  writer_.reset();
+
+  EXPECT_THAT(written_timestamps, ElementsAre(0, 1, 2, 3));
+  EXPECT_EQ(fake_metadata_.message_count, 4u);
+}
+
+TEST_F(SequentialWriterTest, do_not_use_cache_if_cache_size_is_zero) {
+  const size_t counter = 1000;
+  const uint64_t max_cache_size = 0;
+
+  EXPECT_CALL(
+    *storage_,
+    write(An<const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> &>())).
+  Times(0);
+  EXPECT_CALL(
+    *storage_,
+    write(An<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>())).Times(counter);
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+
+  storage_options_.max_bagfile_size = 0;
+  storage_options_.max_cache_size = max_cache_size;
+
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  for (auto i = 0u; i < counter; ++i) {
+    writer_->write(message);
+  }
+}
+
+TEST_F(SequentialWriterTest, write_with_id_reports_ids_once_the_cache_is_flushed) {
+  const uint64_t max_cache_size = 3;
+  int32_t next_id = 0;
+  ON_CALL(*storage_, get_last_inserted_id()).WillByDefault(
+    Invoke([&next_id]() {return ++next_id;}));
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_size = 0;
+  storage_options_.max_cache_size = max_cache_size;
+
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+
+  std::vector<int32_t> reported_ids;
+  writer_->write_with_id(message, [&reported_ids](int32_t id) {reported_ids.push_back(id);});
+  writer_->write(message);
+  auto id_future = writer_->write_with_id(message);
+  ASSERT_THAT(id_future.wait_for(std::chrono::seconds(0)), Eq(std::future_status::ready));
+  EXPECT_THAT(id_future.get(), Eq(3));
+  EXPECT_THAT(reported_ids, ElementsAre(1));
+
+  auto last_id_future = writer_->write_with_id(message);
+  EXPECT_THAT(
+    last_id_future.wait_for(std::chrono::seconds(0)), Eq(std::future_status::timeout));
+
+  writer_.reset();  // flushes the cache
+  EXPECT_THAT(last_id_future.get(), Eq(4));
+}
+
+TEST_F(SequentialWriterTest, cached_messages_are_written_on_reset) {
+  const uint64_t max_cache_size = 100;
+
+  EXPECT_CALL(
+    *storage_,
+    write(An<const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> &>())).
+  Times(1);
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.max_bagfile_size = 0;
+  storage_options_.max_cache_size = max_cache_size;
+
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+  writer_->write(message);
+
+  writer_.reset();
+}
+
+TEST_F(SequentialWriterTest, append_continues_the_bag_in_a_new_bagfile) {
+  const auto bag_path = rcpputils::fs::path(storage_options_.uri);
+  rcpputils::fs::create_directories(bag_path);
+  for (const auto & file_name : {"uri_0.db3", "uri_1.db3"}) {
+    std::ofstream((bag_path / file_name).string()) << "bagfile";
+  }
+
+  rosbag2_storage::BagMetadata existing_metadata{};
+  existing_metadata.storage_identifier = "sqlite3";
+  existing_metadata.relative_file_paths = {"uri_0.db3", "uri_1.db3"};
+  existing_metadata.files.resize(2);
+  existing_metadata.files[0].path = "uri_0.db3";
+  existing_metadata.files[1].path = "uri_1.db3";
+  existing_metadata.message_count = 5;
+  existing_metadata.topics_with_message_count.resize(2);
+  existing_metadata.topics_with_message_count[0].topic_metadata =
+  {"test_topic", "test_msgs/BasicTypes", "", ""};
+  existing_metadata.topics_with_message_count[0].message_count = 3;
+  existing_metadata.topics_with_message_count[1].topic_metadata =
+  {"other_topic", "test_msgs/Strings", "", ""};
+  existing_metadata.topics_with_message_count[1].message_count = 2;
+  existing_metadata.finalized = true;
+
+  ON_CALL(*metadata_io_, metadata_file_exists(_)).WillByDefault(Return(true));
+  ON_CALL(*metadata_io_, read_metadata(_)).WillByDefault(Return(existing_metadata));
+  ON_CALL(*metadata_io_, write_metadata).WillByDefault(
+    [this](const std::string &, const rosbag2_storage::BagMetadata & metadata) {
+      fake_metadata_ = metadata;
+    });
+  ON_CALL(*storage_, get_relative_file_path).WillByDefault(
+    [this]() {
+      return fake_storage_uri_;
+    });
+  // The storage of the bag is used when none is given.
+  EXPECT_CALL(*storage_factory_, open_read_write(_, "sqlite3")).Times(1);
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.append = true;
+
+  writer_->open(storage_options_, {rmw_format, rmw_format});
+  EXPECT_THAT(rcpputils::fs::path(fake_storage_uri_).filename().string(), Eq("uri_2"));
+
+  EXPECT_THROW(
+    writer_->create_topic({"other_topic", "test_msgs/BasicTypes", "", ""}), std::runtime_error);
+  writer_->create_topic({"test_topic", "test_msgs/BasicTypes", "", ""});
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->topic_name = "test_topic";
+  writer_->write(message);
+  writer_->write(message);
+  writer_.reset();
+
+  EXPECT_THAT(fake_metadata_.relative_file_paths, ElementsAre("uri_0.db3", "uri_1.db3", "uri_2"));
+  ASSERT_THAT(fake_metadata_.files, SizeIs(3));
+  EXPECT_THAT(fake_metadata_.files[2].message_count, Eq(2u));
+  EXPECT_THAT(fake_metadata_.message_count, Eq(7u));
+  EXPECT_TRUE(fake_metadata_.finalized);
+
+  std::map<std::string, size_t> topic_message_counts;
+  for (const auto & topic : fake_metadata_.topics_with_message_count) {
+    topic_message_counts[topic.topic_metadata.name] = topic.message_count;
+  }
+  EXPECT_THAT(
+    topic_message_counts,
+    ElementsAre(Pair("other_topic", 2u), Pair("test_topic", 5u)));
+}
+
+TEST_F(SequentialWriterTest, append_throws_and_keeps_the_bag_if_it_has_no_metadata) {
+  rcpputils::fs::create_directories(rcpputils::fs::path(storage_options_.uri));
+
+  ON_CALL(*metadata_io_, metadata_file_exists(_)).WillByDefault(Return(false));
+  EXPECT_CALL(*metadata_io_, write_metadata).Times(0);
+  EXPECT_CALL(*storage_factory_, open_read_write(_, _)).Times(0);
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.append = true;
+
+  EXPECT_THROW(writer_->open(storage_options_, {rmw_format, rmw_format}), std::runtime_error);
+  writer_.reset();
+}
+
+TEST_F(SequentialWriterTest, append_throws_and_keeps_the_bag_if_its_recording_did_not_finish) {
+  rcpputils::fs::create_directories(rcpputils::fs::path(storage_options_.uri));
+
+  rosbag2_storage::BagMetadata snapshot_metadata{};
+  snapshot_metadata.storage_identifier = "sqlite3";
+  snapshot_metadata.relative_file_paths = {"uri_0.db3"};
+  snapshot_metadata.files.resize(1);
+  snapshot_metadata.files[0].path = "uri_0.db3";
+  snapshot_metadata.finalized = false;
+
+  ON_CALL(*metadata_io_, metadata_file_exists(_)).WillByDefault(Return(true));
+  ON_CALL(*metadata_io_, read_metadata(_)).WillByDefault(Return(snapshot_metadata));
+  EXPECT_CALL(*metadata_io_, write_metadata).Times(0);
+  EXPECT_CALL(*storage_factory_, open_read_write(_, _)).Times(0);
+
+  auto sequential_writer = std::make_unique<rosbag2_cpp::writers::SequentialWriter>(
+    std::move(storage_factory_), converter_factory_, std::move(metadata_io_));
+  writer_ = std::make_unique<rosbag2_cpp::Writer>(std::move(sequential_writer));
+
+  std::string rmw_format = "rmw_format";
+  storage_options_.append = true;
+
+  EXPECT_THROW(writer_->open(storage_options_, {rmw_format, rmw_format}), std::runtime_error);
+  writer_.reset();
+}
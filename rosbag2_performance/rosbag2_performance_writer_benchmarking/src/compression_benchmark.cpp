@@ -0,0 +1,190 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures the per-message cost of zstd compression in MESSAGE mode: one compressor (and
+// decompressor) reused for all messages, as the compression writer and reader do, against a
+// new one for every message, which sets up the zstd context every time. Both swap a pooled
+// output buffer into the message. As a baseline, messages are also compressed the way they were
+// before: one-shot ZSTD_compress into a new vector, whose content is then copied into the
+// resized message buffer.
+//
+// Usage: compression_benchmark [message_size_bytes] [message_count]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rcutils/types.h"
+
+#include "zstd.h"
+
+#include "rosbag2_compression/zstd_compressor.hpp"
+#include "rosbag2_compression/zstd_decompressor.hpp"
+
+#include "rosbag2_storage/ros_helper.hpp"
+#include "rosbag2_storage/serialized_bag_message.hpp"
+
+namespace
+{
+using Messages = std::vector<std::unique_ptr<rosbag2_storage::SerializedBagMessage>>;
+
+// The compression level used by ZstdCompressor.
+constexpr const int ZSTD_COMPRESSION_LEVEL = 1;
+
+// Payloads drawn from a small alphabet, so that they compress somewhat like typical messages.
+Messages make_messages(size_t message_size, size_t message_count)
+{
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> symbol(0, 15);
+  std::vector<uint8_t> payload(message_size);
+
+  Messages messages;
+  messages.reserve(message_count);
+  for (size_t i = 0; i < message_count; ++i) {
+    for (auto & byte : payload) {
+      byte = static_cast<uint8_t>(symbol(generator));
+    }
+    auto message = std::make_unique<rosbag2_storage::SerializedBagMessage>();
+    message->topic_name = "benchmark";
+    message->serialized_data =
+      rosbag2_storage::make_serialized_message(payload.data(), payload.size());
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
+void throw_on_zstd_error(size_t result)
+{
+  if (ZSTD_isError(result)) {
+    throw std::runtime_error(ZSTD_getErrorName(result));
+  }
+}
+
+// Copies the output into the message buffer, resized to fit it, as the baseline does.
+void copy_into_message(
+  const std::vector<uint8_t> & output, rosbag2_storage::SerializedBagMessage * message)
+{
+  if (rcutils_uint8_array_resize(message->serialized_data.get(), output.size()) !=
+    RCUTILS_RET_OK)
+  {
+    throw std::runtime_error("Could not resize the message buffer");
+  }
+  message->serialized_data->buffer_length = output.size();
+  std::copy(output.begin(), output.end(), message->serialized_data->buffer);
+}
+
+void compress_one_shot(rosbag2_storage::SerializedBagMessage * message)
+{
+  std::vector<uint8_t> compressed_buffer(
+    ZSTD_compressBound(message->serialized_data->buffer_length));
+  const auto compression_result = ZSTD_compress(
+    compressed_buffer.data(), compressed_buffer.size(),
+    message->serialized_data->buffer, message->serialized_data->buffer_length,
+    ZSTD_COMPRESSION_LEVEL);
+  throw_on_zstd_error(compression_result);
+  compressed_buffer.resize(compression_result);
+  copy_into_message(compressed_buffer, message);
+}
+
+void decompress_one_shot(rosbag2_storage::SerializedBagMessage * message)
+{
+  const auto decompressed_buffer_length = ZSTD_getFrameContentSize(
+    message->serialized_data->buffer, message->serialized_data->buffer_length);
+  if (decompressed_buffer_length == ZSTD_CONTENTSIZE_ERROR ||
+    decompressed_buffer_length == ZSTD_CONTENTSIZE_UNKNOWN)
+  {
+    throw std::runtime_error("Invalid zstd frame");
+  }
+  std::vector<uint8_t> decompressed_buffer(decompressed_buffer_length);
+  const auto decompression_result = ZSTD_decompress(
+    decompressed_buffer.data(), decompressed_buffer.size(),
+    message->serialized_data->buffer, message->serialized_data->buffer_length);
+  throw_on_zstd_error(decompression_result);
+  copy_into_message(decompressed_buffer, message);
+}
+
+// Calls process on every message and returns the mean time per message in microseconds.
+template<typename ProcessT>
+double time_per_message(Messages & messages, ProcessT process)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (auto & message : messages) {
+    process(message.get());
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         static_cast<double>(messages.size());
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  const size_t message_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096u;
+  const size_t message_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000u;
+  if (message_size == 0u || message_count == 0u) {
+    std::cerr << "Usage: " << argv[0] << " [message_size_bytes] [message_count]" << std::endl;
+    return 1;
+  }
+
+  auto messages = make_messages(message_size, message_count);
+  // The baseline runs first, while the messages still hold buffers it can resize.
+  const auto compress_one_shot_us = time_per_message(messages, compress_one_shot);
+  const auto decompress_one_shot_us = time_per_message(messages, decompress_one_shot);
+  if (messages.front()->serialized_data->buffer_length != message_size) {
+    std::cerr << "Messages did not survive the round trip" << std::endl;
+    return 1;
+  }
+
+  const auto compress_new = time_per_message(
+    messages, [](rosbag2_storage::SerializedBagMessage * message) {
+      rosbag2_compression::ZstdCompressor().compress_serialized_bag_message(message);
+    });
+  const auto compressed_size = messages.front()->serialized_data->buffer_length;
+  const auto decompress_new = time_per_message(
+    messages, [](rosbag2_storage::SerializedBagMessage * message) {
+      rosbag2_compression::ZstdDecompressor().decompress_serialized_bag_message(message);
+    });
+
+  rosbag2_compression::ZstdCompressor compressor;
+  rosbag2_compression::ZstdDecompressor decompressor;
+  const auto compress_reused = time_per_message(
+    messages, [&compressor](rosbag2_storage::SerializedBagMessage * message) {
+      compressor.compress_serialized_bag_message(message);
+    });
+  const auto decompress_reused = time_per_message(
+    messages, [&decompressor](rosbag2_storage::SerializedBagMessage * message) {
+      decompressor.decompress_serialized_bag_message(message);
+    });
+
+  if (messages.front()->serialized_data->buffer_length != message_size) {
+    std::cerr << "Messages did not survive the round trip" << std::endl;
+    return 1;
+  }
+
+  std::cout << "message_size,message_count,compressed_size," <<
+    "compress_one_shot_us,compress_new_us,compress_reused_us," <<
+    "decompress_one_shot_us,decompress_new_us,decompress_reused_us" << std::endl;
+  std::cout << message_size << "," << message_count << "," << compressed_size << "," <<
+    compress_one_shot_us << "," << compress_new << "," << compress_reused << "," <<
+    decompress_one_shot_us << "," << decompress_new << "," << decompress_reused << std::endl;
+  return 0;
+}
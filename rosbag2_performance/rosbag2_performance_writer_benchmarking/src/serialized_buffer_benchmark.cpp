@@ -0,0 +1,129 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures the cost of allocating the serialized buffers of large messages, e.g. camera images,
+// as they are read from a bag. A loader thread copies each payload into a new serialized message,
+// as the storage does when reading, and hands it to the playback thread, which releases it after
+// a few more messages are queued. In `pooled` mode the messages are made with
+// make_pooled_serialized_message, so their buffers go back to the loader thread and are reused.
+// In `fresh` mode they are made with make_serialized_message, which allocates and frees every
+// buffer.
+//
+// Usage: serialized_buffer_benchmark [pooled|fresh] [payload_size_bytes] [message_count]
+//   [queued_messages]
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rosbag2_storage/ros_helper.hpp"
+#include "rosbag2_storage/serialized_buffer_pool.hpp"
+
+namespace
+{
+using SerializedMessage = std::shared_ptr<rcutils_uint8_array_t>;
+
+// Messages handed from the loader to the playback thread, at most `capacity` at once.
+class MessageQueue
+{
+public:
+  explicit MessageQueue(size_t capacity)
+  : capacity_(capacity)
+  {}
+
+  void push(SerializedMessage message)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] {return messages_.size() < capacity_;});
+    messages_.push_back(std::move(message));
+    condition_.notify_all();
+  }
+
+  SerializedMessage pop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] {return !messages_.empty();});
+    auto message = std::move(messages_.front());
+    messages_.pop_front();
+    condition_.notify_all();
+    return message;
+  }
+
+private:
+  const size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<SerializedMessage> messages_;
+};
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  const std::string mode = argc > 1 ? argv[1] : "pooled";
+  // A 1920x1080 rgb8 image by default.
+  const size_t payload_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1920u * 1080u * 3u;
+  const size_t message_count = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000u;
+  const size_t queued_messages = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 8u;
+  if ((mode != "pooled" && mode != "fresh") || payload_size == 0u || message_count == 0u ||
+    queued_messages == 0u)
+  {
+    std::cerr << "Usage: " << argv[0] <<
+      " [pooled|fresh] [payload_size_bytes] [message_count] [queued_messages]" << std::endl;
+    return 1;
+  }
+  const auto make_message = mode == "pooled" ?
+    rosbag2_storage::make_pooled_serialized_message : rosbag2_storage::make_serialized_message;
+
+  // The payload as the storage hands it over, e.g. a blob read from the database.
+  const std::vector<uint8_t> payload(payload_size, 42);
+  MessageQueue queue(queued_messages);
+  double make_message_us = 0.0;
+  rosbag2_storage::SerializedBufferPoolStatistics statistics{};
+
+  const auto start = std::chrono::steady_clock::now();
+  std::thread loader([&]() {
+      for (size_t i = 0; i < message_count; ++i) {
+        const auto make_start = std::chrono::steady_clock::now();
+        auto message = make_message(payload.data(), payload.size());
+        make_message_us += std::chrono::duration<double, std::micro>(
+          std::chrono::steady_clock::now() - make_start).count();
+        queue.push(std::move(message));
+      }
+      statistics = rosbag2_storage::get_serialized_buffer_pool_statistics();
+    });
+  for (size_t i = 0; i < message_count; ++i) {
+    // The message is released as soon as it was played.
+    queue.pop();
+  }
+  loader.join();
+  const auto wall_us = std::chrono::duration<double, std::micro>(
+    std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "mode,payload_size,message_count,queued_messages," <<
+    "make_message_us,wall_time_per_message_us,reused_buffers,allocated_buffers" << std::endl;
+  std::cout << mode << "," << payload_size << "," << message_count << "," << queued_messages <<
+    "," << make_message_us / static_cast<double>(message_count) << "," <<
+    wall_us / static_cast<double>(message_count) << "," <<
+    statistics.reused_buffers << "," << statistics.allocated_buffers << std::endl;
+  return 0;
+}
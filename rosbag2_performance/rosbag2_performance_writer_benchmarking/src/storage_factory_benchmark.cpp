@@ -0,0 +1,115 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures the latency of opening a storage with a new StorageFactory every time, as tools
+// opening many bags in one process do. In `registry` mode the factory shares the class loaders
+// of the process-wide plugin registry. In `baseline` mode every open constructs its own class
+// loaders first, as each factory did before the registry existed.
+//
+// Usage: storage_factory_benchmark [registry|baseline] [iteration_count] [storage_id]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "pluginlib/class_loader.hpp"
+
+#include "rcpputils/filesystem_helper.hpp"
+
+#include "rosbag2_storage/storage_factory.hpp"
+#include "rosbag2_storage/storage_interfaces/read_only_interface.hpp"
+#include "rosbag2_storage/storage_interfaces/read_write_interface.hpp"
+#include "rosbag2_storage/storage_traits.hpp"
+
+namespace
+{
+using rosbag2_storage::storage_interfaces::ReadOnlyInterface;
+using rosbag2_storage::storage_interfaces::ReadWriteInterface;
+
+template<typename InterfaceT>
+std::unique_ptr<pluginlib::ClassLoader<InterfaceT>> make_class_loader()
+{
+  return std::make_unique<pluginlib::ClassLoader<InterfaceT>>(
+    "rosbag2_storage", rosbag2_storage::StorageTraits<InterfaceT>::name);
+}
+
+bool open_with_registry(const std::string & uri, const std::string & storage_id)
+{
+  return rosbag2_storage::StorageFactory().open_read_write(uri, storage_id) != nullptr;
+}
+
+bool open_with_new_class_loaders(const std::string & uri, const std::string & storage_id)
+{
+  auto read_write_class_loader = make_class_loader<ReadWriteInterface>();
+  auto read_only_class_loader = make_class_loader<ReadOnlyInterface>();
+  // The storage is released before the class loader which loaded its library.
+  std::unique_ptr<ReadWriteInterface> storage(
+    read_write_class_loader->createUnmanagedInstance(storage_id));
+  storage->open(uri, rosbag2_storage::storage_interfaces::IOFlag::READ_WRITE);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  const std::string mode = argc > 1 ? argv[1] : "registry";
+  const size_t iteration_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100u;
+  const std::string storage_id = argc > 3 ? argv[3] : "sqlite3";
+  if ((mode != "registry" && mode != "baseline") || iteration_count == 0u) {
+    std::cerr << "Usage: " << argv[0] << " [registry|baseline] [iteration_count] [storage_id]" <<
+      std::endl;
+    return 1;
+  }
+  const auto open_storage = mode == "registry" ? open_with_registry : open_with_new_class_loaders;
+
+  const auto bag_directory = rcpputils::fs::path("storage_factory_benchmark");
+  rcpputils::fs::remove_all(bag_directory);
+  if (!rcpputils::fs::create_directories(bag_directory)) {
+    std::cerr << "Could not create directory " << bag_directory.string() << std::endl;
+    return 1;
+  }
+
+  // The first open loads the plugin library in both modes; it is reported on its own.
+  double first_open_us = 0.0;
+  double later_open_us = 0.0;
+  for (size_t i = 0; i < iteration_count; ++i) {
+    const auto uri = (bag_directory / ("bag_" + std::to_string(i))).string();
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      if (!open_storage(uri, storage_id)) {
+        throw std::runtime_error("the factory returned no storage");
+      }
+    } catch (const std::exception & e) {
+      std::cerr << "Could not open '" << uri << "' with '" << storage_id << "': " << e.what() <<
+        std::endl;
+      return 1;
+    }
+    const auto latency_us = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start).count();
+    (i == 0 ? first_open_us : later_open_us) += latency_us;
+  }
+  rcpputils::fs::remove_all(bag_directory);
+
+  const double mean_later_open_us =
+    iteration_count > 1 ? later_open_us / static_cast<double>(iteration_count - 1) : 0.0;
+  std::cout << "mode,storage_id,iteration_count,first_open_us,mean_later_open_us" << std::endl;
+  std::cout << mode << "," << storage_id << "," << iteration_count << "," <<
+    first_open_us << "," << mean_later_open_us << std::endl;
+  return 0;
+}
@@ -16,6 +16,7 @@
 #define ROSBAG2_STORAGE__BAG_METADATA_HPP_
 
 #include <chrono>
+#include <map>
 #include <string>
 #include <vector>
 #include <utility>
@@ -29,11 +30,33 @@ struct TopicInformation
 {
   TopicMetadata topic_metadata;
   size_t message_count;
+  // Messages the writer dropped instead of writing, e.g. under backpressure.
+  uint64_t dropped_message_count = 0;
+  uint64_t dropped_bytes = 0;
+  // Statistics of the written messages, see topic_statistics.hpp.
+  // Left at their defaults for bags written before version 8.
+  uint64_t total_bytes = 0;
+  // Time stamps of the earliest and the latest written message.
+  std::chrono::time_point<std::chrono::high_resolution_clock> starting_time{};
+  std::chrono::nanoseconds duration{0};
+  // Number of messages per power-of-two size class of their serialized payload.
+  std::vector<uint64_t> size_histogram{};
+};
+
+// Summary of a single file of the bag.
+struct FileInformation
+{
+  std::string path;
+  std::chrono::time_point<std::chrono::high_resolution_clock> starting_time;
+  std::chrono::nanoseconds duration{0};
+  uint64_t message_count = 0;
+  // Topics without messages in this file are left out.
+  std::map<std::string, uint64_t> topics_message_count;
 };
 
 struct BagMetadata
 {
-  int version = 4;  // upgrade this number when changing the content of the struct
+  int version = 8;  // upgrade this number when changing the content of the struct
   uint64_t bag_size = 0;  // Will not be serialized
   std::string storage_identifier;
   std::vector<std::string> relative_file_paths;
@@ -43,6 +66,11 @@ struct BagMetadata
   std::vector<TopicInformation> topics_with_message_count;
   std::string compression_format;
   std::string compression_mode;
+  // Set once the writer closed all files; finalized bags are not modified anymore.
+  // Metadata written while recording is not finalized: all but the last file are complete.
+  bool finalized = false;
+  // Index-aligned with relative_file_paths; empty for bags written before version 6.
+  std::vector<FileInformation> files;
 };
 
 }  // namespace rosbag2_storage
@@ -0,0 +1,101 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_STORAGE__MESSAGE_BATCH_HPP_
+#define ROSBAG2_STORAGE__MESSAGE_BATCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rcutils/time.h"
+
+#include "rosbag2_storage/serialized_bag_message.hpp"
+#include "rosbag2_storage/visibility_control.hpp"
+
+namespace rosbag2_storage
+{
+
+/**
+ * Messages read in one go. The payloads of all messages are stored back to back in a single
+ * buffer and each message is described by a compact record, so a batch takes a handful of
+ * allocations however many messages it holds, and is released as a unit.
+ *
+ * Iterating the records and payloads does not allocate. get_message offers the messages as
+ * SerializedBagMessage for code written against read_next, at the cost of one message each.
+ */
+class ROSBAG2_STORAGE_PUBLIC MessageBatch : public std::enable_shared_from_this<MessageBatch>
+{
+public:
+  struct Record
+  {
+    // Index of the topic of the message in get_topic_names().
+    uint32_t topic_id;
+    rcutils_time_point_value_t time_stamp;
+    // Position of the payload in get_payloads().
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  // Returns the id of the topic in this batch, adding the topic if it is not in the batch yet.
+  uint32_t add_topic(const std::string & topic_name);
+
+  // Appends a message, copying its payload.
+  void add_message(
+    uint32_t topic_id, rcutils_time_point_value_t time_stamp, const void * data, size_t size);
+  void add_message(const SerializedBagMessage & message);
+
+  void reserve(size_t message_count, uint64_t payload_bytes);
+
+  size_t size() const {return records_.size();}
+  bool empty() const {return records_.empty();}
+
+  // Whether the batch holds max_messages or at least max_payload_bytes of payloads.
+  bool is_full(size_t max_messages, uint64_t max_payload_bytes) const
+  {
+    return records_.size() >= max_messages || payloads_.size() >= max_payload_bytes;
+  }
+
+  const std::vector<Record> & get_records() const {return records_;}
+  const std::vector<std::string> & get_topic_names() const {return topic_names_;}
+  const std::vector<uint8_t> & get_payloads() const {return payloads_;}
+  const uint8_t * get_payload(const Record & record) const
+  {
+    return payloads_.data() + record.offset;
+  }
+
+  /**
+   * View of a message of the batch as SerializedBagMessage. The serialized data points into the
+   * batch and keeps it alive; it must not be resized or written to, and stays valid only as long
+   * as no message is added to the batch.
+   *
+   * The batch must be owned by a shared_ptr.
+   *
+   * \throws std::out_of_range if there is no message with the given index.
+   */
+  std::shared_ptr<SerializedBagMessage> get_message(size_t index) const;
+
+private:
+  std::vector<Record> records_;
+  std::vector<std::string> topic_names_;
+  std::vector<uint8_t> payloads_;
+  // Topic of the last added message, which most likely is the topic of the next one.
+  uint32_t last_topic_id_ = 0;
+};
+
+}  // namespace rosbag2_storage
+
+#endif  // ROSBAG2_STORAGE__MESSAGE_BATCH_HPP_
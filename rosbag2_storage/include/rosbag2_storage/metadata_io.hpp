@@ -30,6 +30,8 @@ public:
 
   virtual ~MetadataIo() = default;
 
+  // Atomically replace the metadata file of the bag at uri.
+  // Throws std::runtime_error if the file cannot be written.
   ROSBAG2_STORAGE_PUBLIC
   virtual void write_metadata(const std::string & uri, const BagMetadata & metadata);
 
@@ -0,0 +1,39 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSBAG2_STORAGE__READ_CACHE_STATISTICS_HPP_
+#define ROSBAG2_STORAGE__READ_CACHE_STATISTICS_HPP_
+
+#include <cstdint>
+
+namespace rosbag2_storage
+{
+
+struct ReadCacheStatistics
+{
+  // Number of random-access reads answered from the cache.
+  uint64_t hits = 0;
+  // Number of random-access reads that had to go to the storage backend.
+  uint64_t misses = 0;
+  // Number of messages and payload bytes currently held by the cache.
+  uint64_t cached_messages = 0;
+  uint64_t cached_bytes = 0;
+  // Upper bound on cached payload bytes. Zero means the cache is disabled.
+  uint64_t max_cache_bytes = 0;
+};
+
+}  // namespace rosbag2_storage
+
+#endif  // ROSBAG2_STORAGE__READ_CACHE_STATISTICS_HPP_
@@ -30,6 +30,13 @@ struct SerializedBagMessage
   rcutils_time_point_value_t time_stamp;
   std::string topic_name;
   int32_t database_index;
+  // Optional application-defined key (e.g. a map vertex id), stored in an indexed
+  // column so the message can be looked up again with read_by_key.
+  bool has_key = false;
+  int64_t key = 0;
+  // Id the storage assigned to the topic, see BaseWriteInterface::get_topic_id.
+  // Spares the storage looking up topic_name when writing; -1 if not known.
+  int32_t topic_id = -1;
 };
 
 }  // namespace rosbag2_storage
@@ -0,0 +1,78 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_STORAGE__SERIALIZED_BUFFER_POOL_HPP_
+#define ROSBAG2_STORAGE__SERIALIZED_BUFFER_POOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rcutils/types/uint8_array.h"
+
+#include "rosbag2_storage/visibility_control.hpp"
+
+namespace rosbag2_storage
+{
+
+/**
+ * Serialized messages made by the functions below recycle their buffers: when the last reference
+ * to a message is dropped, its buffer goes back to a free list of the thread which allocated it
+ * instead of being freed, and is handed out again for a message of the same size class.
+ * Buffers released on another thread, e.g. the playback thread releasing what a loader thread
+ * read, are pushed onto a lock-free list, which the allocating thread takes over once it runs
+ * out of free buffers of a size class.
+ *
+ * Size classes are powers of two from MIN_POOLED_BUFFER_CAPACITY to MAX_POOLED_BUFFER_CAPACITY
+ * bytes. Larger buffers are allocated and freed as usual. Each thread holds on to at most
+ * MAX_FREE_BUFFER_BYTES_PER_THREAD bytes of free buffers. Buffers released after their thread
+ * ended are freed.
+ *
+ * Unlike make_serialized_message, the capacity of a pooled message may exceed its size.
+ * The buffers may be resized with rcutils_uint8_array_resize like any other.
+ */
+constexpr size_t MIN_POOLED_BUFFER_CAPACITY = size_t{1} << 6;
+constexpr size_t MAX_POOLED_BUFFER_CAPACITY = size_t{1} << 24;
+constexpr size_t MAX_FREE_BUFFER_BYTES_PER_THREAD = size_t{1} << 26;
+
+struct SerializedBufferPoolStatistics
+{
+  // Number of buffers handed out from a free list, and allocated because none was free.
+  uint64_t reused_buffers = 0;
+  uint64_t allocated_buffers = 0;
+  // Number and total capacity of the buffers in the free lists.
+  uint64_t free_buffers = 0;
+  uint64_t free_bytes = 0;
+};
+
+ROSBAG2_STORAGE_PUBLIC
+std::shared_ptr<rcutils_uint8_array_t>
+make_pooled_serialized_message(const void * data, size_t size);
+
+// Returns a message with a buffer_length of 0 and a buffer_capacity of at least `size`.
+ROSBAG2_STORAGE_PUBLIC
+std::shared_ptr<rcutils_uint8_array_t>
+make_pooled_empty_serialized_message(size_t size);
+
+// Statistics of the calling thread's buffer pool.
+ROSBAG2_STORAGE_PUBLIC
+SerializedBufferPoolStatistics get_serialized_buffer_pool_statistics();
+
+// Frees the buffers in the calling thread's free lists and resets its statistics.
+ROSBAG2_STORAGE_PUBLIC
+void clear_serialized_buffer_pool();
+
+}  // namespace rosbag2_storage
+
+#endif  // ROSBAG2_STORAGE__SERIALIZED_BUFFER_POOL_HPP_
@@ -54,6 +54,9 @@ public:
   std::shared_ptr<storage_interfaces::ReadWriteInterface>
   open_read_write(const std::string & uri, const std::string & storage_id) override;
 
+  std::shared_ptr<storage_interfaces::ReadOnlyInterface>
+  open_read_only_immutable(const std::string & uri, const std::string & storage_id) override;
+
 private:
   std::unique_ptr<StorageFactoryImpl> impl_;
 };
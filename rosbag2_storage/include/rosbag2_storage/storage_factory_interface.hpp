@@ -35,6 +35,13 @@ public:
 
   virtual std::shared_ptr<storage_interfaces::ReadWriteInterface>
   open_read_write(const std::string & uri, const std::string & storage_id) = 0;
+
+  // Open a finished bagfile which no process writes to anymore.
+  virtual std::shared_ptr<storage_interfaces::ReadOnlyInterface>
+  open_read_only_immutable(const std::string & uri, const std::string & storage_id)
+  {
+    return open_read_only(uri, storage_id);
+  }
 };
 
 }  // namespace rosbag2_storage
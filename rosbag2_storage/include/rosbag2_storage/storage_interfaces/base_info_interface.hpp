@@ -46,6 +46,15 @@ public:
    */
   virtual uint64_t get_bagfile_size() const = 0;
 
+  /**
+   * Returns an estimate of the size of the bagfile which is cheap enough to query on every write.
+   * Storage plugins may keep it up to date as messages are written rather than asking the file
+   * system; calling get_bagfile_size() brings it back in line with the real size.
+   * The default implementation returns the real size.
+   * \returns the estimated size of the bagfile in bytes.
+   */
+  virtual uint64_t get_bagfile_size_estimate() const {return get_bagfile_size();}
+
   /**
    * Returns the identifier for the storage plugin.
    * \returns the identifier.
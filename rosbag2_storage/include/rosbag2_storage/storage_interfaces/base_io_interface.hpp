@@ -28,7 +28,10 @@ enum class IOFlag : uint8_t
 {
   READ_ONLY = 0,
   READ_WRITE = 1,
-  APPEND = 2
+  APPEND = 2,
+  // Read only, with the guarantee that no process modifies the file while it is open.
+  // Storage plugins without a dedicated mode may treat this like READ_ONLY.
+  READ_ONLY_IMMUTABLE = 3
 };
 
 // When bagfile splitting feature is not enabled or applicable,
@@ -39,6 +42,10 @@ ROSBAG2_STORAGE_PUBLIC extern const uint64_t MAX_BAGFILE_SIZE_NO_SPLIT;
 // use 0 as the default maximum bagfile duration value.
 ROSBAG2_STORAGE_PUBLIC extern const uint64_t MAX_BAGFILE_DURATION_NO_SPLIT;
 
+// Number of messages after which writers check the real bagfile size instead of
+// the estimate reported by the storage.
+ROSBAG2_STORAGE_PUBLIC extern const uint64_t BAGFILE_SIZE_RECONCILIATION_INTERVAL;
+
 class ROSBAG2_STORAGE_PUBLIC BaseIOInterface
 {
 public:
@@ -50,6 +57,8 @@ public:
    * \param io_flag is a hint for the type of storage plugin to open depending on the io operations requested.
    * If IOFlag::READ_ONLY is passed, then only read operations are guaranteed.
    * The uri passed should be the exact relative path to the bagfile.
+   * IOFlag::READ_ONLY_IMMUTABLE behaves like IOFlag::READ_ONLY, but allows the plugin to skip
+   * locking as the bagfile is known to be finished.
    * If IOFlag::READ_WRITE is passed, then a new bagfile is created with guaranteed read and write operations.
    * The storage plugin will append the uri in the case of creating a new bagfile backing.
    */
@@ -19,6 +19,8 @@
 #include <string>
 #include <vector>
 
+#include "rosbag2_storage/message_batch.hpp"
+#include "rosbag2_storage/read_cache_statistics.hpp"
 #include "rosbag2_storage/serialized_bag_message.hpp"
 #include "rosbag2_storage/topic_metadata.hpp"
 #include "rosbag2_storage/visibility_control.hpp"
@@ -37,6 +39,16 @@ public:
 
   virtual std::shared_ptr<SerializedBagMessage> read_next() = 0;
 
+  // Append the next messages to the batch, as read_next would return them, until the batch
+  // holds max_messages or at least max_payload_bytes, or there is no next message.
+  virtual void read_next_batch(
+    MessageBatch & batch, size_t max_messages, uint64_t max_payload_bytes)
+  {
+    while (!batch.is_full(max_messages, max_payload_bytes) && has_next()) {
+      batch.add_message(*read_next());
+    }
+  }
+
   virtual std::shared_ptr<SerializedBagMessage>
   read_at_timestamp(rcutils_time_point_value_t timestamp)
   {
@@ -67,6 +79,92 @@ public:
     return nullptr;
   }
 
+  // Read the messages of the given topics stamped within [timestamp_begin, timestamp_end],
+  // ordered by timestamp. An empty list of topics selects all topics.
+  virtual std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_topics_at_timestamp_range(
+    const std::vector<std::string> & topic_names,
+    rcutils_time_point_value_t timestamp_begin,
+    rcutils_time_point_value_t timestamp_end)
+  {
+    // dummy code
+    (void) topic_names;
+    timestamp_begin++;
+    timestamp_end++;
+    return nullptr;
+  }
+
+  // Read the message of the given topic stamped closest to the given timestamp.
+  // On a tie, the earlier message is returned.
+  virtual std::shared_ptr<SerializedBagMessage>
+  read_closest(const std::string & topic_name, rcutils_time_point_value_t timestamp)
+  {
+    // dummy code
+    (void) topic_name;
+    timestamp++;
+    return nullptr;
+  }
+
+  // Restart the sequential reading (has_next / read_next) at the first message stamped at or
+  // after the given timestamp.
+  virtual void seek(rcutils_time_point_value_t timestamp) {timestamp++;}
+
+  // Read the messages with the given ids in a single pass over the storage.
+  // The result has one entry per requested id, in the requested order, and holds
+  // nullptr where no message with that id exists.
+  virtual std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_at_indices(const std::vector<int64_t> & indices)
+  {
+    // dummy code
+    (void) indices;
+    return nullptr;
+  }
+
+  // Timestamp equivalent of read_at_indices. Where several messages share a timestamp,
+  // the one with the lowest id is returned, like read_at_timestamp does.
+  virtual std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_at_timestamps(const std::vector<rcutils_time_point_value_t> & timestamps)
+  {
+    // dummy code
+    (void) timestamps;
+    return nullptr;
+  }
+
+  // Read the message written on the given topic with the given application key.
+  // If several messages share the key, the earliest one is returned.
+  virtual std::shared_ptr<SerializedBagMessage>
+  read_by_key(const std::string & topic_name, int64_t key)
+  {
+    // dummy code
+    (void) topic_name;
+    key++;
+    return nullptr;
+  }
+
+  // Read all messages of the given topic with keys in [key_begin, key_end], ordered by key.
+  virtual std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_by_key_range(const std::string & topic_name, int64_t key_begin, int64_t key_end)
+  {
+    // dummy code
+    (void) topic_name;
+    key_begin++;
+    key_end++;
+    return nullptr;
+  }
+
+  // Read, for each of the given topics, the last message stamped strictly before
+  // the given timestamp. Topics without such a message are left out; the result
+  // is ordered by timestamp.
+  virtual std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_latest_before(
+    const std::vector<std::string> & topic_names, rcutils_time_point_value_t timestamp)
+  {
+    // dummy code
+    (void) topic_names;
+    timestamp++;
+    return nullptr;
+  }
+
   virtual bool seek_by_index(int32_t index) {index++; return false;}
 
   virtual bool seek_by_timestamp(rcutils_time_point_value_t timestamp)
@@ -78,6 +176,22 @@ public:
   virtual std::shared_ptr<rosbag2_storage::SerializedBagMessage>
   modified_read_next() {return nullptr;}
 
+  // Bound (in payload bytes) the cache sitting in front of read_at_index and
+  // read_at_timestamp. A size of zero disables the cache.
+  virtual void set_read_cache_size(uint64_t max_cache_bytes) {max_cache_bytes++;}
+
+  // Load the messages with ids in [index_begin, index_end] into the read cache.
+  // Returns the number of messages that were cached.
+  virtual size_t prefetch_index_range(int32_t index_begin, int32_t index_end)
+  {
+    // dummy code
+    index_begin++;
+    index_end++;
+    return 0;
+  }
+
+  virtual ReadCacheStatistics get_read_cache_statistics() const {return {};}
+
   virtual std::vector<TopicMetadata> get_all_topics_and_types() = 0;
 };
 
@@ -43,6 +43,29 @@ public:
   virtual void remove_topic(const TopicMetadata & topic) = 0;
 
   virtual int32_t get_last_inserted_id() {return 0;}
+
+  // Id the storage assigned to a created topic, for writers to pass along in
+  // SerializedBagMessage::topic_id. Only valid for this storage, until the topic is removed.
+  // Returns -1 if the storage does not identify topics by id.
+  virtual int32_t get_topic_id(const std::string & topic_name)
+  {
+    // dummy code
+    (void) topic_name;
+    return -1;
+  }
+
+  // Write a batch of messages and return the id assigned to each of them, in the same order.
+  virtual std::vector<int32_t> write_and_get_ids(
+    const std::vector<std::shared_ptr<const SerializedBagMessage>> & msgs)
+  {
+    std::vector<int32_t> ids;
+    ids.reserve(msgs.size());
+    for (const auto & msg : msgs) {
+      write(msg);
+      ids.push_back(get_last_inserted_id());
+    }
+    return ids;
+  }
 };
 
 }  // namespace storage_interfaces
@@ -0,0 +1,57 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_STORAGE__TOPIC_STATISTICS_HPP_
+#define ROSBAG2_STORAGE__TOPIC_STATISTICS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rosbag2_storage/bag_metadata.hpp"
+#include "rosbag2_storage/serialized_bag_message.hpp"
+#include "rosbag2_storage/visibility_control.hpp"
+
+namespace rosbag2_storage
+{
+
+/**
+ * Index of the TopicInformation::size_histogram bucket counting messages of the given
+ * serialized size. Bucket 0 counts empty messages, bucket i > 0 sizes in [2^(i-1), 2^i).
+ */
+ROSBAG2_STORAGE_PUBLIC
+size_t get_size_histogram_bucket(uint64_t size);
+
+// Smallest size not counted in the given bucket or any bucket below it.
+ROSBAG2_STORAGE_PUBLIC
+uint64_t get_size_histogram_bucket_limit(size_t bucket);
+
+/**
+ * Account a written message in the statistics of its topic: total_bytes, starting_time,
+ * duration and size_histogram. The message count is maintained by the caller and must already
+ * include the message. The statistics of earlier messages must be complete, which is not the
+ * case for bags before version 8.
+ * Constant time, so writers can call it for every message.
+ */
+ROSBAG2_STORAGE_PUBLIC
+void update_topic_statistics(
+  TopicInformation & topic_information, const SerializedBagMessage & message);
+
+// Messages per second between the earliest and the latest message of the topic.
+// Zero if the topic has less than two messages or no statistics (bags before version 8).
+ROSBAG2_STORAGE_PUBLIC
+double get_message_rate(const TopicInformation & topic_information);
+
+}  // namespace rosbag2_storage
+
+#endif  // ROSBAG2_STORAGE__TOPIC_STATISTICS_HPP_
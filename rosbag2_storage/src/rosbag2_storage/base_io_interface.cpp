@@ -20,5 +20,6 @@ namespace storage_interfaces
 {
 const uint64_t MAX_BAGFILE_SIZE_NO_SPLIT = 0;
 const uint64_t MAX_BAGFILE_DURATION_NO_SPLIT = 0;
+const uint64_t BAGFILE_SIZE_RECONCILIATION_INTERVAL = 1000;
 }
 }
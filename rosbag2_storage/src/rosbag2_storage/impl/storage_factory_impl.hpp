@@ -16,12 +16,8 @@
 #ifndef ROSBAG2_STORAGE__IMPL__STORAGE_FACTORY_IMPL_HPP_
 #define ROSBAG2_STORAGE__IMPL__STORAGE_FACTORY_IMPL_HPP_
 
-#include <algorithm>
 #include <memory>
 #include <string>
-#include <vector>
-
-#include "pluginlib/class_loader.hpp"
 
 #include "rosbag2_storage/storage_interfaces/read_only_interface.hpp"
 #include "rosbag2_storage/storage_interfaces/read_write_interface.hpp"
@@ -30,41 +26,32 @@
 #include "rosbag2_storage/storage_traits.hpp"
 #include "rosbag2_storage/logging.hpp"
 
+#include "./storage_plugin_registry.hpp"
+
 namespace rosbag2_storage
 {
 
 using storage_interfaces::ReadOnlyInterface;
 using storage_interfaces::ReadWriteInterface;
 
-template<typename InterfaceT>
-std::shared_ptr<pluginlib::ClassLoader<InterfaceT>>
-get_class_loader()
-{
-  const char * lookup_name = StorageTraits<InterfaceT>::name;
-  return std::make_shared<pluginlib::ClassLoader<InterfaceT>>("rosbag2_storage", lookup_name);
-}
-
 template<
   typename InterfaceT,
   storage_interfaces::IOFlag flag = StorageTraits<InterfaceT>::io_flag
 >
 std::shared_ptr<InterfaceT>
 get_interface_instance(
-  std::shared_ptr<pluginlib::ClassLoader<InterfaceT>> class_loader,
   const std::string & storage_id,
   const std::string & uri)
 {
-  const auto & registered_classes = class_loader->getDeclaredClasses();
-  auto class_exists = std::find(registered_classes.begin(), registered_classes.end(), storage_id);
-  if (class_exists == registered_classes.end()) {
+  auto & registry = StoragePluginRegistry<InterfaceT>::get_instance();
+  if (!registry.has_storage(storage_id)) {
     ROSBAG2_STORAGE_LOG_DEBUG_STREAM("Requested storage id '" << storage_id << "' does not exist");
     return nullptr;
   }
 
   std::shared_ptr<InterfaceT> instance = nullptr;
   try {
-    auto unmanaged_instance = class_loader->createUnmanagedInstance(storage_id);
-    instance = std::shared_ptr<InterfaceT>(unmanaged_instance);
+    instance = registry.create_instance(storage_id);
   } catch (const std::runtime_error & ex) {
     ROSBAG2_STORAGE_LOG_ERROR_STREAM(
       "Unable to load instance of read write interface: " << ex.what());
@@ -81,32 +68,19 @@ get_interface_instance(
   }
 }
 
+// The class loaders are shared through the process-wide StoragePluginRegistry, so factories are
+// cheap to construct and the plugins are only looked up when the first storage is opened.
 class StorageFactoryImpl
 {
 public:
-  StorageFactoryImpl()
-  {
-    try {
-      read_write_class_loader_ = get_class_loader<ReadWriteInterface>();
-    } catch (const std::exception & e) {
-      ROSBAG2_STORAGE_LOG_ERROR_STREAM("Unable to create class load instance: " << e.what());
-      throw e;
-    }
-
-    try {
-      read_only_class_loader_ = get_class_loader<ReadOnlyInterface>();
-    } catch (const std::exception & e) {
-      ROSBAG2_STORAGE_LOG_ERROR_STREAM("Unable to create class load instance: " << e.what());
-      throw e;
-    }
-  }
+  StorageFactoryImpl() = default;
 
   virtual ~StorageFactoryImpl() = default;
 
   std::shared_ptr<ReadWriteInterface> open_read_write(
     const std::string & uri, const std::string & storage_id)
   {
-    auto instance = get_interface_instance(read_write_class_loader_, storage_id, uri);
+    auto instance = get_interface_instance<ReadWriteInterface>(storage_id, uri);
 
     if (instance == nullptr) {
       ROSBAG2_STORAGE_LOG_ERROR_STREAM(
@@ -118,13 +92,27 @@ public:
 
   std::shared_ptr<ReadOnlyInterface> open_read_only(
     const std::string & uri, const std::string & storage_id)
+  {
+    return open_read_only_with_flag<storage_interfaces::IOFlag::READ_ONLY>(uri, storage_id);
+  }
+
+  std::shared_ptr<ReadOnlyInterface> open_read_only_immutable(
+    const std::string & uri, const std::string & storage_id)
+  {
+    return open_read_only_with_flag<storage_interfaces::IOFlag::READ_ONLY_IMMUTABLE>(
+      uri, storage_id);
+  }
+
+private:
+  template<storage_interfaces::IOFlag flag>
+  std::shared_ptr<ReadOnlyInterface> open_read_only_with_flag(
+    const std::string & uri, const std::string & storage_id)
   {
     // try to load the instance as read_only interface
-    auto instance = get_interface_instance(read_only_class_loader_, storage_id, uri);
+    auto instance = get_interface_instance<ReadOnlyInterface, flag>(storage_id, uri);
     // try to load as read_write if not successful
     if (instance == nullptr) {
-      instance = get_interface_instance<ReadWriteInterface, storage_interfaces::IOFlag::READ_ONLY>(
-        read_write_class_loader_, storage_id, uri);
+      instance = get_interface_instance<ReadWriteInterface, flag>(storage_id, uri);
     }
 
     if (instance == nullptr) {
@@ -134,10 +122,6 @@ public:
 
     return instance;
   }
-
-private:
-  std::shared_ptr<pluginlib::ClassLoader<ReadWriteInterface>> read_write_class_loader_;
-  std::shared_ptr<pluginlib::ClassLoader<ReadOnlyInterface>> read_only_class_loader_;
 };
 
 }  // namespace rosbag2_storage
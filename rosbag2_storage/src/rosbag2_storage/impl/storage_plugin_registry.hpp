@@ -0,0 +1,98 @@
+// Copyright 2018,  Open Source Robotics Foundation, Inc.
+// Copyright 2018,  Bosch Software Innovations GmbH.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSBAG2_STORAGE__IMPL__STORAGE_PLUGIN_REGISTRY_HPP_
+#define ROSBAG2_STORAGE__IMPL__STORAGE_PLUGIN_REGISTRY_HPP_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "pluginlib/class_loader.hpp"
+
+#include "rosbag2_storage/storage_traits.hpp"
+#include "rosbag2_storage/logging.hpp"
+
+namespace rosbag2_storage
+{
+
+/**
+ * Process-wide access to the storage plugins of one interface.
+ *
+ * Constructing a class loader scans the ament resource index and parses all plugin descriptions,
+ * so a single one per interface is created on first use and shared by all storage factories.
+ * The declared storage ids are resolved once along with it.
+ */
+template<typename InterfaceT>
+class StoragePluginRegistry
+{
+public:
+  /**
+   * Return the registry, creating its class loader on the first call.
+   *
+   * \throws std::exception if the class loader cannot be created. Creation is attempted again
+   * on the next call.
+   */
+  static StoragePluginRegistry & get_instance()
+  {
+    // Initialization of function-local statics is thread-safe.
+    static StoragePluginRegistry registry;
+    return registry;
+  }
+
+  bool has_storage(const std::string & storage_id) const
+  {
+    return declared_storage_ids_.find(storage_id) != declared_storage_ids_.end();
+  }
+
+  /**
+   * Instantiate the storage plugin with the given id. The registry outlives the instance, so it
+   * can be used independently of the factory that created it.
+   *
+   * \throws pluginlib::PluginlibException if the plugin cannot be loaded.
+   */
+  std::shared_ptr<InterfaceT> create_instance(const std::string & storage_id)
+  {
+    // pluginlib class loaders are not safe to load libraries from several threads at once.
+    std::lock_guard<std::mutex> lock(class_loader_mutex_);
+    return std::shared_ptr<InterfaceT>(class_loader_->createUnmanagedInstance(storage_id));
+  }
+
+private:
+  StoragePluginRegistry()
+  {
+    const char * lookup_name = StorageTraits<InterfaceT>::name;
+    try {
+      class_loader_ = std::make_unique<pluginlib::ClassLoader<InterfaceT>>(
+        "rosbag2_storage", lookup_name);
+    } catch (const std::exception & e) {
+      ROSBAG2_STORAGE_LOG_ERROR_STREAM("Unable to create class load instance: " << e.what());
+      throw;
+    }
+
+    for (const auto & storage_id : class_loader_->getDeclaredClasses()) {
+      declared_storage_ids_.insert(storage_id);
+    }
+  }
+
+  std::mutex class_loader_mutex_;
+  std::unique_ptr<pluginlib::ClassLoader<InterfaceT>> class_loader_;
+  std::unordered_set<std::string> declared_storage_ids_;
+};
+
+}  // namespace rosbag2_storage
+
+#endif  // ROSBAG2_STORAGE__IMPL__STORAGE_PLUGIN_REGISTRY_HPP_
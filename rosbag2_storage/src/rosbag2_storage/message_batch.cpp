@@ -0,0 +1,89 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rosbag2_storage/message_batch.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rosbag2_storage
+{
+
+uint32_t MessageBatch::add_topic(const std::string & topic_name)
+{
+  if (last_topic_id_ < topic_names_.size() && topic_names_[last_topic_id_] == topic_name) {
+    return last_topic_id_;
+  }
+  uint32_t topic_id = 0;
+  while (topic_id < topic_names_.size() && topic_names_[topic_id] != topic_name) {
+    ++topic_id;
+  }
+  if (topic_id == topic_names_.size()) {
+    topic_names_.push_back(topic_name);
+  }
+  last_topic_id_ = topic_id;
+  return topic_id;
+}
+
+void MessageBatch::add_message(
+  uint32_t topic_id, rcutils_time_point_value_t time_stamp, const void * data, size_t size)
+{
+  if (topic_id >= topic_names_.size()) {
+    throw std::out_of_range("Topic " + std::to_string(topic_id) + " is not in the batch.");
+  }
+  const auto offset = payloads_.size();
+  const auto bytes = static_cast<const uint8_t *>(data);
+  payloads_.insert(payloads_.end(), bytes, bytes + size);
+  records_.push_back({topic_id, time_stamp, offset, size});
+}
+
+void MessageBatch::add_message(const SerializedBagMessage & message)
+{
+  const auto & data = message.serialized_data;
+  add_message(
+    add_topic(message.topic_name), message.time_stamp,
+    data ? data->buffer : nullptr, data ? data->buffer_length : 0u);
+}
+
+void MessageBatch::reserve(size_t message_count, uint64_t payload_bytes)
+{
+  records_.reserve(message_count);
+  payloads_.reserve(payload_bytes);
+}
+
+std::shared_ptr<SerializedBagMessage> MessageBatch::get_message(size_t index) const
+{
+  const auto & record = records_.at(index);
+  auto batch = shared_from_this();
+
+  auto message = std::make_shared<SerializedBagMessage>();
+  auto serialized_data = new rcutils_uint8_array_t;
+  *serialized_data = rcutils_get_zero_initialized_uint8_array();
+  // The payload is owned by the batch, so the deleter only keeps the batch alive.
+  message->serialized_data = std::shared_ptr<rcutils_uint8_array_t>(
+    serialized_data,
+    [batch](rcutils_uint8_array_t * data) {
+      delete data;
+    });
+  serialized_data->buffer = const_cast<uint8_t *>(get_payload(record));
+  serialized_data->buffer_length = record.length;
+  serialized_data->buffer_capacity = record.length;
+  message->time_stamp = record.time_stamp;
+  message->topic_name = topic_names_[record.topic_id];
+  return message;
+}
+
+}  // namespace rosbag2_storage
@@ -14,10 +14,20 @@
 
 #include "rosbag2_storage/metadata_io.hpp"
 
-#include <fstream>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "rcpputils/filesystem_helper.hpp"
 
 #include "rcutils/filesystem.h"
@@ -88,6 +98,42 @@ struct convert<rosbag2_storage::TopicMetadata>
   }
 };
 
+template<>
+struct convert<std::chrono::nanoseconds>
+{
+  static Node encode(const std::chrono::nanoseconds & time_in_ns)
+  {
+    Node node;
+    node["nanoseconds"] = time_in_ns.count();
+    return node;
+  }
+
+  static bool decode(const Node & node, std::chrono::nanoseconds & time_in_ns)
+  {
+    time_in_ns = std::chrono::nanoseconds(node["nanoseconds"].as<uint64_t>());
+    return true;
+  }
+};
+
+template<>
+struct convert<std::chrono::time_point<std::chrono::high_resolution_clock>>
+{
+  static Node encode(const std::chrono::time_point<std::chrono::high_resolution_clock> & start_time)
+  {
+    Node node;
+    node["nanoseconds_since_epoch"] = start_time.time_since_epoch().count();
+    return node;
+  }
+
+  static bool decode(
+    const Node & node, std::chrono::time_point<std::chrono::high_resolution_clock> & start_time)
+  {
+    start_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+      std::chrono::nanoseconds(node["nanoseconds_since_epoch"].as<uint64_t>()));
+    return true;
+  }
+};
+
 template<>
 struct convert<rosbag2_storage::TopicInformation>
 {
@@ -96,6 +142,12 @@ struct convert<rosbag2_storage::TopicInformation>
     Node node;
     node["topic_metadata"] = metadata.topic_metadata;
     node["message_count"] = metadata.message_count;
+    node["dropped_message_count"] = metadata.dropped_message_count;
+    node["dropped_bytes"] = metadata.dropped_bytes;
+    node["total_bytes"] = metadata.total_bytes;
+    node["starting_time"] = metadata.starting_time;
+    node["duration"] = metadata.duration;
+    node["size_histogram"] = metadata.size_histogram;
     return node;
   }
 
@@ -104,6 +156,17 @@ struct convert<rosbag2_storage::TopicInformation>
     metadata.topic_metadata = decode_for_version<rosbag2_storage::TopicMetadata>(
       node["topic_metadata"], version);
     metadata.message_count = node["message_count"].as<uint64_t>();
+    if (version >= 7) {
+      metadata.dropped_message_count = node["dropped_message_count"].as<uint64_t>();
+      metadata.dropped_bytes = node["dropped_bytes"].as<uint64_t>();
+    }
+    if (version >= 8) {
+      metadata.total_bytes = node["total_bytes"].as<uint64_t>();
+      metadata.starting_time = node["starting_time"]
+        .as<std::chrono::time_point<std::chrono::high_resolution_clock>>();
+      metadata.duration = node["duration"].as<std::chrono::nanoseconds>();
+      metadata.size_histogram = node["size_histogram"].as<std::vector<uint64_t>>();
+    }
     return true;
   }
 };
@@ -136,37 +199,28 @@ struct convert<std::vector<rosbag2_storage::TopicInformation>>
 };
 
 template<>
-struct convert<std::chrono::nanoseconds>
+struct convert<rosbag2_storage::FileInformation>
 {
-  static Node encode(const std::chrono::nanoseconds & time_in_ns)
+  static Node encode(const rosbag2_storage::FileInformation & file_information)
   {
     Node node;
-    node["nanoseconds"] = time_in_ns.count();
-    return node;
-  }
-
-  static bool decode(const Node & node, std::chrono::nanoseconds & time_in_ns)
-  {
-    time_in_ns = std::chrono::nanoseconds(node["nanoseconds"].as<uint64_t>());
-    return true;
-  }
-};
-
-template<>
-struct convert<std::chrono::time_point<std::chrono::high_resolution_clock>>
-{
-  static Node encode(const std::chrono::time_point<std::chrono::high_resolution_clock> & start_time)
-  {
-    Node node;
-    node["nanoseconds_since_epoch"] = start_time.time_since_epoch().count();
+    node["path"] = file_information.path;
+    node["starting_time"] = file_information.starting_time;
+    node["duration"] = file_information.duration;
+    node["message_count"] = file_information.message_count;
+    node["topics_message_count"] = file_information.topics_message_count;
     return node;
   }
 
-  static bool decode(
-    const Node & node, std::chrono::time_point<std::chrono::high_resolution_clock> & start_time)
+  static bool decode(const Node & node, rosbag2_storage::FileInformation & file_information)
   {
-    start_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
-      std::chrono::nanoseconds(node["nanoseconds_since_epoch"].as<uint64_t>()));
+    file_information.path = node["path"].as<std::string>();
+    file_information.starting_time = node["starting_time"]
+      .as<std::chrono::time_point<std::chrono::high_resolution_clock>>();
+    file_information.duration = node["duration"].as<std::chrono::nanoseconds>();
+    file_information.message_count = node["message_count"].as<uint64_t>();
+    file_information.topics_message_count =
+      node["topics_message_count"].as<std::map<std::string, uint64_t>>();
     return true;
   }
 };
@@ -189,6 +243,14 @@ struct convert<rosbag2_storage::BagMetadata>
       node["compression_format"] = metadata.compression_format;
       node["compression_mode"] = metadata.compression_mode;
     }
+
+    if (metadata.version >= 5) {
+      node["finalized"] = metadata.finalized;
+    }
+
+    if (metadata.version >= 6) {
+      node["files"] = metadata.files;
+    }
     return node;
   }
 
@@ -209,6 +271,14 @@ struct convert<rosbag2_storage::BagMetadata>
       metadata.compression_format = node["compression_format"].as<std::string>();
       metadata.compression_mode = node["compression_mode"].as<std::string>();
     }
+
+    if (metadata.version >= 5) {
+      metadata.finalized = node["finalized"].as<bool>();
+    }
+
+    if (metadata.version >= 6) {
+      metadata.files = node["files"].as<std::vector<rosbag2_storage::FileInformation>>();
+    }
     return true;
   }
 };
@@ -222,8 +292,53 @@ void MetadataIo::write_metadata(const std::string & uri, const BagMetadata & met
 {
   YAML::Node metadata_node;
   metadata_node["rosbag2_bagfile_information"] = metadata;
-  std::ofstream fout(get_metadata_file_name(uri));
-  fout << metadata_node;
+  std::stringstream content;
+  content << metadata_node;
+  const auto serialized = content.str();
+
+  // The metadata is written to a temporary file which then replaces the metadata file, so that
+  // a crash while writing leaves either the previous or the new metadata behind.
+  const auto metadata_file = get_metadata_file_name(uri);
+  const auto temporary_file = metadata_file + ".tmp";
+  auto file = std::fopen(temporary_file.c_str(), "wb");
+  if (file == nullptr) {
+    throw std::runtime_error("Failed to open metadata file " + temporary_file + " for writing.");
+  }
+  bool written = std::fwrite(serialized.data(), 1, serialized.size(), file) == serialized.size();
+  written = std::fflush(file) == 0 && written;
+#ifdef _WIN32
+  written = _commit(_fileno(file)) == 0 && written;
+#else
+  written = fsync(fileno(file)) == 0 && written;
+#endif
+  written = std::fclose(file) == 0 && written;
+  if (!written) {
+    std::remove(temporary_file.c_str());
+    throw std::runtime_error("Failed to write metadata file " + temporary_file + ".");
+  }
+
+#ifdef _WIN32
+  // Renaming does not replace an existing file on Windows.
+  std::remove(metadata_file.c_str());
+#endif
+  if (std::rename(temporary_file.c_str(), metadata_file.c_str()) != 0) {
+    throw std::runtime_error("Failed to move metadata file " + temporary_file + " in place.");
+  }
+#ifndef _WIN32
+  // The rename only survives a crash once the directory holding the file is synced as well.
+  auto directory = rcpputils::fs::path(metadata_file).parent_path().string();
+  if (directory.empty()) {
+    directory = ".";
+  }
+  const auto directory_fd = open(directory.c_str(), O_RDONLY);
+  if (directory_fd < 0 || fsync(directory_fd) != 0) {
+    if (directory_fd >= 0) {
+      close(directory_fd);
+    }
+    throw std::runtime_error("Failed to sync directory " + directory + " of the metadata file.");
+  }
+  close(directory_fd);
+#endif
 }
 
 BagMetadata MetadataIo::read_metadata(const std::string & uri)
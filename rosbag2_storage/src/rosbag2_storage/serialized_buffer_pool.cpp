@@ -0,0 +1,295 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rosbag2_storage/serialized_buffer_pool.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcutils/types.h"
+#include "rosbag2_storage/logging.hpp"
+
+namespace rosbag2_storage
+{
+
+namespace
+{
+
+constexpr size_t MIN_SIZE_CLASS = 6;
+constexpr size_t MAX_SIZE_CLASS = 24;
+constexpr size_t SIZE_CLASS_COUNT = MAX_SIZE_CLASS - MIN_SIZE_CLASS + 1;
+static_assert(
+  MIN_POOLED_BUFFER_CAPACITY == size_t{1} << MIN_SIZE_CLASS &&
+  MAX_POOLED_BUFFER_CAPACITY == size_t{1} << MAX_SIZE_CLASS,
+  "size classes must span the pooled buffer capacities");
+
+rcutils_allocator_t allocator = rcutils_get_default_allocator();
+
+void free_buffer(rcutils_uint8_array_t * buffer)
+{
+  const auto error = rcutils_uint8_array_fini(buffer);
+  delete buffer;
+  if (error != RCUTILS_RET_OK) {
+    ROSBAG2_STORAGE_LOG_ERROR_STREAM("Leaking memory. Error: " << rcutils_get_error_string().str);
+  }
+}
+
+// Buffers released on other threads are pushed onto a stack linked through the buffers
+// themselves: a pooled buffer holds at least MIN_POOLED_BUFFER_CAPACITY bytes, so its first
+// bytes can point to the next buffer.
+rcutils_uint8_array_t * get_next_returned_buffer(const rcutils_uint8_array_t * buffer)
+{
+  rcutils_uint8_array_t * next;
+  std::memcpy(&next, buffer->buffer, sizeof(next));
+  return next;
+}
+
+void set_next_returned_buffer(rcutils_uint8_array_t * buffer, rcutils_uint8_array_t * next)
+{
+  std::memcpy(buffer->buffer, &next, sizeof(next));
+}
+
+// The pool of a thread. Only that thread touches the free lists and statistics; other threads
+// only push onto `returned_buffers`. The buffers handed out keep the pool alive, so it outlives
+// its thread until they are all released.
+struct BufferPool
+{
+  BufferPool() = default;
+  BufferPool(const BufferPool &) = delete;
+  BufferPool & operator=(const BufferPool &) = delete;
+  ~BufferPool();
+
+  void clear();
+
+  // Puts a buffer of the pool on its free list, unless the pool holds enough free buffers.
+  void add_free_buffer(rcutils_uint8_array_t * buffer);
+
+  // Moves the buffers released on other threads to the free lists.
+  void take_returned_buffers();
+
+  // Free buffers by size class. A buffer is in the largest class its capacity covers.
+  std::array<std::vector<rcutils_uint8_array_t *>, SIZE_CLASS_COUNT> buffers;
+  SerializedBufferPoolStatistics statistics;
+  std::atomic<rcutils_uint8_array_t *> returned_buffers{nullptr};
+  // Set once the thread of the pool is gone. Buffers released later are freed right away.
+  std::atomic_bool retired{false};
+};
+
+// Returns a buffer to the pool of the thread which allocated it.
+class BufferReleaser
+{
+public:
+  explicit BufferReleaser(std::shared_ptr<BufferPool> pool)
+  : pool_(std::move(pool))
+  {}
+
+  void operator()(rcutils_uint8_array_t * buffer) const;
+
+private:
+  std::shared_ptr<BufferPool> pool_;
+};
+
+// Pool of the calling thread; null before it has one and once its pool is destroyed.
+thread_local BufferPool * current_thread_pool = nullptr;
+
+struct ThreadBufferPool
+{
+  ThreadBufferPool()
+  : pool(std::make_shared<BufferPool>())
+  {
+    current_thread_pool = pool.get();
+  }
+
+  ~ThreadBufferPool()
+  {
+    current_thread_pool = nullptr;
+    pool->retired = true;
+    pool->clear();
+  }
+
+  std::shared_ptr<BufferPool> pool;
+};
+
+const std::shared_ptr<BufferPool> & get_thread_pool()
+{
+  thread_local ThreadBufferPool thread_pool;
+  return thread_pool.pool;
+}
+
+BufferPool::~BufferPool()
+{
+  clear();
+  for (auto buffer = returned_buffers.exchange(nullptr); buffer != nullptr; ) {
+    const auto next = get_next_returned_buffer(buffer);
+    free_buffer(buffer);
+    buffer = next;
+  }
+}
+
+void BufferPool::clear()
+{
+  for (auto & size_class_buffers : buffers) {
+    for (auto buffer : size_class_buffers) {
+      free_buffer(buffer);
+    }
+    size_class_buffers.clear();
+  }
+  statistics = SerializedBufferPoolStatistics{};
+}
+
+// Largest size class the given capacity covers.
+size_t get_size_class_at_most(size_t capacity)
+{
+  size_t size_class = 0;
+  while (capacity >> (size_class + 1)) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+void BufferPool::add_free_buffer(rcutils_uint8_array_t * buffer)
+{
+  const auto capacity = buffer->buffer_capacity;
+  if (statistics.free_bytes + capacity > MAX_FREE_BUFFER_BYTES_PER_THREAD) {
+    free_buffer(buffer);
+    return;
+  }
+  buffer->buffer_length = 0;
+  buffers[get_size_class_at_most(capacity) - MIN_SIZE_CLASS].push_back(buffer);
+  ++statistics.free_buffers;
+  statistics.free_bytes += capacity;
+}
+
+void BufferPool::take_returned_buffers()
+{
+  auto buffer = returned_buffers.exchange(nullptr, std::memory_order_acquire);
+  while (buffer != nullptr) {
+    const auto next = get_next_returned_buffer(buffer);
+    add_free_buffer(buffer);
+    buffer = next;
+  }
+}
+
+void BufferReleaser::operator()(rcutils_uint8_array_t * buffer) const
+{
+  const auto capacity = buffer->buffer_capacity;
+  if (buffer->buffer == nullptr ||
+    capacity < MIN_POOLED_BUFFER_CAPACITY || capacity >= 2 * MAX_POOLED_BUFFER_CAPACITY)
+  {
+    free_buffer(buffer);
+    return;
+  }
+
+  if (current_thread_pool == pool_.get()) {
+    pool_->add_free_buffer(buffer);
+    return;
+  }
+  // Buffers pushed while the pool retires are freed with the pool.
+  if (pool_->retired) {
+    free_buffer(buffer);
+    return;
+  }
+  auto head = pool_->returned_buffers.load(std::memory_order_relaxed);
+  do {
+    set_next_returned_buffer(buffer, head);
+  } while (!pool_->returned_buffers.compare_exchange_weak(
+    head, buffer, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Smallest size class holding buffers of at least the given capacity.
+size_t get_size_class_at_least(size_t capacity)
+{
+  size_t size_class = MIN_SIZE_CLASS;
+  while ((size_t{1} << size_class) < capacity) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+rcutils_uint8_array_t * allocate_buffer(size_t capacity)
+{
+  auto buffer = new rcutils_uint8_array_t;
+  *buffer = rcutils_get_zero_initialized_uint8_array();
+  auto ret = rcutils_uint8_array_init(buffer, capacity, &allocator);
+  if (ret != RCUTILS_RET_OK) {
+    delete buffer;
+    throw std::runtime_error(
+            "Error allocating resources for serialized message: " +
+            std::string(rcutils_get_error_string().str));
+  }
+  return buffer;
+}
+
+}  // namespace
+
+std::shared_ptr<rcutils_uint8_array_t>
+make_pooled_serialized_message(const void * data, size_t size)
+{
+  auto serialized_message = make_pooled_empty_serialized_message(size);
+  if (size > 0) {
+    memcpy(serialized_message->buffer, data, size);
+  }
+  serialized_message->buffer_length = size;
+
+  return serialized_message;
+}
+
+std::shared_ptr<rcutils_uint8_array_t>
+make_pooled_empty_serialized_message(size_t size)
+{
+  if (size > MAX_POOLED_BUFFER_CAPACITY) {
+    return std::shared_ptr<rcutils_uint8_array_t>(allocate_buffer(size), free_buffer);
+  }
+
+  const auto & pool = get_thread_pool();
+  const auto size_class = get_size_class_at_least(size);
+  auto & size_class_buffers = pool->buffers[size_class - MIN_SIZE_CLASS];
+  if (size_class_buffers.empty()) {
+    pool->take_returned_buffers();
+  }
+  rcutils_uint8_array_t * buffer;
+  if (size_class_buffers.empty()) {
+    buffer = allocate_buffer(size_t{1} << size_class);
+    ++pool->statistics.allocated_buffers;
+  } else {
+    buffer = size_class_buffers.back();
+    size_class_buffers.pop_back();
+    ++pool->statistics.reused_buffers;
+    --pool->statistics.free_buffers;
+    pool->statistics.free_bytes -= buffer->buffer_capacity;
+  }
+  return std::shared_ptr<rcutils_uint8_array_t>(buffer, BufferReleaser(pool));
+}
+
+SerializedBufferPoolStatistics get_serialized_buffer_pool_statistics()
+{
+  const auto & pool = get_thread_pool();
+  pool->take_returned_buffers();
+  return pool->statistics;
+}
+
+void clear_serialized_buffer_pool()
+{
+  const auto & pool = get_thread_pool();
+  pool->take_returned_buffers();
+  pool->clear();
+}
+
+}  // namespace rosbag2_storage
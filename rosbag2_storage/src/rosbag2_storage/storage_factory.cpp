@@ -47,4 +47,10 @@ std::shared_ptr<ReadWriteInterface> StorageFactory::open_read_write(
 {
   return impl_->open_read_write(uri, storage_id);
 }
+
+std::shared_ptr<ReadOnlyInterface> StorageFactory::open_read_only_immutable(
+  const std::string & uri, const std::string & storage_id)
+{
+  return impl_->open_read_only_immutable(uri, storage_id);
+}
 }  // namespace rosbag2_storage
@@ -0,0 +1,80 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rosbag2_storage/topic_statistics.hpp"
+
+#include <chrono>
+#include <limits>
+
+namespace rosbag2_storage
+{
+
+size_t get_size_histogram_bucket(uint64_t size)
+{
+  size_t bucket = 0;
+  while (size > 0) {
+    size >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+uint64_t get_size_histogram_bucket_limit(size_t bucket)
+{
+  if (bucket >= static_cast<size_t>(std::numeric_limits<uint64_t>::digits)) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return uint64_t{1} << bucket;
+}
+
+void update_topic_statistics(
+  TopicInformation & topic_information, const SerializedBagMessage & message)
+{
+  const uint64_t size =
+    message.serialized_data ? message.serialized_data->buffer_length : 0u;
+  const auto time_stamp = std::chrono::time_point<std::chrono::high_resolution_clock>(
+    std::chrono::nanoseconds(message.time_stamp));
+
+  // The caller counts the message first. The histogram cannot mark the first message, since
+  // reindexed bags have topics with messages but without a histogram.
+  if (topic_information.message_count <= 1) {
+    topic_information.starting_time = time_stamp;
+    topic_information.duration = std::chrono::nanoseconds(0);
+  } else if (time_stamp < topic_information.starting_time) {
+    topic_information.duration += topic_information.starting_time - time_stamp;
+    topic_information.starting_time = time_stamp;
+  } else if (time_stamp - topic_information.starting_time > topic_information.duration) {
+    topic_information.duration = time_stamp - topic_information.starting_time;
+  }
+
+  topic_information.total_bytes += size;
+
+  const auto bucket = get_size_histogram_bucket(size);
+  if (topic_information.size_histogram.size() <= bucket) {
+    topic_information.size_histogram.resize(bucket + 1, 0);
+  }
+  ++topic_information.size_histogram[bucket];
+}
+
+double get_message_rate(const TopicInformation & topic_information)
+{
+  if (topic_information.message_count < 2 || topic_information.duration.count() <= 0) {
+    return 0.0;
+  }
+  const auto duration_in_seconds =
+    std::chrono::duration_cast<std::chrono::duration<double>>(topic_information.duration);
+  return static_cast<double>(topic_information.message_count - 1) / duration_in_seconds.count();
+}
+
+}  // namespace rosbag2_storage
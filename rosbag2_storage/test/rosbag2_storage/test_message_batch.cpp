@@ -0,0 +1,96 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rosbag2_storage/message_batch.hpp"
+#include "rosbag2_storage/ros_helper.hpp"
+
+using namespace ::testing;  // NOLINT
+using rosbag2_storage::MessageBatch;
+
+TEST(MessageBatchTest, topics_are_added_once) {
+  MessageBatch batch;
+  EXPECT_THAT(batch.add_topic("a"), Eq(0u));
+  EXPECT_THAT(batch.add_topic("b"), Eq(1u));
+  EXPECT_THAT(batch.add_topic("a"), Eq(0u));
+  EXPECT_THAT(batch.get_topic_names(), ElementsAre("a", "b"));
+}
+
+TEST(MessageBatchTest, payloads_are_stored_back_to_back) {
+  MessageBatch batch;
+  const std::string first = "first";
+  const std::string second = "second payload";
+  batch.add_message(batch.add_topic("a"), 1, first.data(), first.size());
+  batch.add_message(batch.add_topic("b"), 2, second.data(), second.size());
+
+  ASSERT_THAT(batch.size(), Eq(2u));
+  const auto & records = batch.get_records();
+  EXPECT_THAT(records[0].topic_id, Eq(0u));
+  EXPECT_THAT(records[0].time_stamp, Eq(1));
+  EXPECT_THAT(records[0].offset, Eq(0u));
+  EXPECT_THAT(records[0].length, Eq(first.size()));
+  EXPECT_THAT(records[1].topic_id, Eq(1u));
+  EXPECT_THAT(records[1].offset, Eq(first.size()));
+  EXPECT_THAT(batch.get_payloads(), SizeIs(first.size() + second.size()));
+  EXPECT_THAT(
+    std::string(
+      reinterpret_cast<const char *>(batch.get_payload(records[1])), records[1].length),
+    Eq(second));
+
+  EXPECT_THROW(batch.add_message(2, 3, first.data(), first.size()), std::out_of_range);
+}
+
+TEST(MessageBatchTest, is_full_by_message_count_or_payload_bytes) {
+  MessageBatch batch;
+  const std::vector<uint8_t> payload(10);
+  batch.add_message(batch.add_topic("a"), 1, payload.data(), payload.size());
+
+  EXPECT_FALSE(batch.is_full(2, 11));
+  EXPECT_TRUE(batch.is_full(1, 11));
+  EXPECT_TRUE(batch.is_full(2, 10));
+}
+
+TEST(MessageBatchTest, messages_are_viewed_as_serialized_bag_messages) {
+  auto batch = std::make_shared<MessageBatch>();
+  rosbag2_storage::SerializedBagMessage message;
+  const std::string payload = "payload";
+  message.serialized_data = rosbag2_storage::make_serialized_message(
+    payload.data(), payload.size());
+  message.topic_name = "topic";
+  message.time_stamp = 42;
+  batch->add_message(message);
+
+  auto view = batch->get_message(0);
+  std::weak_ptr<MessageBatch> weak_batch = batch;
+  batch.reset();
+
+  // The view keeps the batch alive.
+  EXPECT_FALSE(weak_batch.expired());
+  EXPECT_THAT(view->topic_name, Eq("topic"));
+  EXPECT_THAT(view->time_stamp, Eq(42));
+  ASSERT_THAT(view->serialized_data->buffer_length, Eq(payload.size()));
+  EXPECT_THAT(
+    std::string(
+      reinterpret_cast<const char *>(view->serialized_data->buffer),
+      view->serialized_data->buffer_length),
+    Eq(payload));
+
+  view.reset();
+  EXPECT_TRUE(weak_batch.expired());
+}
@@ -132,3 +132,110 @@ TEST_F(MetadataFixture, metadata_reads_v4_fills_offered_qos_profiles)
   auto actual_first_topic = read_metadata.topics_with_message_count[0];
   EXPECT_THAT(actual_first_topic.topic_metadata.offered_qos_profiles, Eq(offered_qos_profiles));
 }
+
+TEST_F(MetadataFixture, metadata_reads_v5_finalized_flag)
+{
+  BagMetadata metadata{};
+  metadata.finalized = true;
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  EXPECT_TRUE(metadata_io_->read_metadata(temporary_dir_path_).finalized);
+
+  metadata.version = 4;
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  EXPECT_FALSE(metadata_io_->read_metadata(temporary_dir_path_).finalized);
+}
+
+TEST_F(MetadataFixture, metadata_reads_v6_file_summaries)
+{
+  FileInformation file_information{};
+  file_information.path = "some_relative_path";
+  file_information.starting_time = std::chrono::time_point<std::chrono::high_resolution_clock>(
+    std::chrono::nanoseconds(1000000));
+  file_information.duration = std::chrono::nanoseconds(500);
+  file_information.message_count = 3;
+  file_information.topics_message_count = {{"topic1", 2}, {"topic2", 1}};
+
+  BagMetadata metadata{};
+  metadata.relative_file_paths = {file_information.path};
+  metadata.files = {file_information};
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  auto read_metadata = metadata_io_->read_metadata(temporary_dir_path_);
+  ASSERT_THAT(read_metadata.files, SizeIs(1));
+  const auto & read_file = read_metadata.files[0];
+  EXPECT_THAT(read_file.path, Eq(file_information.path));
+  EXPECT_THAT(read_file.starting_time, Eq(file_information.starting_time));
+  EXPECT_THAT(read_file.duration, Eq(file_information.duration));
+  EXPECT_THAT(read_file.message_count, Eq(file_information.message_count));
+  EXPECT_THAT(read_file.topics_message_count, Eq(file_information.topics_message_count));
+
+  metadata.version = 5;
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  EXPECT_THAT(metadata_io_->read_metadata(temporary_dir_path_).files, IsEmpty());
+}
+
+TEST_F(MetadataFixture, metadata_reads_v7_dropped_messages)
+{
+  TopicInformation topic_information{{"topic", "type", "rmw", ""}, 10};
+  topic_information.dropped_message_count = 3;
+  topic_information.dropped_bytes = 300;
+
+  BagMetadata metadata{};
+  metadata.topics_with_message_count = {topic_information};
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  auto read_topics = metadata_io_->read_metadata(temporary_dir_path_).topics_with_message_count;
+  ASSERT_THAT(read_topics, SizeIs(1));
+  EXPECT_THAT(read_topics[0].message_count, Eq(10u));
+  EXPECT_THAT(read_topics[0].dropped_message_count, Eq(3u));
+  EXPECT_THAT(read_topics[0].dropped_bytes, Eq(300u));
+
+  metadata.version = 6;
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  read_topics = metadata_io_->read_metadata(temporary_dir_path_).topics_with_message_count;
+  ASSERT_THAT(read_topics, SizeIs(1));
+  EXPECT_THAT(read_topics[0].dropped_message_count, Eq(0u));
+}
+
+TEST_F(MetadataFixture, metadata_reads_v8_topic_statistics)
+{
+  TopicInformation topic_information{{"topic", "type", "rmw", ""}, 3};
+  topic_information.total_bytes = 1200;
+  topic_information.starting_time =
+    std::chrono::time_point<std::chrono::high_resolution_clock>(std::chrono::seconds(5));
+  topic_information.duration = std::chrono::seconds(2);
+  topic_information.size_histogram = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2};
+
+  BagMetadata metadata{};
+  metadata.topics_with_message_count = {topic_information};
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  auto read_topics = metadata_io_->read_metadata(temporary_dir_path_).topics_with_message_count;
+  ASSERT_THAT(read_topics, SizeIs(1));
+  EXPECT_THAT(read_topics[0].total_bytes, Eq(1200u));
+  EXPECT_THAT(read_topics[0].starting_time, Eq(topic_information.starting_time));
+  EXPECT_THAT(read_topics[0].duration, Eq(topic_information.duration));
+  EXPECT_THAT(read_topics[0].size_histogram, ContainerEq(topic_information.size_histogram));
+
+  metadata.version = 7;
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+  read_topics = metadata_io_->read_metadata(temporary_dir_path_).topics_with_message_count;
+  ASSERT_THAT(read_topics, SizeIs(1));
+  EXPECT_THAT(read_topics[0].total_bytes, Eq(0u));
+  EXPECT_THAT(read_topics[0].size_histogram, IsEmpty());
+}
+
+TEST_F(MetadataFixture, metadata_write_replaces_previous_metadata)
+{
+  BagMetadata metadata{};
+  metadata.relative_file_paths = {"first_file"};
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+
+  metadata.relative_file_paths.push_back("second_file");
+  metadata.finalized = true;
+  metadata_io_->write_metadata(temporary_dir_path_, metadata);
+
+  auto read_metadata = metadata_io_->read_metadata(temporary_dir_path_);
+  EXPECT_THAT(read_metadata.relative_file_paths, ElementsAre("first_file", "second_file"));
+  EXPECT_TRUE(read_metadata.finalized);
+  // The temporary file the metadata is written to first is moved in place.
+  std::ifstream temporary_file(temporary_dir_path_ + "/metadata.yaml.tmp");
+  EXPECT_FALSE(temporary_file.good());
+}
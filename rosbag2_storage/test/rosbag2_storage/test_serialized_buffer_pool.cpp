@@ -0,0 +1,132 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "rosbag2_storage/serialized_buffer_pool.hpp"
+
+using namespace ::testing;  // NOLINT
+
+class SerializedBufferPoolTest : public Test
+{
+public:
+  SerializedBufferPoolTest()
+  {
+    rosbag2_storage::clear_serialized_buffer_pool();
+  }
+
+  ~SerializedBufferPoolTest() override
+  {
+    rosbag2_storage::clear_serialized_buffer_pool();
+  }
+};
+
+TEST_F(SerializedBufferPoolTest, pooled_message_contains_the_data) {
+  const std::string data = "some serialized data";
+
+  auto message = rosbag2_storage::make_pooled_serialized_message(data.data(), data.size());
+
+  ASSERT_THAT(message->buffer_length, Eq(data.size()));
+  EXPECT_THAT(message->buffer_capacity, Ge(data.size()));
+  EXPECT_THAT(std::memcmp(message->buffer, data.data(), data.size()), Eq(0));
+}
+
+TEST_F(SerializedBufferPoolTest, released_buffers_are_reused_for_the_same_size_class) {
+  auto message = rosbag2_storage::make_pooled_empty_serialized_message(1000);
+  const auto buffer = message->buffer;
+  EXPECT_THAT(message->buffer_length, Eq(0u));
+  EXPECT_THAT(message->buffer_capacity, Eq(1024u));
+  message.reset();
+
+  auto statistics = rosbag2_storage::get_serialized_buffer_pool_statistics();
+  EXPECT_THAT(statistics.allocated_buffers, Eq(1u));
+  EXPECT_THAT(statistics.free_buffers, Eq(1u));
+  EXPECT_THAT(statistics.free_bytes, Eq(1024u));
+
+  message = rosbag2_storage::make_pooled_empty_serialized_message(600);
+  EXPECT_THAT(message->buffer, Eq(buffer));
+  EXPECT_THAT(message->buffer_length, Eq(0u));
+
+  statistics = rosbag2_storage::get_serialized_buffer_pool_statistics();
+  EXPECT_THAT(statistics.reused_buffers, Eq(1u));
+  EXPECT_THAT(statistics.free_buffers, Eq(0u));
+  EXPECT_THAT(statistics.free_bytes, Eq(0u));
+}
+
+TEST_F(SerializedBufferPoolTest, buffers_of_other_size_classes_are_not_reused) {
+  rosbag2_storage::make_pooled_empty_serialized_message(100);
+
+  auto message = rosbag2_storage::make_pooled_empty_serialized_message(1000);
+
+  const auto statistics = rosbag2_storage::get_serialized_buffer_pool_statistics();
+  EXPECT_THAT(statistics.allocated_buffers, Eq(2u));
+  EXPECT_THAT(statistics.reused_buffers, Eq(0u));
+  EXPECT_THAT(statistics.free_buffers, Eq(1u));
+}
+
+TEST_F(SerializedBufferPoolTest, resized_buffers_are_returned_to_the_size_class_they_cover) {
+  auto message = rosbag2_storage::make_pooled_empty_serialized_message(100);
+  ASSERT_THAT(
+    rcutils_uint8_array_resize(message.get(), 5000), Eq(RCUTILS_RET_OK));
+  message.reset();
+
+  // The buffer covers 4096 bytes, but not 8192.
+  message = rosbag2_storage::make_pooled_empty_serialized_message(8000);
+  EXPECT_THAT(rosbag2_storage::get_serialized_buffer_pool_statistics().reused_buffers, Eq(0u));
+  message = rosbag2_storage::make_pooled_empty_serialized_message(4000);
+  EXPECT_THAT(rosbag2_storage::get_serialized_buffer_pool_statistics().reused_buffers, Eq(1u));
+  EXPECT_THAT(message->buffer_capacity, Eq(5000u));
+}
+
+TEST_F(SerializedBufferPoolTest, buffers_larger_than_the_pooled_capacity_are_not_kept) {
+  rosbag2_storage::make_pooled_empty_serialized_message(
+    2 * rosbag2_storage::MAX_POOLED_BUFFER_CAPACITY);
+
+  EXPECT_THAT(rosbag2_storage::get_serialized_buffer_pool_statistics().free_buffers, Eq(0u));
+}
+
+TEST_F(SerializedBufferPoolTest, buffers_return_to_the_allocating_thread) {
+  auto message = rosbag2_storage::make_pooled_empty_serialized_message(1000);
+  const auto buffer = message->buffer;
+
+  std::thread releasing_thread(
+    [&message]() {
+      message.reset();
+      EXPECT_THAT(rosbag2_storage::get_serialized_buffer_pool_statistics().free_buffers, Eq(0u));
+    });
+  releasing_thread.join();
+
+  EXPECT_THAT(rosbag2_storage::get_serialized_buffer_pool_statistics().free_buffers, Eq(1u));
+  message = rosbag2_storage::make_pooled_empty_serialized_message(1000);
+  EXPECT_THAT(message->buffer, Eq(buffer));
+  EXPECT_THAT(rosbag2_storage::get_serialized_buffer_pool_statistics().reused_buffers, Eq(1u));
+}
+
+TEST_F(SerializedBufferPoolTest, buffers_can_outlive_the_allocating_thread) {
+  std::shared_ptr<rcutils_uint8_array_t> message;
+  std::thread allocating_thread(
+    [&message]() {
+      message = rosbag2_storage::make_pooled_empty_serialized_message(1000);
+    });
+  allocating_thread.join();
+
+  ASSERT_THAT(message->buffer_capacity, Eq(1024u));
+  message.reset();
+  EXPECT_THAT(rosbag2_storage::get_serialized_buffer_pool_statistics().free_buffers, Eq(0u));
+}
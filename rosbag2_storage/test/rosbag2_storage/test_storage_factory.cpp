@@ -16,6 +16,8 @@
 
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "rosbag2_storage/storage_interfaces/read_only_interface.hpp"
 #include "rosbag2_storage/storage_interfaces/read_write_interface.hpp"
@@ -100,3 +102,31 @@ TEST_F(StorageFactoryTest, load_unavailable_plugin) {
     bag_file_path, test_unavailable_plugin_id);
   EXPECT_EQ(nullptr, instance_ro);
 }
+
+TEST_F(StorageFactoryTest, storages_outlive_their_factory) {
+  auto read_write_storage = rosbag2_storage::StorageFactory().open_read_write(
+    bag_file_path, test_plugin_id);
+  ASSERT_NE(nullptr, read_write_storage);
+  EXPECT_EQ(
+    test_constants::READ_WRITE_PLUGIN_IDENTIFIER,
+    read_write_storage->get_storage_identifier());
+}
+
+TEST_F(StorageFactoryTest, factories_open_storages_from_several_threads) {
+  std::vector<std::thread> threads;
+  std::vector<std::shared_ptr<ReadOnlyInterface>> storages(8);
+  for (size_t i = 0; i < storages.size(); ++i) {
+    threads.emplace_back(
+      [this, &storages, i]() {
+        storages[i] = rosbag2_storage::StorageFactory().open_read_only(
+          bag_file_path, test_read_only_plugin_id);
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (const auto & storage : storages) {
+    ASSERT_NE(nullptr, storage);
+    EXPECT_EQ(test_constants::READ_ONLY_PLUGIN_IDENTIFIER, storage->get_storage_identifier());
+  }
+}
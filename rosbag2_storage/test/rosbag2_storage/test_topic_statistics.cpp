@@ -0,0 +1,91 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <string>
+
+#include "rosbag2_storage/ros_helper.hpp"
+#include "rosbag2_storage/topic_statistics.hpp"
+
+using namespace ::testing;  // NOLINT
+using namespace std::chrono_literals;  // NOLINT
+
+namespace
+{
+rosbag2_storage::SerializedBagMessage make_message(size_t size, rcutils_time_point_value_t stamp)
+{
+  rosbag2_storage::SerializedBagMessage message;
+  message.serialized_data = rosbag2_storage::make_empty_serialized_message(size);
+  message.serialized_data->buffer_length = size;
+  message.time_stamp = stamp;
+  message.topic_name = "topic";
+  return message;
+}
+}  // namespace
+
+TEST(topic_statistics, size_histogram_buckets_are_powers_of_two) {
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket(0), Eq(0u));
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket(1), Eq(1u));
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket(2), Eq(2u));
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket(3), Eq(2u));
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket(1024), Eq(11u));
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket(UINT64_MAX), Eq(64u));
+
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket_limit(0), Eq(1u));
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket_limit(11), Eq(2048u));
+  EXPECT_THAT(rosbag2_storage::get_size_histogram_bucket_limit(64), Eq(UINT64_MAX));
+}
+
+TEST(topic_statistics, update_tracks_bytes_stamps_and_sizes_of_messages) {
+  rosbag2_storage::TopicInformation topic_information{{"topic", "type", "rmw", ""}, 0};
+
+  for (const auto & message : {make_message(100, 2000), make_message(3, 1000),
+      make_message(120, 5000), make_message(0, 3000)})
+  {
+    ++topic_information.message_count;
+    rosbag2_storage::update_topic_statistics(topic_information, message);
+  }
+
+  EXPECT_THAT(topic_information.total_bytes, Eq(223u));
+  EXPECT_THAT(topic_information.starting_time.time_since_epoch(), Eq(1000ns));
+  EXPECT_THAT(topic_information.duration, Eq(4000ns));
+  EXPECT_THAT(topic_information.size_histogram, ElementsAre(1u, 0u, 1u, 0u, 0u, 0u, 0u, 2u));
+  EXPECT_THAT(rosbag2_storage::get_message_rate(topic_information), DoubleEq(3 / 4e-6));
+}
+
+TEST(topic_statistics, message_rate_is_zero_without_statistics) {
+  rosbag2_storage::TopicInformation topic_information{{"topic", "type", "rmw", ""}, 10};
+  EXPECT_THAT(rosbag2_storage::get_message_rate(topic_information), DoubleEq(0.0));
+
+  rosbag2_storage::TopicInformation first_message_information{{"topic", "type", "rmw", ""}, 1};
+  rosbag2_storage::update_topic_statistics(first_message_information, make_message(10, 1000));
+  EXPECT_THAT(rosbag2_storage::get_message_rate(first_message_information), DoubleEq(0.0));
+}
+
+TEST(topic_statistics, update_extends_the_time_range_of_topics_without_histogram) {
+  // As in reindexed bags, which summarize topics without a histogram.
+  rosbag2_storage::TopicInformation topic_information{{"topic", "type", "rmw", ""}, 5};
+  topic_information.starting_time =
+    std::chrono::time_point<std::chrono::high_resolution_clock>(1000ns);
+  topic_information.duration = 1000ns;
+
+  ++topic_information.message_count;
+  rosbag2_storage::update_topic_statistics(topic_information, make_message(10, 5000));
+
+  EXPECT_THAT(topic_information.starting_time.time_since_epoch(), Eq(1000ns));
+  EXPECT_THAT(topic_information.duration, Eq(4000ns));
+  EXPECT_THAT(topic_information.size_histogram, ElementsAre(0u, 0u, 0u, 0u, 1u));
+}
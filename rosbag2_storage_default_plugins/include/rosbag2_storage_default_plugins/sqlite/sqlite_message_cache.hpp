@@ -0,0 +1,127 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSBAG2_STORAGE_DEFAULT_PLUGINS__SQLITE__SQLITE_MESSAGE_CACHE_HPP_
+#define ROSBAG2_STORAGE_DEFAULT_PLUGINS__SQLITE__SQLITE_MESSAGE_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "rosbag2_storage/read_cache_statistics.hpp"
+#include "rosbag2_storage/serialized_bag_message.hpp"
+#include "rosbag2_storage_default_plugins/visibility_control.hpp"
+
+// This is necessary because of using stl types here. It is completely safe, because
+// a) the member is not accessible from the outside
+// b) there are no inline functions.
+#ifdef _WIN32
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace rosbag2_storage_plugins
+{
+
+struct SqliteMessageCacheKey
+{
+  int topic_id;
+  int32_t rowid;
+
+  bool operator==(const SqliteMessageCacheKey & other) const
+  {
+    return topic_id == other.topic_id && rowid == other.rowid;
+  }
+};
+
+struct SqliteMessageCacheKeyHash
+{
+  size_t operator()(const SqliteMessageCacheKey & key) const
+  {
+    return std::hash<int64_t>()(
+      (static_cast<int64_t>(key.topic_id) << 32) ^ static_cast<uint32_t>(key.rowid));
+  }
+};
+
+/**
+ * Byte-bounded least-recently-used cache of messages read from a sqlite3 database.
+ *
+ * Entries are keyed by the (topic_id, rowid) pair of the messages table and accounted for with
+ * the length of their serialized payload. All methods are thread-safe.
+ *
+ * Messages handed out by get() are fresh SerializedBagMessage instances, but their payload buffer
+ * is shared with the cache and must be treated as read-only.
+ */
+class ROSBAG2_STORAGE_DEFAULT_PLUGINS_PUBLIC SqliteMessageCache
+{
+public:
+  explicit SqliteMessageCache(uint64_t max_cache_bytes = 0);
+
+  SqliteMessageCache(const SqliteMessageCache &) = delete;
+  SqliteMessageCache & operator=(const SqliteMessageCache &) = delete;
+
+  /// Change the byte budget, evicting least recently used entries if necessary.
+  void set_max_cache_bytes(uint64_t max_cache_bytes);
+
+  uint64_t get_max_cache_bytes() const;
+
+  /// Return the cached message or nullptr. Counts as a hit or a miss respectively.
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> get(const SqliteMessageCacheKey & key);
+
+  /// Insert or refresh a message. Messages larger than the whole budget are not cached.
+  /// \return true if the message is held by the cache afterwards
+  bool put(
+    const SqliteMessageCacheKey & key,
+    std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message);
+
+  /// Check for an entry without touching the recency order or the hit/miss counters.
+  bool contains(const SqliteMessageCacheKey & key) const;
+
+  /// Drop all entries. The hit/miss counters are kept.
+  void clear();
+
+  rosbag2_storage::ReadCacheStatistics get_statistics() const;
+
+private:
+  using Entry =
+    std::pair<SqliteMessageCacheKey, std::shared_ptr<const rosbag2_storage::SerializedBagMessage>>;
+  using EntryList = std::list<Entry>;
+
+  static uint64_t payload_size(const rosbag2_storage::SerializedBagMessage & message);
+  void evict_to_fit(uint64_t max_cache_bytes);
+
+  mutable std::mutex mutex_;
+  uint64_t max_cache_bytes_;
+  uint64_t cached_bytes_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  // Most recently used entries are kept at the front.
+  EntryList entries_;
+  std::unordered_map<SqliteMessageCacheKey, EntryList::iterator, SqliteMessageCacheKeyHash>
+  index_;
+};
+
+}  // namespace rosbag2_storage_plugins
+
+#ifdef _WIN32
+# pragma warning(pop)
+#endif
+
+#endif  // ROSBAG2_STORAGE_DEFAULT_PLUGINS__SQLITE__SQLITE_MESSAGE_CACHE_HPP_
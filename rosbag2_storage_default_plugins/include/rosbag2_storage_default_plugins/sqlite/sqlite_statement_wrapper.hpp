@@ -17,6 +17,7 @@
 
 #include <sqlite3.h>
 
+#include <cstddef>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -188,9 +189,16 @@ private:
   std::shared_ptr<SqliteStatementWrapper> bind(double value);
   std::shared_ptr<SqliteStatementWrapper> bind(const std::string & value);
   std::shared_ptr<SqliteStatementWrapper> bind(std::shared_ptr<rcutils_uint8_array_t> value);
+  std::shared_ptr<SqliteStatementWrapper> bind(std::nullptr_t);
 
   std::shared_ptr<SqliteStatementWrapper> reset();
 
+  // Columns of the row a query result iterator is at, without copying them. Text and blobs are
+  // owned by SQLite and valid until the statement steps or is reset.
+  rcutils_time_point_value_t get_column_int64(size_t index) const;
+  const char * get_column_text(size_t index, size_t & size) const;
+  const void * get_column_blob(size_t index, size_t & size) const;
+
 private:
   bool step();
   bool is_query_ok(int return_code);
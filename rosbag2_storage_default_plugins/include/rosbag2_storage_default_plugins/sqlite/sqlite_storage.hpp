@@ -16,6 +16,7 @@
 #define ROSBAG2_STORAGE_DEFAULT_PLUGINS__SQLITE__SQLITE_STORAGE_HPP_
 
 #include <atomic>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -24,8 +25,10 @@
 #include "rcutils/types.h"
 #include "rosbag2_storage/storage_interfaces/read_write_interface.hpp"
 #include "rosbag2_storage/serialized_bag_message.hpp"
+#include "rosbag2_storage/read_cache_statistics.hpp"
 #include "rosbag2_storage/storage_filter.hpp"
 #include "rosbag2_storage/topic_metadata.hpp"
+#include "rosbag2_storage_default_plugins/sqlite/sqlite_message_cache.hpp"
 #include "rosbag2_storage_default_plugins/sqlite/sqlite_wrapper.hpp"
 #include "rosbag2_storage_default_plugins/visibility_control.hpp"
 
@@ -63,10 +66,19 @@ public:
     const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> & messages)
   override;
 
+  std::vector<int32_t> write_and_get_ids(
+    const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> & messages)
+  override;
+
   bool has_next() override;
 
   std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_next() override;
 
+  void read_next_batch(
+    rosbag2_storage::MessageBatch & batch,
+    size_t max_messages,
+    uint64_t max_payload_bytes) override;
+
   std::shared_ptr<rosbag2_storage::SerializedBagMessage>
   read_at_timestamp(rcutils_time_point_value_t timestamp) override;
 
@@ -80,8 +92,39 @@ public:
   std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
   read_at_index_range(int32_t index_begin, int32_t index_end) override;
 
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_at_indices(const std::vector<int64_t> & indices) override;
+
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_topics_at_timestamp_range(
+    const std::vector<std::string> & topic_names,
+    rcutils_time_point_value_t timestamp_begin,
+    rcutils_time_point_value_t timestamp_end) override;
+
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+  read_closest(const std::string & topic_name, rcutils_time_point_value_t timestamp) override;
+
+  void seek(rcutils_time_point_value_t timestamp) override;
+
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_at_timestamps(const std::vector<rcutils_time_point_value_t> & timestamps) override;
+
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+  read_by_key(const std::string & topic_name, int64_t key) override;
+
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_by_key_range(
+    const std::string & topic_name, int64_t key_begin, int64_t key_end) override;
+
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_latest_before(
+    const std::vector<std::string> & topic_names,
+    rcutils_time_point_value_t timestamp) override;
+
   int32_t get_last_inserted_id() override;
 
+  int32_t get_topic_id(const std::string & topic_name) override;
+
   std::vector<rosbag2_storage::TopicMetadata> get_all_topics_and_types() override;
 
   rosbag2_storage::BagMetadata get_metadata() override;
@@ -90,6 +133,8 @@ public:
 
   uint64_t get_bagfile_size() const override;
 
+  uint64_t get_bagfile_size_estimate() const override;
+
   std::string get_storage_identifier() const override;
 
   uint64_t get_minimum_split_file_size() const override;
@@ -104,13 +149,24 @@ public:
 
   std::shared_ptr<rosbag2_storage::SerializedBagMessage> modified_read_next() override;
 
+  void set_read_cache_size(uint64_t max_cache_bytes) override;
+
+  size_t prefetch_index_range(int32_t index_begin, int32_t index_end) override;
+
+  rosbag2_storage::ReadCacheStatistics get_read_cache_statistics() const override;
+
 private:
   void initialize();
+  void upgrade_schema(rosbag2_storage::storage_interfaces::IOFlag io_flag);
   void prepare_for_writing();
   void prepare_for_reading();
   void fill_topics_and_types();
   void activate_transaction();
   void commit_transaction();
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_single_message(
+    const std::string & condition);
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> read_single_message_cached(
+    const std::string & condition);
 
   using ReadQueryResult = SqliteStatementWrapper::QueryResult<
     std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string>;
@@ -120,6 +176,8 @@ private:
   std::shared_ptr<SqliteWrapper> database_;
   SqliteStatement write_statement_ {};
   SqliteStatement read_statement_ {};
+  SqliteStatement read_at_indices_statement_ {};
+  SqliteStatement read_at_timestamps_statement_ {};
   ReadQueryResult message_result_ {nullptr};
   ModifiedReadQueryResult modified_message_result_ {nullptr};
   ReadQueryResult::Iterator current_message_row_ {
@@ -127,10 +185,19 @@ private:
   ModifiedReadQueryResult::Iterator modified_current_message_row_ {
     nullptr, SqliteStatementWrapper::QueryResult<>::Iterator::POSITION_END};
   std::unordered_map<std::string, int> topics_;
+  // Indexed by topic id; set for the topics created on this storage, to check messages carrying
+  // a topic id against.
+  std::vector<bool> created_topic_ids_;
   std::vector<rosbag2_storage::TopicMetadata> all_topics_and_types_;
   std::string relative_path_;
   std::atomic_bool active_transaction_ {false};
+  // Size of the database file as of the last get_bagfile_size(), plus the payload committed since.
+  mutable std::atomic<uint64_t> bagfile_size_estimate_ {0};
+  uint64_t uncommitted_bytes_ {0};
+  bool has_key_column_ {false};
   rosbag2_storage::StorageFilter storage_filter_ {};
+  rcutils_time_point_value_t seek_time_ {std::numeric_limits<rcutils_time_point_value_t>::min()};
+  SqliteMessageCache message_cache_ {};
 };
 
 }  // namespace rosbag2_storage_plugins
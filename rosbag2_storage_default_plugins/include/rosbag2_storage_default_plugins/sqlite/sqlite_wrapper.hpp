@@ -46,7 +46,12 @@ public:
   operator bool();
 
 private:
+  // Throws SqliteException, closing the database, if it is not a valid database.
+  void check_schema_version();
+
   DBPtr db_ptr;
+  // Set for databases opened for writing.
+  bool checkpoint_on_close_ = false;
 };
 
 
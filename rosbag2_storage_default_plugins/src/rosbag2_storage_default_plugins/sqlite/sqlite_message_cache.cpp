@@ -0,0 +1,123 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rosbag2_storage_default_plugins/sqlite/sqlite_message_cache.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace rosbag2_storage_plugins
+{
+
+SqliteMessageCache::SqliteMessageCache(uint64_t max_cache_bytes)
+: max_cache_bytes_(max_cache_bytes)
+{}
+
+void SqliteMessageCache::set_max_cache_bytes(uint64_t max_cache_bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_cache_bytes_ = max_cache_bytes;
+  evict_to_fit(max_cache_bytes_);
+}
+
+uint64_t SqliteMessageCache::get_max_cache_bytes() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_cache_bytes_;
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+SqliteMessageCache::get(const SqliteMessageCacheKey & key)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = index_.find(key);
+  if (entry == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, entry->second);
+  return std::make_shared<rosbag2_storage::SerializedBagMessage>(*entry->second->second);
+}
+
+bool SqliteMessageCache::put(
+  const SqliteMessageCacheKey & key,
+  std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message)
+{
+  if (!message) {
+    return false;
+  }
+  const auto size = payload_size(*message);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto existing = index_.find(key);
+  if (existing != index_.end()) {
+    cached_bytes_ -= payload_size(*existing->second->second);
+    entries_.erase(existing->second);
+    index_.erase(existing);
+  }
+  if (size > max_cache_bytes_) {
+    return false;
+  }
+
+  evict_to_fit(max_cache_bytes_ - size);
+  entries_.emplace_front(key, std::move(message));
+  index_.emplace(key, entries_.begin());
+  cached_bytes_ += size;
+  return true;
+}
+
+bool SqliteMessageCache::contains(const SqliteMessageCacheKey & key) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.find(key) != index_.end();
+}
+
+void SqliteMessageCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  cached_bytes_ = 0;
+}
+
+rosbag2_storage::ReadCacheStatistics SqliteMessageCache::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  rosbag2_storage::ReadCacheStatistics statistics;
+  statistics.hits = hits_;
+  statistics.misses = misses_;
+  statistics.cached_messages = entries_.size();
+  statistics.cached_bytes = cached_bytes_;
+  statistics.max_cache_bytes = max_cache_bytes_;
+  return statistics;
+}
+
+uint64_t SqliteMessageCache::payload_size(const rosbag2_storage::SerializedBagMessage & message)
+{
+  return message.serialized_data ? message.serialized_data->buffer_length : 0u;
+}
+
+void SqliteMessageCache::evict_to_fit(uint64_t max_cache_bytes)
+{
+  while (cached_bytes_ > max_cache_bytes && !entries_.empty()) {
+    const auto & victim = entries_.back();
+    cached_bytes_ -= payload_size(*victim.second);
+    index_.erase(victim.first);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace rosbag2_storage_plugins
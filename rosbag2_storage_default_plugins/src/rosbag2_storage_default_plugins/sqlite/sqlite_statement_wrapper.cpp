@@ -22,7 +22,7 @@
 #include <vector>
 
 #include "rcutils/logging_macros.h"
-#include "rosbag2_storage/ros_helper.hpp"
+#include "rosbag2_storage/serialized_buffer_pool.hpp"
 
 #include "rosbag2_storage_default_plugins/sqlite/sqlite_exception.hpp"
 
@@ -111,6 +111,13 @@ SqliteStatementWrapper::bind(std::shared_ptr<rcutils_uint8_array_t> value)
   return shared_from_this();
 }
 
+std::shared_ptr<SqliteStatementWrapper> SqliteStatementWrapper::bind(std::nullptr_t)
+{
+  auto return_code = sqlite3_bind_null(statement_, ++last_bound_parameter_index_);
+  check_and_report_bind_error(return_code);
+  return shared_from_this();
+}
+
 std::shared_ptr<SqliteStatementWrapper> SqliteStatementWrapper::reset()
 {
   sqlite3_reset(statement_);
@@ -162,7 +169,28 @@ void SqliteStatementWrapper::obtain_column_value(
 {
   auto data = sqlite3_column_blob(statement_, static_cast<int>(index));
   auto size = static_cast<size_t>(sqlite3_column_bytes(statement_, static_cast<int>(index)));
-  value = rosbag2_storage::make_serialized_message(data, size);
+  value = rosbag2_storage::make_pooled_serialized_message(data, size);
+}
+
+rcutils_time_point_value_t SqliteStatementWrapper::get_column_int64(size_t index) const
+{
+  return sqlite3_column_int64(statement_, static_cast<int>(index));
+}
+
+const char * SqliteStatementWrapper::get_column_text(size_t index, size_t & size) const
+{
+  // The size is only valid after the value was obtained in the requested format.
+  auto text = reinterpret_cast<const char *>(
+    sqlite3_column_text(statement_, static_cast<int>(index)));
+  size = static_cast<size_t>(sqlite3_column_bytes(statement_, static_cast<int>(index)));
+  return text;
+}
+
+const void * SqliteStatementWrapper::get_column_blob(size_t index, size_t & size) const
+{
+  auto data = sqlite3_column_blob(statement_, static_cast<int>(index));
+  size = static_cast<size_t>(sqlite3_column_bytes(statement_, static_cast<int>(index)));
+  return data;
 }
 
 void SqliteStatementWrapper::check_and_report_bind_error(int return_code)
@@ -16,13 +16,16 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstring>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -44,6 +47,8 @@ std::string to_string(rosbag2_storage::storage_interfaces::IOFlag io_flag)
       return "APPEND";
     case rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY:
       return "READ_ONLY";
+    case rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY_IMMUTABLE:
+      return "READ_ONLY_IMMUTABLE";
     case rosbag2_storage::storage_interfaces::IOFlag::READ_WRITE:
       return "READ_WRITE";
     default:
@@ -58,11 +63,77 @@ bool is_read_write(const rosbag2_storage::storage_interfaces::IOFlag io_flag)
 
 bool is_read_only(const rosbag2_storage::storage_interfaces::IOFlag io_flag)
 {
-  return io_flag == rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY;
+  return io_flag == rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY ||
+         io_flag == rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY_IMMUTABLE;
+}
+
+// Number of values bound per execution of the statements reading messages at several ids or
+// timestamps. The statements stay short, so they are prepared only once.
+constexpr const size_t READ_AT_CHUNK_SIZE = 64;
+
+// Bytes a message adds to the database besides its payload, used to estimate the bagfile size
+// between two reads of the real size:
+// - messages row: cell pointer and size varints (~5), record header (~5), rowid, topic_id and
+//   timestamp (~12);
+// - timestamp_idx and topic_timestamp_idx entries: cell pointer, record header, indexed columns
+//   and rowid (~13 each).
+// Rows are appended in rowid order, which keeps the b-tree pages nearly full.
+constexpr const uint64_t ESTIMATED_ROW_OVERHEAD_BYTES = 48;
+// Bytes added on top of ESTIMATED_ROW_OVERHEAD_BYTES by a keyed message: the app_key column
+// and its entry in the partial app_key_idx.
+constexpr const uint64_t ESTIMATED_KEY_OVERHEAD_BYTES = 24;
+
+uint64_t estimate_row_size(const rosbag2_storage::SerializedBagMessage & message)
+{
+  uint64_t row_bytes = ESTIMATED_ROW_OVERHEAD_BYTES;
+  if (message.serialized_data) {
+    row_bytes += message.serialized_data->buffer_length;
+  }
+  if (message.has_key) {
+    row_bytes += ESTIMATED_KEY_OVERHEAD_BYTES;
+  }
+  return row_bytes;
+}
+
+std::string get_chunk_parameter_list()
+{
+  std::string list = "?";
+  for (size_t i = 1; i < READ_AT_CHUNK_SIZE; ++i) {
+    list += ",?";
+  }
+  return list;
+}
+
+// Binds the chunk of the sorted values starting at `begin`, repeating the last value to fill a
+// partial chunk.
+void bind_chunk(
+  rosbag2_storage_plugins::SqliteStatementWrapper & statement,
+  const std::vector<int64_t> & values, size_t begin)
+{
+  statement.reset();
+  for (size_t i = begin; i < begin + READ_AT_CHUNK_SIZE; ++i) {
+    statement.bind(values[std::min(i, values.size() - 1)]);
+  }
+}
+
+template<typename T>
+std::vector<int64_t> get_sorted_keys(const std::unordered_map<int64_t, T> & map)
+{
+  std::vector<int64_t> keys;
+  keys.reserve(map.size());
+  for (const auto & entry : map) {
+    keys.push_back(entry.first);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
 }
 
 constexpr const auto FILE_EXTENSION = ".db3";
 
+// Capacity reserved in a batch for messages and payloads which read_next_batch is about to add.
+constexpr const size_t BATCH_RESERVED_MESSAGES = 256;
+constexpr const uint64_t BATCH_RESERVED_PAYLOAD_BYTES = 64 * 1024;
+
 // Minimum size of a sqlite3 database file in bytes (84 kiB).
 constexpr const uint64_t MIN_SPLIT_FILE_SIZE = 86016;
 }  // namespace
@@ -108,12 +179,20 @@ void SqliteStorage::open(
   // initialize only for READ_WRITE since the DB is already initialized if in APPEND.
   if (is_read_write(io_flag)) {
     initialize();
+  } else {
+    upgrade_schema(io_flag);
   }
 
   // Reset the read and write statements in case the database changed.
   // These will be reinitialized lazily on the first read or write.
   read_statement_ = nullptr;
   write_statement_ = nullptr;
+  read_at_indices_statement_ = nullptr;
+  read_at_timestamps_statement_ = nullptr;
+  seek_time_ = std::numeric_limits<rcutils_time_point_value_t>::min();
+  message_cache_.clear();
+  uncommitted_bytes_ = 0;
+  bagfile_size_estimate_ = get_bagfile_size();
 
   ROSBAG2_STORAGE_DEFAULT_PLUGINS_LOG_INFO_STREAM(
     "Opened database '" << relative_path_ << "' for " << to_string(io_flag) << ".");
@@ -141,6 +220,8 @@ void SqliteStorage::commit_transaction()
   database_->prepare_statement("COMMIT;")->execute_and_reset();
 
   active_transaction_ = false;
+  bagfile_size_estimate_ += uncommitted_bytes_;
+  uncommitted_bytes_ = 0;
 }
 
 int32_t SqliteStorage::get_last_inserted_id()
@@ -148,20 +229,51 @@ int32_t SqliteStorage::get_last_inserted_id()
   return database_->get_last_insert_id();
 }
 
+int32_t SqliteStorage::get_topic_id(const std::string & topic_name)
+{
+  auto topic_entry = topics_.find(topic_name);
+  if (topic_entry == end(topics_)) {
+    throw SqliteException(
+            "Topic '" + topic_name + "' has not been created yet! Call 'create_topic' first.");
+  }
+  return topic_entry->second;
+}
+
 void SqliteStorage::write(std::shared_ptr<const rosbag2_storage::SerializedBagMessage> message)
 {
   if (!write_statement_) {
     prepare_for_writing();
   }
-  auto topic_entry = topics_.find(message->topic_name);
-  if (topic_entry == end(topics_)) {
+  int topic_id = message->topic_id;
+  if (topic_id < 0) {
+    auto topic_entry = topics_.find(message->topic_name);
+    if (topic_entry == end(topics_)) {
+      throw SqliteException(
+              "Topic '" + message->topic_name +
+              "' has not been created yet! Call 'create_topic' first.");
+    }
+    topic_id = topic_entry->second;
+  } else if (static_cast<size_t>(topic_id) >= created_topic_ids_.size() ||
+    !created_topic_ids_[topic_id])
+  {
     throw SqliteException(
-            "Topic '" + message->topic_name +
-            "' has not been created yet! Call 'create_topic' first.");
+            "Topic id " + std::to_string(topic_id) + " does not belong to a created topic!");
   }
 
-  write_statement_->bind(message->time_stamp, topic_entry->second, message->serialized_data);
+  write_statement_->bind(message->time_stamp, topic_id, message->serialized_data);
+  if (message->has_key) {
+    write_statement_->bind(message->key);
+  } else {
+    write_statement_->bind(nullptr);
+  }
   write_statement_->execute_and_reset();
+
+  const uint64_t row_bytes = estimate_row_size(*message);
+  if (active_transaction_) {
+    uncommitted_bytes_ += row_bytes;
+  } else {
+    bagfile_size_estimate_ += row_bytes;
+  }
 }
 
 void SqliteStorage::write(
@@ -180,6 +292,28 @@ void SqliteStorage::write(
   commit_transaction();
 }
 
+std::vector<int32_t> SqliteStorage::write_and_get_ids(
+  const std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> & messages)
+{
+  if (!write_statement_) {
+    prepare_for_writing();
+  }
+
+  std::vector<int32_t> ids;
+  ids.reserve(messages.size());
+
+  activate_transaction();
+
+  for (auto & message : messages) {
+    write(message);
+    ids.push_back(get_last_inserted_id());
+  }
+
+  commit_transaction();
+
+  return ids;
+}
+
 bool SqliteStorage::has_next()
 {
   if (!read_statement_) {
@@ -204,6 +338,42 @@ std::shared_ptr<rosbag2_storage::SerializedBagMessage> SqliteStorage::read_next(
   return bag_message;
 }
 
+void SqliteStorage::read_next_batch(
+  rosbag2_storage::MessageBatch & batch, size_t max_messages, uint64_t max_payload_bytes)
+{
+  if (!read_statement_) {
+    prepare_for_reading();
+  }
+
+  // Both limits may be unbounded, so only up to a typical batch is reserved up front.
+  batch.reserve(
+    std::min<size_t>(max_messages, BATCH_RESERVED_MESSAGES),
+    std::min<uint64_t>(max_payload_bytes, BATCH_RESERVED_PAYLOAD_BYTES));
+
+  // The columns of the row the iterator is at are read from the statement, so the payload is
+  // copied once, straight into the batch, and the topic name only when it changes.
+  std::string topic_name;
+  uint32_t topic_id = 0;
+  bool has_topic = false;
+  while (current_message_row_ != message_result_.end() &&
+    !batch.is_full(max_messages, max_payload_bytes))
+  {
+    size_t topic_name_size = 0;
+    const auto topic_name_text = read_statement_->get_column_text(2, topic_name_size);
+    if (!has_topic ||
+      topic_name.compare(0, std::string::npos, topic_name_text, topic_name_size) != 0)
+    {
+      topic_name.assign(topic_name_text, topic_name_size);
+      topic_id = batch.add_topic(topic_name);
+      has_topic = true;
+    }
+    size_t size = 0;
+    const auto data = read_statement_->get_column_blob(0, size);
+    batch.add_message(topic_id, read_statement_->get_column_int64(1), data, size);
+    ++current_message_row_;
+  }
+}
+
 bool SqliteStorage::seek_by_index(int32_t index)
 {
   auto read_statement = database_->prepare_statement(
@@ -230,6 +400,13 @@ bool SqliteStorage::seek_by_timestamp(rcutils_time_point_value_t timestamp)
   return modified_current_message_row_ != modified_message_result_.end();
 }
 
+void SqliteStorage::seek(rcutils_time_point_value_t timestamp)
+{
+  seek_time_ = timestamp;
+  // The read statement is prepared again, starting at the seek time, on the next read.
+  read_statement_ = nullptr;
+}
+
 std::shared_ptr<rosbag2_storage::SerializedBagMessage> SqliteStorage::modified_read_next()
 {
   std::shared_ptr<rosbag2_storage::SerializedBagMessage> bag_message;
@@ -247,22 +424,38 @@ std::shared_ptr<rosbag2_storage::SerializedBagMessage> SqliteStorage::modified_r
 
 std::shared_ptr<rosbag2_storage::SerializedBagMessage>
 SqliteStorage::read_at_timestamp(rcutils_time_point_value_t timestamp)
+{
+  const auto condition = "messages.timestamp = " + std::to_string(timestamp);
+  if (message_cache_.get_max_cache_bytes() > 0) {
+    return read_single_message_cached(condition);
+  }
+  return read_single_message(condition);
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+SqliteStorage::read_at_index(int32_t index)
+{
+  const auto condition = "messages.id = " + std::to_string(index);
+  if (message_cache_.get_max_cache_bytes() > 0) {
+    return read_single_message_cached(condition);
+  }
+  return read_single_message(condition);
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+SqliteStorage::read_single_message(const std::string & condition)
 {
   std::shared_ptr<rosbag2_storage::SerializedBagMessage> bag_message;
 
   auto read_statement = database_->prepare_statement(
     "SELECT data, timestamp, topics.name, messages.id "
     "FROM messages JOIN topics ON messages.topic_id = topics.id "
-    "WHERE messages.timestamp = " + std::to_string(timestamp) + " "
+    "WHERE " + condition + " "
     "ORDER BY messages.timestamp;");
 
   auto message_result = read_statement->execute_query<
     std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t>();
 
-  // if(message_result.begin() == message_result.end()) {
-  //   throw std::runtime_error("No messages found for timestamp " + std::to_string(timestamp));
-  // }
-
   ModifiedReadQueryResult::Iterator current_message_row = message_result.begin();
   if (current_message_row != message_result.end()) {  // message exists
     bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
@@ -271,63 +464,99 @@ SqliteStorage::read_at_timestamp(rcutils_time_point_value_t timestamp)
     bag_message->topic_name = std::get<2>(*current_message_row);
     bag_message->database_index = std::get<3>(*current_message_row);
   }
-  // if(++current_message_row != message_result.end()) {
-  //   throw std::runtime_error("More than one message at the same timestamp!");
-  // }
 
   return bag_message;
 }
 
 std::shared_ptr<rosbag2_storage::SerializedBagMessage>
-SqliteStorage::read_at_index(int32_t index)
+SqliteStorage::read_single_message_cached(const std::string & condition)
 {
-  std::shared_ptr<rosbag2_storage::SerializedBagMessage> bag_message;
+  // Resolve the cache key without touching the data column, so a hit never reads the blob.
+  auto key_statement = database_->prepare_statement(
+    "SELECT topic_id, id FROM messages "
+    "WHERE " + condition + " "
+    "ORDER BY messages.timestamp LIMIT 1;");
+  auto key_result = key_statement->execute_query<int, int32_t>();
+  auto key_row = key_result.begin();
+  if (key_row == key_result.end()) {
+    return nullptr;
+  }
+  const SqliteMessageCacheKey key{std::get<0>(*key_row), std::get<1>(*key_row)};
+
+  auto bag_message = message_cache_.get(key);
+  if (bag_message) {
+    return bag_message;
+  }
+
+  bag_message = read_single_message("messages.id = " + std::to_string(key.rowid));
+  if (bag_message) {
+    message_cache_.put(
+      key, std::make_shared<const rosbag2_storage::SerializedBagMessage>(*bag_message));
+  }
+  return bag_message;
+}
 
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+SqliteStorage::read_at_timestamp_range(
+  rcutils_time_point_value_t timestamp_begin,
+  rcutils_time_point_value_t timestamp_end)
+{
   auto read_statement = database_->prepare_statement(
     "SELECT data, timestamp, topics.name, messages.id "
     "FROM messages JOIN topics ON messages.topic_id = topics.id "
-    "WHERE messages.id = " + std::to_string(index) + " "
+    "WHERE messages.timestamp BETWEEN " + std::to_string(timestamp_begin) +
+    " AND " + std::to_string(timestamp_end) + " "
     "ORDER BY messages.timestamp;");
 
   auto message_result = read_statement->execute_query<
     std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t>();
 
-  // if(message_result.begin() == message_result.end()) {
-  //   throw std::runtime_error("No messages found for id " + std::to_string(index));
-  // }
+  auto bag_message_vector =
+    std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>();
 
   ModifiedReadQueryResult::Iterator current_message_row = message_result.begin();
-  if (current_message_row != message_result.end()) {  // message exists
-    bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
-    bag_message->serialized_data = std::get<0>(*current_message_row);
-    bag_message->time_stamp = std::get<1>(*current_message_row);
-    bag_message->topic_name = std::get<2>(*current_message_row);
-    bag_message->database_index = std::get<3>(*current_message_row);
+  for (; current_message_row != message_result.end(); ++current_message_row) {
+    bag_message_vector->push_back(std::make_shared<rosbag2_storage::SerializedBagMessage>());
+    bag_message_vector->back()->serialized_data = std::get<0>(*current_message_row);
+    bag_message_vector->back()->time_stamp = std::get<1>(*current_message_row);
+    bag_message_vector->back()->topic_name = std::get<2>(*current_message_row);
+    bag_message_vector->back()->database_index = std::get<3>(*current_message_row);
   }
-
-  return bag_message;
+  return bag_message_vector;
 }
 
 std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
-SqliteStorage::read_at_timestamp_range(
+SqliteStorage::read_topics_at_timestamp_range(
+  const std::vector<std::string> & topic_names,
   rcutils_time_point_value_t timestamp_begin,
   rcutils_time_point_value_t timestamp_end)
 {
+  std::string topic_condition;
+  if (!topic_names.empty()) {
+    std::string placeholders;
+    for (size_t i = 0; i < topic_names.size(); ++i) {
+      placeholders += i == 0 ? "?" : ",?";
+    }
+    topic_condition = "AND topics.name IN (" + placeholders + ") ";
+  }
   auto read_statement = database_->prepare_statement(
     "SELECT data, timestamp, topics.name, messages.id "
     "FROM messages JOIN topics ON messages.topic_id = topics.id "
-    "WHERE messages.timestamp BETWEEN " + std::to_string(timestamp_begin) +
-    " AND " + std::to_string(timestamp_end) + " "
+    "WHERE messages.timestamp BETWEEN ? AND ? " + topic_condition +
     "ORDER BY messages.timestamp;");
+  read_statement->bind(timestamp_begin, timestamp_end);
+  for (const auto & topic_name : topic_names) {
+    read_statement->bind(topic_name);
+  }
 
   auto message_result = read_statement->execute_query<
     std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t>();
 
   auto bag_message_vector =
     std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>();
-
-  ModifiedReadQueryResult::Iterator current_message_row = message_result.begin();
-  for (; current_message_row != message_result.end(); ++current_message_row) {
+  for (auto current_message_row = message_result.begin();
+    current_message_row != message_result.end(); ++current_message_row)
+  {
     bag_message_vector->push_back(std::make_shared<rosbag2_storage::SerializedBagMessage>());
     bag_message_vector->back()->serialized_data = std::get<0>(*current_message_row);
     bag_message_vector->back()->time_stamp = std::get<1>(*current_message_row);
@@ -337,6 +566,42 @@ SqliteStorage::read_at_timestamp_range(
   return bag_message_vector;
 }
 
+std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+SqliteStorage::read_closest(const std::string & topic_name, rcutils_time_point_value_t timestamp)
+{
+  // Probe topic_timestamp_idx once on each side of the timestamp.
+  const std::string query_begin =
+    "SELECT data, timestamp, topics.name, messages.id "
+    "FROM messages JOIN topics ON messages.topic_id = topics.id "
+    "WHERE messages.topic_id = (SELECT id FROM topics WHERE name = ?) ";
+  auto before_statement = database_->prepare_statement(
+    query_begin + "AND messages.timestamp <= ? ORDER BY messages.timestamp DESC LIMIT 1;");
+  auto after_statement = database_->prepare_statement(
+    query_begin + "AND messages.timestamp > ? ORDER BY messages.timestamp LIMIT 1;");
+
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> bag_message;
+  for (const auto & read_statement : {before_statement, after_statement}) {
+    read_statement->bind(topic_name, timestamp);
+    auto message_result = read_statement->execute_query<
+      std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t>();
+    ModifiedReadQueryResult::Iterator current_message_row = message_result.begin();
+    if (current_message_row == message_result.end()) {
+      continue;
+    }
+    const auto time_stamp = std::get<1>(*current_message_row);
+    // The earlier message wins a tie, so a later one has to be strictly closer.
+    if (bag_message && time_stamp - timestamp >= timestamp - bag_message->time_stamp) {
+      continue;
+    }
+    bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    bag_message->serialized_data = std::get<0>(*current_message_row);
+    bag_message->time_stamp = time_stamp;
+    bag_message->topic_name = std::get<2>(*current_message_row);
+    bag_message->database_index = std::get<3>(*current_message_row);
+  }
+  return bag_message;
+}
+
 std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
 SqliteStorage::read_at_index_range(
   int32_t index_begin,
@@ -366,6 +631,210 @@ SqliteStorage::read_at_index_range(
   return bag_message_vector;
 }
 
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+SqliteStorage::read_at_indices(const std::vector<int64_t> & indices)
+{
+  auto bag_message_vector =
+    std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>(
+    indices.size());
+  if (indices.empty()) {
+    return bag_message_vector;
+  }
+
+  // Positions in the caller's order for every requested id, duplicates included.
+  std::unordered_map<int64_t, std::vector<size_t>> positions;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    positions[indices[i]].push_back(i);
+  }
+
+  if (!read_at_indices_statement_) {
+    read_at_indices_statement_ = database_->prepare_statement(
+      "SELECT data, timestamp, topics.name, messages.id "
+      "FROM messages JOIN topics ON messages.topic_id = topics.id "
+      "WHERE messages.id IN (" + get_chunk_parameter_list() + ") "
+      "ORDER BY messages.id;");
+  }
+
+  // Chunks of ascending ids, each read in rowid order, visit the pages of the messages table
+  // sequentially.
+  const auto ids = get_sorted_keys(positions);
+  for (size_t chunk_begin = 0; chunk_begin < ids.size(); chunk_begin += READ_AT_CHUNK_SIZE) {
+    bind_chunk(*read_at_indices_statement_, ids, chunk_begin);
+    auto message_result = read_at_indices_statement_->execute_query<
+      std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t>();
+
+    ModifiedReadQueryResult::Iterator current_message_row = message_result.begin();
+    for (; current_message_row != message_result.end(); ++current_message_row) {
+      auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+      bag_message->serialized_data = std::get<0>(*current_message_row);
+      bag_message->time_stamp = std::get<1>(*current_message_row);
+      bag_message->topic_name = std::get<2>(*current_message_row);
+      bag_message->database_index = std::get<3>(*current_message_row);
+      for (auto position : positions[bag_message->database_index]) {
+        (*bag_message_vector)[position] = bag_message;
+      }
+    }
+  }
+  read_at_indices_statement_->reset();
+  return bag_message_vector;
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+SqliteStorage::read_at_timestamps(const std::vector<rcutils_time_point_value_t> & timestamps)
+{
+  auto bag_message_vector =
+    std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>(
+    timestamps.size());
+  if (timestamps.empty()) {
+    return bag_message_vector;
+  }
+
+  std::unordered_map<rcutils_time_point_value_t, std::vector<size_t>> positions;
+  for (size_t i = 0; i < timestamps.size(); ++i) {
+    positions[timestamps[i]].push_back(i);
+  }
+
+  // Only the ids are looked up, from the timestamp index, so that the data of messages sharing
+  // a timestamp with the returned one is not read.
+  if (!read_at_timestamps_statement_) {
+    read_at_timestamps_statement_ = database_->prepare_statement(
+      "SELECT timestamp, MIN(id) FROM messages "
+      "WHERE timestamp IN (" + get_chunk_parameter_list() + ") "
+      "GROUP BY timestamp;");
+  }
+
+  std::vector<int64_t> indices;
+  std::vector<const std::vector<size_t> *> index_positions;
+  const auto sorted_timestamps = get_sorted_keys(positions);
+  for (size_t chunk_begin = 0; chunk_begin < sorted_timestamps.size();
+    chunk_begin += READ_AT_CHUNK_SIZE)
+  {
+    bind_chunk(*read_at_timestamps_statement_, sorted_timestamps, chunk_begin);
+    auto id_result = read_at_timestamps_statement_->execute_query<
+      rcutils_time_point_value_t, rcutils_time_point_value_t>();
+    for (const auto & row : id_result) {
+      indices.push_back(std::get<1>(row));
+      index_positions.push_back(&positions[std::get<0>(row)]);
+    }
+  }
+  read_at_timestamps_statement_->reset();
+
+  const auto messages = read_at_indices(indices);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    for (auto position : *index_positions[i]) {
+      (*bag_message_vector)[position] = (*messages)[i];
+    }
+  }
+  return bag_message_vector;
+}
+
+std::shared_ptr<rosbag2_storage::SerializedBagMessage>
+SqliteStorage::read_by_key(const std::string & topic_name, int64_t key)
+{
+  std::shared_ptr<rosbag2_storage::SerializedBagMessage> bag_message;
+  if (!has_key_column_) {
+    return bag_message;
+  }
+
+  auto read_statement = database_->prepare_statement(
+    "SELECT data, timestamp, topics.name, messages.id "
+    "FROM messages JOIN topics ON messages.topic_id = topics.id "
+    "WHERE messages.topic_id = (SELECT id FROM topics WHERE name = ?) "
+    "AND messages.app_key = ? "
+    "ORDER BY messages.timestamp LIMIT 1;");
+  read_statement->bind(topic_name, key);
+
+  auto message_result = read_statement->execute_query<
+    std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t>();
+
+  ModifiedReadQueryResult::Iterator current_message_row = message_result.begin();
+  if (current_message_row != message_result.end()) {  // message exists
+    bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    bag_message->serialized_data = std::get<0>(*current_message_row);
+    bag_message->time_stamp = std::get<1>(*current_message_row);
+    bag_message->topic_name = std::get<2>(*current_message_row);
+    bag_message->database_index = std::get<3>(*current_message_row);
+    bag_message->has_key = true;
+    bag_message->key = key;
+  }
+
+  return bag_message;
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+SqliteStorage::read_by_key_range(
+  const std::string & topic_name, int64_t key_begin, int64_t key_end)
+{
+  auto bag_message_vector =
+    std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>();
+  if (!has_key_column_) {
+    return bag_message_vector;
+  }
+
+  auto read_statement = database_->prepare_statement(
+    "SELECT data, timestamp, topics.name, messages.id, messages.app_key "
+    "FROM messages JOIN topics ON messages.topic_id = topics.id "
+    "WHERE messages.topic_id = (SELECT id FROM topics WHERE name = ?) "
+    "AND messages.app_key BETWEEN ? AND ? "
+    "ORDER BY messages.app_key, messages.timestamp;");
+  read_statement->bind(topic_name, key_begin, key_end);
+
+  auto message_result = read_statement->execute_query<
+    std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t,
+    rcutils_time_point_value_t>();
+
+  for (auto current_message_row = message_result.begin();
+    current_message_row != message_result.end(); ++current_message_row)
+  {
+    bag_message_vector->push_back(std::make_shared<rosbag2_storage::SerializedBagMessage>());
+    bag_message_vector->back()->serialized_data = std::get<0>(*current_message_row);
+    bag_message_vector->back()->time_stamp = std::get<1>(*current_message_row);
+    bag_message_vector->back()->topic_name = std::get<2>(*current_message_row);
+    bag_message_vector->back()->database_index = std::get<3>(*current_message_row);
+    bag_message_vector->back()->has_key = true;
+    bag_message_vector->back()->key = std::get<4>(*current_message_row);
+  }
+  return bag_message_vector;
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+SqliteStorage::read_latest_before(
+  const std::vector<std::string> & topic_names, rcutils_time_point_value_t timestamp)
+{
+  auto bag_message_vector =
+    std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>();
+
+  // One probe of topic_timestamp_idx per topic instead of a scan back from the timestamp.
+  auto read_statement = database_->prepare_statement(
+    "SELECT data, timestamp, topics.name, messages.id "
+    "FROM messages JOIN topics ON messages.topic_id = topics.id "
+    "WHERE messages.topic_id = (SELECT id FROM topics WHERE name = ?) "
+    "AND messages.timestamp < ? "
+    "ORDER BY messages.timestamp DESC LIMIT 1;");
+  for (const auto & topic_name : topic_names) {
+    read_statement->bind(topic_name, timestamp);
+    auto message_result = read_statement->execute_query<
+      std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t>();
+    ModifiedReadQueryResult::Iterator current_message_row = message_result.begin();
+    if (current_message_row != message_result.end()) {  // message exists
+      bag_message_vector->push_back(std::make_shared<rosbag2_storage::SerializedBagMessage>());
+      bag_message_vector->back()->serialized_data = std::get<0>(*current_message_row);
+      bag_message_vector->back()->time_stamp = std::get<1>(*current_message_row);
+      bag_message_vector->back()->topic_name = std::get<2>(*current_message_row);
+      bag_message_vector->back()->database_index = std::get<3>(*current_message_row);
+    }
+    read_statement->reset();
+  }
+
+  std::stable_sort(
+    bag_message_vector->begin(), bag_message_vector->end(),
+    [](const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & lhs,
+    const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & rhs) {
+      return lhs->time_stamp < rhs->time_stamp;
+    });
+  return bag_message_vector;
+}
+
 std::vector<rosbag2_storage::TopicMetadata> SqliteStorage::get_all_topics_and_types()
 {
   if (all_topics_and_types_.empty()) {
@@ -379,7 +848,14 @@ uint64_t SqliteStorage::get_bagfile_size() const
 {
   const auto bag_path = rcpputils::fs::path{get_relative_file_path()};
 
-  return bag_path.exists() ? bag_path.file_size() : 0u;
+  const uint64_t bagfile_size = bag_path.exists() ? bag_path.file_size() : 0u;
+  bagfile_size_estimate_ = bagfile_size;
+  return bagfile_size;
+}
+
+uint64_t SqliteStorage::get_bagfile_size_estimate() const
+{
+  return bagfile_size_estimate_;
 }
 
 void SqliteStorage::initialize()
@@ -395,10 +871,49 @@ void SqliteStorage::initialize()
     "id INTEGER PRIMARY KEY," \
     "topic_id INTEGER NOT NULL," \
     "timestamp INTEGER NOT NULL, " \
-    "data BLOB NOT NULL);";
+    "data BLOB NOT NULL, " \
+    "app_key INTEGER);";
   database_->prepare_statement(create_stmt)->execute_and_reset();
   create_stmt = "CREATE INDEX timestamp_idx ON messages (timestamp ASC);";
   database_->prepare_statement(create_stmt)->execute_and_reset();
+  create_stmt = "CREATE INDEX app_key_idx ON messages (topic_id, app_key) " \
+    "WHERE app_key IS NOT NULL;";
+  database_->prepare_statement(create_stmt)->execute_and_reset();
+  create_stmt = "CREATE INDEX topic_timestamp_idx ON messages (topic_id, timestamp);";
+  database_->prepare_statement(create_stmt)->execute_and_reset();
+  has_key_column_ = true;
+}
+
+void SqliteStorage::upgrade_schema(rosbag2_storage::storage_interfaces::IOFlag io_flag)
+{
+  // Databases written before application keys were introduced lack the column.
+  has_key_column_ = false;
+  bool has_messages_table = false;
+  auto statement = database_->prepare_statement("PRAGMA table_info(messages);");
+  auto columns = statement->execute_query<int, std::string>();
+  for (auto column : columns) {
+    has_messages_table = true;
+    if (std::get<1>(column) == "app_key") {
+      has_key_column_ = true;
+    }
+  }
+
+  if (has_messages_table && !has_key_column_ && !is_read_only(io_flag)) {
+    database_->prepare_statement("ALTER TABLE messages ADD COLUMN app_key INTEGER;")
+    ->execute_and_reset();
+    database_->prepare_statement(
+      "CREATE INDEX IF NOT EXISTS app_key_idx ON messages (topic_id, app_key) "
+      "WHERE app_key IS NOT NULL;")
+    ->execute_and_reset();
+    has_key_column_ = true;
+  }
+  // Older databases only index by timestamp; read_latest_before still works on
+  // them but has to scan.
+  if (has_messages_table && !is_read_only(io_flag)) {
+    database_->prepare_statement(
+      "CREATE INDEX IF NOT EXISTS topic_timestamp_idx ON messages (topic_id, timestamp);")
+    ->execute_and_reset();
+  }
 }
 
 void SqliteStorage::create_topic(const rosbag2_storage::TopicMetadata & topic)
@@ -411,13 +926,22 @@ void SqliteStorage::create_topic(const rosbag2_storage::TopicMetadata & topic)
     insert_topic->bind(
       topic.name, topic.type, topic.serialization_format, topic.offered_qos_profiles);
     insert_topic->execute_and_reset();
-    topics_.emplace(topic.name, static_cast<int>(database_->get_last_insert_id()));
+    const auto topic_id = static_cast<int>(database_->get_last_insert_id());
+    topics_.emplace(topic.name, topic_id);
+    if (created_topic_ids_.size() <= static_cast<size_t>(topic_id)) {
+      created_topic_ids_.resize(topic_id + 1, false);
+    }
+    created_topic_ids_[topic_id] = true;
   }
 }
 
 void SqliteStorage::remove_topic(const rosbag2_storage::TopicMetadata & topic)
 {
-  if (topics_.find(topic.name) != std::end(topics_)) {
+  auto topic_entry = topics_.find(topic.name);
+  if (topic_entry != std::end(topics_)) {
+    if (static_cast<size_t>(topic_entry->second) < created_topic_ids_.size()) {
+      created_topic_ids_[topic_entry->second] = false;
+    }
     auto delete_topic =
       database_->prepare_statement(
       "DELETE FROM topics where name = ? and type = ? and serialization_format = ?");
@@ -430,11 +954,16 @@ void SqliteStorage::remove_topic(const rosbag2_storage::TopicMetadata & topic)
 void SqliteStorage::prepare_for_writing()
 {
   write_statement_ = database_->prepare_statement(
-    "INSERT INTO messages (timestamp, topic_id, data) VALUES (?, ?, ?);");
+    "INSERT INTO messages (timestamp, topic_id, data, app_key) VALUES (?, ?, ?, ?);");
 }
 
 void SqliteStorage::prepare_for_reading()
 {
+  std::string seek_condition{""};
+  if (seek_time_ != std::numeric_limits<rcutils_time_point_value_t>::min()) {
+    seek_condition = "messages.timestamp >= " + std::to_string(seek_time_) + " ";
+  }
+
   if (!storage_filter_.topics.empty()) {
     // Construct string for selected topics
     std::string topic_list{""};
@@ -448,12 +977,14 @@ void SqliteStorage::prepare_for_reading()
     read_statement_ = database_->prepare_statement(
       "SELECT data, timestamp, topics.name "
       "FROM messages JOIN topics ON messages.topic_id = topics.id "
-      "WHERE topics.name IN (" + topic_list + ")"
+      "WHERE topics.name IN (" + topic_list + ")" +
+      (seek_condition.empty() ? "" : " AND " + seek_condition) +
       "ORDER BY messages.timestamp;");
   } else {
     read_statement_ = database_->prepare_statement(
       "SELECT data, timestamp, topics.name "
-      "FROM messages JOIN topics ON messages.topic_id = topics.id "
+      "FROM messages JOIN topics ON messages.topic_id = topics.id " +
+      (seek_condition.empty() ? "" : "WHERE " + seek_condition) +
       "ORDER BY messages.timestamp;");
   }
   message_result_ = read_statement_->execute_query<
@@ -498,14 +1029,15 @@ rosbag2_storage::BagMetadata SqliteStorage::get_metadata()
   metadata.message_count = 0;
   metadata.topics_with_message_count = {};
 
+  // The length of a blob is stored in the row header, so summing it does not read the data.
   auto statement = database_->prepare_statement(
     "SELECT name, type, serialization_format, COUNT(messages.id), MIN(messages.timestamp), "
-    "MAX(messages.timestamp) "
+    "MAX(messages.timestamp), SUM(LENGTH(messages.data)) "
     "FROM messages JOIN topics on topics.id = messages.topic_id "
     "GROUP BY topics.name;");
   auto query_results = statement->execute_query<
     std::string, std::string, std::string, int, rcutils_time_point_value_t,
-    rcutils_time_point_value_t>();
+    rcutils_time_point_value_t, rcutils_time_point_value_t>();
 
   rcutils_time_point_value_t min_time = INT64_MAX;
   rcutils_time_point_value_t max_time = 0;
@@ -515,6 +1047,13 @@ rosbag2_storage::BagMetadata SqliteStorage::get_metadata()
         {std::get<0>(result), std::get<1>(result), std::get<2>(result), ""},
         static_cast<size_t>(std::get<3>(result))
       });
+    auto & topic_information = metadata.topics_with_message_count.back();
+    topic_information.total_bytes = static_cast<uint64_t>(std::get<6>(result));
+    topic_information.starting_time =
+      std::chrono::time_point<std::chrono::high_resolution_clock>(
+      std::chrono::nanoseconds(std::get<4>(result)));
+    topic_information.duration =
+      std::chrono::nanoseconds(std::get<5>(result) - std::get<4>(result));
 
     metadata.message_count += std::get<3>(result);
     min_time = std::get<4>(result) < min_time ? std::get<4>(result) : min_time;
@@ -534,6 +1073,50 @@ rosbag2_storage::BagMetadata SqliteStorage::get_metadata()
   return metadata;
 }
 
+void SqliteStorage::set_read_cache_size(uint64_t max_cache_bytes)
+{
+  message_cache_.set_max_cache_bytes(max_cache_bytes);
+}
+
+size_t SqliteStorage::prefetch_index_range(int32_t index_begin, int32_t index_end)
+{
+  if (message_cache_.get_max_cache_bytes() == 0) {
+    return 0;
+  }
+
+  auto read_statement = database_->prepare_statement(
+    "SELECT data, timestamp, topics.name, messages.id, messages.topic_id "
+    "FROM messages JOIN topics ON messages.topic_id = topics.id "
+    "WHERE messages.id BETWEEN " + std::to_string(index_begin) +
+    " AND " + std::to_string(index_end) + " "
+    "ORDER BY messages.id;");
+
+  auto message_result = read_statement->execute_query<
+    std::shared_ptr<rcutils_uint8_array_t>, rcutils_time_point_value_t, std::string, int32_t,
+    int>();
+
+  size_t cached_messages = 0;
+  for (auto current_message_row = message_result.begin();
+    current_message_row != message_result.end(); ++current_message_row)
+  {
+    auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    bag_message->serialized_data = std::get<0>(*current_message_row);
+    bag_message->time_stamp = std::get<1>(*current_message_row);
+    bag_message->topic_name = std::get<2>(*current_message_row);
+    bag_message->database_index = std::get<3>(*current_message_row);
+    const SqliteMessageCacheKey key{std::get<4>(*current_message_row), bag_message->database_index};
+    if (message_cache_.put(key, bag_message)) {
+      ++cached_messages;
+    }
+  }
+  return cached_messages;
+}
+
+rosbag2_storage::ReadCacheStatistics SqliteStorage::get_read_cache_statistics() const
+{
+  return message_cache_.get_statistics();
+}
+
 void SqliteStorage::set_filter(
   const rosbag2_storage::StorageFilter & storage_filter)
 {
@@ -27,6 +27,36 @@
 
 #include "../logging.hpp"
 
+namespace
+{
+// Memory map up to this many bytes of immutable databases instead of copying pages into the
+// page cache of every reading process.
+constexpr int64_t IMMUTABLE_MMAP_SIZE = 1ll << 30;
+
+// Immutable databases can only be requested through a URI filename, in which the path has to be
+// escaped.
+std::string to_immutable_uri(const std::string & path)
+{
+  std::string uri = "file:";
+  for (const auto character : path) {
+    switch (character) {
+      case '%':
+        uri += "%25";
+        break;
+      case '?':
+        uri += "%3f";
+        break;
+      case '#':
+        uri += "%23";
+        break;
+      default:
+        uri += character;
+    }
+  }
+  return uri + "?immutable=1";
+}
+}  // namespace
+
 namespace rosbag2_storage_plugins
 {
 
@@ -47,7 +77,25 @@ SqliteWrapper::SqliteWrapper(
       throw SqliteException{errmsg.str()};
     }
     // throws an exception if the database is not valid.
-    prepare_statement("PRAGMA schema_version;")->execute_and_reset();
+    check_schema_version();
+  } else if (io_flag == rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY_IMMUTABLE) {
+    // An immutable database is read without any locking and without the shared memory
+    // file, which lets many processes read the same finished bag without contention.
+    int rc = sqlite3_open_v2(
+      to_immutable_uri(uri).c_str(), &db_ptr,
+      SQLITE_OPEN_READONLY | SQLITE_OPEN_URI | SQLITE_OPEN_NOMUTEX, nullptr);
+    if (rc != SQLITE_OK) {
+      std::stringstream errmsg;
+      errmsg << "Could not immutable open database. SQLite error (" <<
+        rc << "): " << sqlite3_errstr(rc) << ". Extended error code: " <<
+        sqlite3_extended_errcode(db_ptr);
+      throw SqliteException{errmsg.str()};
+    }
+    // throws an exception if the database is not valid.
+    check_schema_version();
+    prepare_statement("PRAGMA query_only = ON;")->execute_and_reset();
+    prepare_statement(
+      "PRAGMA mmap_size = " + std::to_string(IMMUTABLE_MMAP_SIZE) + ";")->execute_and_reset();
   } else {
     int rc = sqlite3_open_v2(
       uri.c_str(), &db_ptr,
@@ -61,6 +109,7 @@ SqliteWrapper::SqliteWrapper(
     }
     prepare_statement("PRAGMA journal_mode = WAL;")->execute_and_reset();
     prepare_statement("PRAGMA synchronous = NORMAL;")->execute_and_reset();
+    checkpoint_on_close_ = true;
   }
 
   sqlite3_extended_result_codes(db_ptr, 1);
@@ -69,8 +118,25 @@ SqliteWrapper::SqliteWrapper(
 SqliteWrapper::SqliteWrapper()
 : db_ptr(nullptr) {}
 
+void SqliteWrapper::check_schema_version()
+{
+  try {
+    prepare_statement("PRAGMA schema_version;")->execute_and_reset();
+  } catch (const SqliteException &) {
+    // The destructor does not run for a wrapper failing to construct.
+    sqlite3_close(db_ptr);
+    db_ptr = nullptr;
+    throw;
+  }
+}
+
 SqliteWrapper::~SqliteWrapper()
 {
+  if (checkpoint_on_close_ && db_ptr != nullptr) {
+    // Move all committed data into the database file, even if other connections keep the
+    // write-ahead log open. Immutable readers of the file ignore the log.
+    sqlite3_wal_checkpoint_v2(db_ptr, nullptr, SQLITE_CHECKPOINT_TRUNCATE, nullptr, nullptr);
+  }
   const int rc = sqlite3_close(db_ptr);
   if (rc != SQLITE_OK) {
     ROSBAG2_STORAGE_DEFAULT_PLUGINS_LOG_ERROR_STREAM(
@@ -0,0 +1,131 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rosbag2_storage/ros_helper.hpp"
+
+#include "rosbag2_storage_default_plugins/sqlite/sqlite_message_cache.hpp"
+
+using namespace ::testing;  // NOLINT
+using rosbag2_storage_plugins::SqliteMessageCache;
+using rosbag2_storage_plugins::SqliteMessageCacheKey;
+
+namespace
+{
+std::shared_ptr<rosbag2_storage::SerializedBagMessage> make_message(size_t size, int32_t rowid)
+{
+  std::vector<uint8_t> payload(size, 0x42);
+  auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  message->serialized_data = rosbag2_storage::make_serialized_message(payload.data(), size);
+  message->time_stamp = rowid;
+  message->topic_name = "topic";
+  message->database_index = rowid;
+  return message;
+}
+}  // namespace
+
+TEST(SqliteMessageCacheTest, get_counts_hits_and_misses) {
+  SqliteMessageCache cache(100);
+
+  EXPECT_THAT(cache.get({1, 1}), IsNull());
+  ASSERT_TRUE(cache.put({1, 1}, make_message(10, 1)));
+
+  auto message = cache.get({1, 1});
+  ASSERT_THAT(message, NotNull());
+  EXPECT_THAT(message->database_index, Eq(1));
+  EXPECT_THAT(cache.get({2, 1}), IsNull());
+
+  auto statistics = cache.get_statistics();
+  EXPECT_THAT(statistics.hits, Eq(1u));
+  EXPECT_THAT(statistics.misses, Eq(2u));
+  EXPECT_THAT(statistics.cached_messages, Eq(1u));
+  EXPECT_THAT(statistics.cached_bytes, Eq(10u));
+}
+
+TEST(SqliteMessageCacheTest, least_recently_used_entry_is_evicted_first) {
+  SqliteMessageCache cache(30);
+
+  cache.put({1, 1}, make_message(10, 1));
+  cache.put({1, 2}, make_message(10, 2));
+  cache.put({1, 3}, make_message(10, 3));
+  cache.get({1, 1});  // refresh the oldest entry
+  cache.put({1, 4}, make_message(10, 4));
+
+  EXPECT_TRUE(cache.contains({1, 1}));
+  EXPECT_FALSE(cache.contains({1, 2}));
+  EXPECT_TRUE(cache.contains({1, 3}));
+  EXPECT_TRUE(cache.contains({1, 4}));
+  EXPECT_THAT(cache.get_statistics().cached_bytes, Eq(30u));
+}
+
+TEST(SqliteMessageCacheTest, messages_larger_than_the_budget_are_not_cached) {
+  SqliteMessageCache cache(30);
+  cache.put({1, 1}, make_message(10, 1));
+
+  EXPECT_FALSE(cache.put({1, 2}, make_message(31, 2)));
+  EXPECT_TRUE(cache.contains({1, 1}));
+  EXPECT_THAT(cache.get_statistics().cached_bytes, Eq(10u));
+}
+
+TEST(SqliteMessageCacheTest, shrinking_the_budget_evicts_entries) {
+  SqliteMessageCache cache(30);
+  cache.put({1, 1}, make_message(10, 1));
+  cache.put({1, 2}, make_message(10, 2));
+
+  cache.set_max_cache_bytes(10);
+
+  EXPECT_FALSE(cache.contains({1, 1}));
+  EXPECT_TRUE(cache.contains({1, 2}));
+
+  cache.set_max_cache_bytes(0);
+  EXPECT_THAT(cache.get_statistics().cached_messages, Eq(0u));
+}
+
+TEST(SqliteMessageCacheTest, returned_messages_do_not_alias_cached_entries) {
+  SqliteMessageCache cache(30);
+  cache.put({1, 1}, make_message(10, 1));
+
+  cache.get({1, 1})->topic_name = "modified";
+
+  EXPECT_THAT(cache.get({1, 1})->topic_name, Eq("topic"));
+}
+
+TEST(SqliteMessageCacheTest, concurrent_access_keeps_byte_accounting_consistent) {
+  SqliteMessageCache cache(1000);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back(
+      [&cache, t]() {
+        for (int32_t i = 0; i < 500; ++i) {
+          cache.put({t, i}, make_message(10, i));
+          cache.get({t, i / 2});
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  auto statistics = cache.get_statistics();
+  EXPECT_THAT(statistics.hits + statistics.misses, Eq(2000u));
+  EXPECT_THAT(statistics.cached_bytes, Eq(statistics.cached_messages * 10));
+  EXPECT_THAT(statistics.cached_bytes, Le(1000u));
+}
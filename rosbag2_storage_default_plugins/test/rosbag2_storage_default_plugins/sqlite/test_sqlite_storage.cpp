@@ -14,6 +14,7 @@
 
 #include <gmock/gmock.h>
 
+#include <limits>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -24,6 +25,7 @@
 
 #include "rcutils/snprintf.h"
 
+#include "rosbag2_storage/message_batch.hpp"
 #include "rosbag2_storage/storage_filter.hpp"
 
 #include "storage_test_fixture.hpp"
@@ -113,6 +115,41 @@ TEST_F(StorageTestFixture, get_next_returns_messages_in_timestamp_order) {
   EXPECT_FALSE(readable_storage->has_next());
 }
 
+TEST_F(StorageTestFixture, read_next_batch_continues_where_read_next_stopped) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("first message", 2, "topic1", "", ""),
+    std::make_tuple("second message", 4, "topic2", "", ""),
+    std::make_tuple("third message", 6, "topic1", "", ""),
+    std::make_tuple("fourth message", 8, "topic1", "", "")};
+
+  write_messages_to_sqlite(string_messages);
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+
+  auto db_filename = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_filename);
+
+  EXPECT_THAT(readable_storage->read_next()->time_stamp, Eq(2));
+
+  auto batch = std::make_shared<rosbag2_storage::MessageBatch>();
+  readable_storage->read_next_batch(*batch, 2, std::numeric_limits<uint64_t>::max());
+  ASSERT_THAT(batch->size(), Eq(2u));
+  EXPECT_THAT(batch->get_topic_names(), ElementsAre("topic2", "topic1"));
+  EXPECT_THAT(batch->get_records()[0].topic_id, Eq(0u));
+  EXPECT_THAT(batch->get_records()[0].time_stamp, Eq(4));
+  EXPECT_THAT(batch->get_records()[1].topic_id, Eq(1u));
+  EXPECT_THAT(batch->get_records()[1].time_stamp, Eq(6));
+  auto message = batch->get_message(1);
+  EXPECT_THAT(message->topic_name, Eq("topic1"));
+  EXPECT_THAT(deserialize_message(message->serialized_data), Eq("third message"));
+
+  EXPECT_TRUE(readable_storage->has_next());
+  EXPECT_THAT(readable_storage->read_next()->time_stamp, Eq(8));
+  readable_storage->read_next_batch(*batch, 10, std::numeric_limits<uint64_t>::max());
+  EXPECT_THAT(batch->size(), Eq(2u));
+}
+
 TEST_F(StorageTestFixture, read_next_returns_filtered_messages) {
   std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
   string_messages =
@@ -223,6 +260,17 @@ TEST_F(StorageTestFixture, get_metadata_returns_correct_struct) {
       std::chrono::time_point<std::chrono::high_resolution_clock>(std::chrono::seconds(1))
   ));
   EXPECT_THAT(metadata.duration, Eq(std::chrono::seconds(2)));
+
+  const auto & first_topic = metadata.topics_with_message_count[0];
+  EXPECT_THAT(
+    first_topic.starting_time, Eq(
+      std::chrono::time_point<std::chrono::high_resolution_clock>(std::chrono::seconds(1))));
+  EXPECT_THAT(first_topic.duration, Eq(std::chrono::seconds(1)));
+  EXPECT_THAT(
+    first_topic.total_bytes,
+    Eq(
+      make_serialized_message(string_messages[0])->buffer_length +
+      make_serialized_message(string_messages[1])->buffer_length));
 }
 
 TEST_F(StorageTestFixture, get_metadata_returns_correct_struct_if_no_messages) {
@@ -305,3 +353,389 @@ TEST_F(StorageTestFixture, get_relative_file_path_returns_db_name_with_ext) {
   //   rosbag2_storage::storage_interfaces::IOFlag::APPEND);
   // EXPECT_EQ(append_storage->get_relative_file_path(), storage_filename);
 }
+
+TEST_F(StorageTestFixture, read_cache_serves_repeated_random_access_reads) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("first message", 1, "topic1", "", ""),
+    std::make_tuple("second message", 2, "topic1", "", ""),
+    std::make_tuple("third message", 3, "topic2", "", "")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+  readable_storage->set_read_cache_size(1024);
+
+  auto first_read = readable_storage->read_at_index(2);
+  auto second_read = readable_storage->read_at_timestamp(2);
+  ASSERT_THAT(first_read, NotNull());
+  ASSERT_THAT(second_read, NotNull());
+  EXPECT_THAT(deserialize_message(second_read->serialized_data), Eq("second message"));
+  EXPECT_THAT(second_read->topic_name, Eq("topic1"));
+  EXPECT_THAT(second_read->database_index, Eq(2));
+  EXPECT_THAT(readable_storage->read_at_index(42), IsNull());
+
+  auto statistics = readable_storage->get_read_cache_statistics();
+  EXPECT_THAT(statistics.hits, Eq(1u));
+  EXPECT_THAT(statistics.misses, Eq(1u));
+  EXPECT_THAT(statistics.cached_messages, Eq(1u));
+}
+
+TEST_F(StorageTestFixture, prefetch_index_range_fills_the_read_cache) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("first message", 1, "topic1", "", ""),
+    std::make_tuple("second message", 2, "topic1", "", ""),
+    std::make_tuple("third message", 3, "topic1", "", "")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+
+  EXPECT_THAT(readable_storage->prefetch_index_range(1, 3), Eq(0u));
+
+  readable_storage->set_read_cache_size(1024);
+  EXPECT_THAT(readable_storage->prefetch_index_range(2, 3), Eq(2u));
+  for (int32_t index = 1; index <= 3; ++index) {
+    auto message = readable_storage->read_at_index(index);
+    ASSERT_THAT(message, NotNull());
+    EXPECT_THAT(message->time_stamp, Eq(index));
+  }
+
+  auto statistics = readable_storage->get_read_cache_statistics();
+  EXPECT_THAT(statistics.hits, Eq(2u));
+  EXPECT_THAT(statistics.misses, Eq(1u));
+  EXPECT_THAT(statistics.cached_messages, Eq(3u));
+}
+
+TEST_F(StorageTestFixture, read_at_indices_returns_messages_in_requested_order) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("first message", 10, "topic1", "", ""),
+    std::make_tuple("second message", 20, "topic1", "", ""),
+    std::make_tuple("third message", 30, "topic2", "", "")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+
+  auto read_messages = readable_storage->read_at_indices({3, 42, 1, 3});
+
+  ASSERT_THAT(*read_messages, SizeIs(4));
+  ASSERT_THAT((*read_messages)[0], NotNull());
+  EXPECT_THAT(deserialize_message((*read_messages)[0]->serialized_data), Eq("third message"));
+  EXPECT_THAT((*read_messages)[0]->topic_name, Eq("topic2"));
+  EXPECT_THAT((*read_messages)[1], IsNull());
+  ASSERT_THAT((*read_messages)[2], NotNull());
+  EXPECT_THAT((*read_messages)[2]->database_index, Eq(1));
+  ASSERT_THAT((*read_messages)[3], NotNull());
+  EXPECT_THAT((*read_messages)[3]->time_stamp, Eq(30));
+
+  EXPECT_THAT(*readable_storage->read_at_indices({}), IsEmpty());
+}
+
+TEST_F(StorageTestFixture, read_at_timestamps_returns_messages_in_requested_order) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("first message", 10, "topic1", "", ""),
+    std::make_tuple("second message", 20, "topic1", "", ""),
+    std::make_tuple("third message", 20, "topic2", "", "")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+
+  auto read_messages = readable_storage->read_at_timestamps({20, 15, 10});
+
+  ASSERT_THAT(*read_messages, SizeIs(3));
+  ASSERT_THAT((*read_messages)[0], NotNull());
+  EXPECT_THAT(deserialize_message((*read_messages)[0]->serialized_data), Eq("second message"));
+  EXPECT_THAT((*read_messages)[0]->database_index, Eq(2));
+  EXPECT_THAT((*read_messages)[1], IsNull());
+  ASSERT_THAT((*read_messages)[2], NotNull());
+  EXPECT_THAT((*read_messages)[2]->database_index, Eq(1));
+}
+
+TEST_F(StorageTestFixture, read_at_indices_and_timestamps_read_any_number_of_messages) {
+  const int64_t message_count = 200;
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages;
+  for (int64_t i = 1; i <= message_count; ++i) {
+    string_messages.push_back(std::make_tuple("message", i * 10, "topic1", "", ""));
+  }
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+
+  std::vector<int64_t> indices;
+  std::vector<rcutils_time_point_value_t> timestamps;
+  for (int64_t i = message_count; i > 0; --i) {
+    indices.push_back(i);
+    timestamps.push_back(i * 10);
+  }
+  const auto messages_at_indices = readable_storage->read_at_indices(indices);
+  const auto messages_at_timestamps = readable_storage->read_at_timestamps(timestamps);
+
+  ASSERT_THAT(*messages_at_indices, SizeIs(message_count));
+  ASSERT_THAT(*messages_at_timestamps, SizeIs(message_count));
+  for (size_t i = 0; i < indices.size(); ++i) {
+    ASSERT_THAT((*messages_at_indices)[i], NotNull());
+    EXPECT_THAT((*messages_at_indices)[i]->database_index, Eq(indices[i]));
+    ASSERT_THAT((*messages_at_timestamps)[i], NotNull());
+    EXPECT_THAT((*messages_at_timestamps)[i]->time_stamp, Eq(timestamps[i]));
+  }
+}
+
+TEST_F(StorageTestFixture, messages_can_be_read_back_by_application_key) {
+  auto writable_storage = std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag").string();
+  writable_storage->open(db_file);
+  writable_storage->create_topic({"vertices", "type", "rmw", ""});
+  writable_storage->create_topic({"other", "type", "rmw", ""});
+
+  const std::vector<std::tuple<std::string, std::string, int64_t>> keyed_messages = {
+    std::make_tuple("vertices", "vertex 7", 7),
+    std::make_tuple("vertices", "vertex 3", 3),
+    std::make_tuple("other", "other 3", 3),
+    std::make_tuple("vertices", "vertex 5", 5)};
+  int64_t timestamp = 0;
+  for (const auto & keyed_message : keyed_messages) {
+    auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    bag_message->serialized_data = make_serialized_message(std::get<1>(keyed_message));
+    bag_message->time_stamp = ++timestamp;
+    bag_message->topic_name = std::get<0>(keyed_message);
+    bag_message->has_key = true;
+    bag_message->key = std::get<2>(keyed_message);
+    writable_storage->write(bag_message);
+  }
+  auto unkeyed_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  unkeyed_message->serialized_data = make_serialized_message("no key");
+  unkeyed_message->time_stamp = ++timestamp;
+  unkeyed_message->topic_name = "vertices";
+  writable_storage->write(unkeyed_message);
+  writable_storage.reset();
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  readable_storage->open(db_file + ".db3", rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+
+  auto vertex = readable_storage->read_by_key("vertices", 3);
+  ASSERT_THAT(vertex, NotNull());
+  EXPECT_THAT(deserialize_message(vertex->serialized_data), Eq("vertex 3"));
+  EXPECT_TRUE(vertex->has_key);
+  EXPECT_THAT(vertex->key, Eq(3));
+  EXPECT_THAT(readable_storage->read_by_key("vertices", 4), IsNull());
+
+  auto vertices = readable_storage->read_by_key_range("vertices", 4, 10);
+  ASSERT_THAT(*vertices, SizeIs(2));
+  EXPECT_THAT(deserialize_message((*vertices)[0]->serialized_data), Eq("vertex 5"));
+  EXPECT_THAT((*vertices)[1]->key, Eq(7));
+
+  EXPECT_THAT(readable_storage->read_at_index(5)->has_key, Eq(false));
+}
+
+TEST_F(StorageTestFixture, write_and_get_ids_returns_ids_in_message_order) {
+  auto writable_storage = std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag").string();
+  writable_storage->open(db_file);
+  writable_storage->create_topic({"topic", "type", "rmw", ""});
+
+  std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> messages;
+  for (int64_t timestamp = 3; timestamp > 0; --timestamp) {
+    auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    bag_message->serialized_data = make_serialized_message("message");
+    bag_message->time_stamp = timestamp;
+    bag_message->topic_name = "topic";
+    messages.push_back(bag_message);
+  }
+
+  EXPECT_THAT(writable_storage->write_and_get_ids(messages), ElementsAre(1, 2, 3));
+  EXPECT_THAT(writable_storage->read_at_index(3)->time_stamp, Eq(1));
+}
+
+TEST_F(StorageTestFixture, messages_carrying_a_topic_id_are_written_on_that_topic) {
+  auto writable_storage = std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag").string();
+  writable_storage->open(db_file);
+  writable_storage->create_topic({"topic1", "type1", "rmw", ""});
+  writable_storage->create_topic({"topic2", "type2", "rmw", ""});
+  EXPECT_THROW(writable_storage->get_topic_id("topic3"), std::runtime_error);
+
+  auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+  bag_message->serialized_data = make_serialized_message("message");
+  bag_message->time_stamp = 1;
+  bag_message->topic_id = writable_storage->get_topic_id("topic2");
+  writable_storage->write(bag_message);
+
+  bag_message->topic_id = 42;
+  EXPECT_THROW(writable_storage->write(bag_message), std::runtime_error);
+  writable_storage->remove_topic({"topic1", "type1", "rmw", ""});
+  bag_message->topic_id = 1;
+  EXPECT_THROW(writable_storage->write(bag_message), std::runtime_error);
+
+  const auto read_message = writable_storage->read_at_index(1);
+  ASSERT_THAT(read_message, NotNull());
+  EXPECT_THAT(read_message->topic_name, Eq("topic2"));
+}
+
+TEST_F(StorageTestFixture, bagfile_size_estimate_tracks_committed_messages) {
+  auto writable_storage = std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag").string();
+  writable_storage->open(db_file);
+  writable_storage->create_topic({"topic", "type", "rmw", ""});
+
+  const auto initial_estimate = writable_storage->get_bagfile_size_estimate();
+  EXPECT_THAT(initial_estimate, Eq(writable_storage->get_bagfile_size()));
+
+  std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> messages;
+  uint64_t payload_bytes = 0;
+  for (int64_t timestamp = 1; timestamp <= 3; ++timestamp) {
+    auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    bag_message->serialized_data = make_serialized_message(std::string(1000, 'x'));
+    bag_message->time_stamp = timestamp;
+    bag_message->topic_name = "topic";
+    payload_bytes += bag_message->serialized_data->buffer_length;
+    messages.push_back(bag_message);
+  }
+  writable_storage->write(messages);
+  EXPECT_THAT(writable_storage->get_bagfile_size_estimate(), Gt(initial_estimate + payload_bytes));
+
+  // Querying the real size reconciles the estimate with it.
+  const auto bagfile_size = writable_storage->get_bagfile_size();
+  EXPECT_THAT(writable_storage->get_bagfile_size_estimate(), Eq(bagfile_size));
+}
+
+TEST_F(StorageTestFixture, bagfile_size_estimate_accounts_for_per_message_overhead) {
+  auto writable_storage = std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag").string();
+  writable_storage->open(db_file);
+  writable_storage->create_topic({"topic", "type", "rmw", ""});
+  const auto initial_size = writable_storage->get_bagfile_size();
+
+  // With small messages the database grows mostly by its rows and index entries.
+  std::vector<std::shared_ptr<const rosbag2_storage::SerializedBagMessage>> messages;
+  for (int64_t timestamp = 1; timestamp <= 5000; ++timestamp) {
+    auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    bag_message->serialized_data = make_serialized_message("x");
+    bag_message->time_stamp = timestamp;
+    bag_message->topic_name = "topic";
+    messages.push_back(bag_message);
+  }
+  writable_storage->write(messages);
+
+  const auto estimated_growth = writable_storage->get_bagfile_size_estimate() - initial_size;
+  // Closing the storage checkpoints the write-ahead log into the database file.
+  writable_storage.reset();
+  const auto real_growth = rcpputils::fs::path(db_file + ".db3").file_size() - initial_size;
+  EXPECT_THAT(estimated_growth, Gt(real_growth * 3 / 4));
+  EXPECT_THAT(estimated_growth, Lt(real_growth * 5 / 4));
+}
+
+TEST_F(StorageTestFixture, read_latest_before_returns_last_message_per_topic) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("map 1", 1, "map", "", ""),
+    std::make_tuple("pose 2", 2, "pose", "", ""),
+    std::make_tuple("pose 4", 4, "pose", "", ""),
+    std::make_tuple("map 6", 6, "map", "", ""),
+    std::make_tuple("pose 8", 8, "pose", "", "")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+
+  auto snapshot = readable_storage->read_latest_before({"pose", "map", "unknown"}, 6);
+
+  ASSERT_THAT(*snapshot, SizeIs(2));
+  EXPECT_THAT(deserialize_message((*snapshot)[0]->serialized_data), Eq("map 1"));
+  EXPECT_THAT((*snapshot)[0]->topic_name, Eq("map"));
+  EXPECT_THAT(deserialize_message((*snapshot)[1]->serialized_data), Eq("pose 4"));
+  EXPECT_THAT((*snapshot)[1]->time_stamp, Eq(4));
+
+  EXPECT_THAT(*readable_storage->read_latest_before({"pose"}, 2), SizeIs(0));
+}
+
+TEST_F(StorageTestFixture, immutable_storage_reads_written_messages) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("first message", 1, "topic1", "type1", "rmw1"),
+    std::make_tuple("second message", 2, "topic2", "type2", "rmw2")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(
+    db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY_IMMUTABLE);
+
+  ASSERT_TRUE(readable_storage->has_next());
+  EXPECT_THAT(
+    deserialize_message(readable_storage->read_next()->serialized_data), Eq("first message"));
+  EXPECT_THAT(readable_storage->get_all_topics_and_types(), SizeIs(2));
+  EXPECT_FALSE(rcpputils::fs::path(db_file + "-shm").exists());
+}
+
+TEST_F(StorageTestFixture, seek_restarts_sequential_reading_at_timestamp) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("first message", 1, "topic1", "", ""),
+    std::make_tuple("second message", 2, "topic2", "", ""),
+    std::make_tuple("third message", 3, "topic1", "", "")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+  readable_storage->set_filter({{"topic1"}});
+
+  readable_storage->seek(2);
+  ASSERT_TRUE(readable_storage->has_next());
+  EXPECT_THAT(readable_storage->read_next()->time_stamp, Eq(3));
+  EXPECT_FALSE(readable_storage->has_next());
+
+  readable_storage->seek(0);
+  ASSERT_TRUE(readable_storage->has_next());
+  EXPECT_THAT(readable_storage->read_next()->time_stamp, Eq(1));
+}
+
+TEST_F(StorageTestFixture, read_topics_at_timestamp_range_and_read_closest) {
+  std::vector<std::tuple<std::string, int64_t, std::string, std::string, std::string>>
+  string_messages =
+  {std::make_tuple("a 10", 10, "a", "", ""),
+    std::make_tuple("b 20", 20, "b", "", ""),
+    std::make_tuple("a 30", 30, "a", "", ""),
+    std::make_tuple("c 40", 40, "c", "", ""),
+    std::make_tuple("a 50", 50, "a", "", "")};
+  write_messages_to_sqlite(string_messages);
+
+  std::unique_ptr<rosbag2_storage::storage_interfaces::ReadOnlyInterface> readable_storage =
+    std::make_unique<rosbag2_storage_plugins::SqliteStorage>();
+  auto db_file = (rcpputils::fs::path(temporary_dir_path_) / "rosbag.db3").string();
+  readable_storage->open(db_file, rosbag2_storage::storage_interfaces::IOFlag::READ_ONLY);
+
+  auto range = readable_storage->read_topics_at_timestamp_range({"a", "c"}, 10, 40);
+  ASSERT_THAT(*range, SizeIs(3));
+  EXPECT_THAT((*range)[0]->time_stamp, Eq(10));
+  EXPECT_THAT((*range)[2]->topic_name, Eq("c"));
+  EXPECT_THAT(*readable_storage->read_topics_at_timestamp_range({}, 15, 35), SizeIs(2));
+
+  EXPECT_THAT(readable_storage->read_closest("a", 38)->time_stamp, Eq(30));
+  EXPECT_THAT(readable_storage->read_closest("a", 42)->time_stamp, Eq(50));
+  EXPECT_THAT(readable_storage->read_closest("a", 40)->time_stamp, Eq(30));
+  EXPECT_THAT(readable_storage->read_closest("a", 100)->time_stamp, Eq(50));
+  EXPECT_THAT(readable_storage->read_closest("unknown", 40), IsNull());
+}
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "rclcpp/qos.hpp"
+#include "rcutils/time.h"
 
 namespace rosbag2_transport
 {
@@ -40,6 +41,14 @@ public:
   std::unordered_map<std::string, rclcpp::QoS> topic_qos_profile_overrides = {};
   bool loop = false;
   std::vector<std::string> topic_remapping_options = {};
+
+  // Time (in nanoseconds) relative to the start of the bag at which playback begins.
+  rcutils_time_point_value_t start_offset = 0;
+
+  // Topics whose last message before the start offset is published when playback begins
+  // at an offset, so that subscribers see a consistent state. Topics recorded with
+  // transient local durability are always included.
+  std::vector<std::string> state_topics = {};
 };
 
 }  // namespace rosbag2_transport
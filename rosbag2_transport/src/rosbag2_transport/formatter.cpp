@@ -26,6 +26,8 @@
 #include <time.h>
 #endif
 
+#include "rosbag2_storage/topic_statistics.hpp"
+
 namespace rosbag2_transport
 {
 
@@ -136,12 +138,17 @@ void Formatter::format_topics_with_type(
   }
 
   auto print_topic_info =
-    [&info_stream](const rosbag2_storage::TopicInformation & ti) -> void {
+    [&info_stream, indentation_spaces](const rosbag2_storage::TopicInformation & ti) -> void {
       info_stream << "Topic: " << ti.topic_metadata.name << " | ";
       info_stream << "Type: " << ti.topic_metadata.type << " | ";
       info_stream << "Count: " << ti.message_count << " | ";
       info_stream << "Serialization Format: " << ti.topic_metadata.serialization_format;
       info_stream << std::endl;
+      // Bags written before metadata version 8 have no statistics.
+      if (!ti.size_histogram.empty()) {
+        indent(info_stream, indentation_spaces + 2);
+        info_stream << format_topic_statistics(ti) << std::endl;
+      }
     };
 
   print_topic_info(topics[0]);
@@ -152,6 +159,27 @@ void Formatter::format_topics_with_type(
   }
 }
 
+std::string Formatter::format_topic_statistics(
+  const rosbag2_storage::TopicInformation & topic_information)
+{
+  std::stringstream statistics;
+  statistics << "Size: " << format_file_size(topic_information.total_bytes) << " | ";
+  statistics << "Rate: " << std::setprecision(1) << std::fixed <<
+    rosbag2_storage::get_message_rate(topic_information) << " Hz | ";
+  statistics << "Message sizes:";
+  const char * separator = " ";
+  for (size_t bucket = 0; bucket < topic_information.size_histogram.size(); ++bucket) {
+    if (topic_information.size_histogram[bucket] == 0u) {
+      continue;
+    }
+    statistics << separator << "< " <<
+      format_file_size(rosbag2_storage::get_size_histogram_bucket_limit(bucket)) << ": " <<
+      topic_information.size_histogram[bucket];
+    separator = ", ";
+  }
+  return statistics.str();
+}
+
 void Formatter::indent(std::stringstream & info_stream, int number_of_spaces)
 {
   info_stream << std::string(number_of_spaces, ' ');
@@ -48,6 +48,10 @@ public:
     std::stringstream & info_stream,
     int indentation_spaces);
 
+  // Size, rate and size histogram of the messages of a topic, on a single line.
+  static std::string format_topic_statistics(
+    const rosbag2_storage::TopicInformation & topic_information);
+
 private:
   static void indent(std::stringstream & info_stream, int number_of_spaces);
 };
@@ -14,7 +14,9 @@
 
 #include "player.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <string>
@@ -78,7 +80,9 @@ Player::queue_read_wait_period_ = std::chrono::milliseconds(100);
 
 Player::Player(
   std::shared_ptr<rosbag2_cpp::Reader> reader, std::shared_ptr<Rosbag2Node> rosbag2_transport)
-: reader_(std::move(reader)), rosbag2_transport_(rosbag2_transport)
+: reader_(std::move(reader)),
+  rosbag2_transport_(rosbag2_transport),
+  playback_start_timestamp_(std::numeric_limits<rcutils_time_point_value_t>::min())
 {}
 
 bool Player::is_storage_completely_loaded() const
@@ -96,12 +100,24 @@ void Player::play(const PlayOptions & options)
   topic_qos_profile_overrides_ = options.topic_qos_profile_overrides;
   prepare_publishers(options);
 
+  if (options.start_offset > 0) {
+    playback_start_timestamp_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      reader_->get_metadata().starting_time.time_since_epoch()).count() + options.start_offset;
+  } else {
+    playback_start_timestamp_ = std::numeric_limits<rcutils_time_point_value_t>::min();
+  }
+
+  // The snapshot is read before the storage is loaded, since the reader must not be used from
+  // several threads at once.
+  if (options.start_offset > 0) {
+    publish_state_snapshot();
+  }
+
   storage_loading_future_ = std::async(
     std::launch::async,
     [this, options]() {load_storage_content(options);});
 
   wait_for_filled_queue(options);
-
   play_messages_from_queue(options);
 }
 
@@ -119,11 +135,19 @@ void Player::load_storage_content(const PlayOptions & options)
 {
   TimePoint time_first_message;
 
+  // Messages before the start offset are covered by the state snapshot.
+  if (options.start_offset > 0) {
+    reader_->seek(playback_start_timestamp_);
+  }
+
   ReplayableMessage message;
-  if (reader_->has_next()) {
+  if (reader_->has_next() && rclcpp::ok()) {
     message.message = reader_->read_next();
-    message.time_since_start = std::chrono::nanoseconds(0);
-    time_first_message = TimePoint(std::chrono::nanoseconds(message.message->time_stamp));
+    auto time_first_stamp = options.start_offset > 0 ?
+      playback_start_timestamp_ : message.message->time_stamp;
+    time_first_message = TimePoint(std::chrono::nanoseconds(time_first_stamp));
+    message.time_since_start =
+      TimePoint(std::chrono::nanoseconds(message.message->time_stamp)) - time_first_message;
     message_queue_.enqueue(message);
   }
 
@@ -194,6 +218,7 @@ void Player::prepare_publishers(const PlayOptions & options)
   storage_filter.topics = options.topics_to_filter;
   reader_->set_filter(storage_filter);
 
+  state_topics_.clear();
   auto topics = reader_->get_all_topics_and_types();
   for (const auto & topic : topics) {
     auto topic_qos = publisher_qos_for_topic(topic, topic_qos_profile_overrides_);
@@ -201,6 +226,33 @@ void Player::prepare_publishers(const PlayOptions & options)
       std::make_pair(
         topic.name, rosbag2_transport_->create_generic_publisher(
           topic.name, topic.type, topic_qos)));
+
+    auto is_played = options.topics_to_filter.empty() ||
+      std::find(
+      options.topics_to_filter.begin(), options.topics_to_filter.end(),
+      topic.name) != options.topics_to_filter.end();
+    auto is_state_topic =
+      topic_qos.get_rmw_qos_profile().durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL ||
+      std::find(
+      options.state_topics.begin(), options.state_topics.end(),
+      topic.name) != options.state_topics.end();
+    if (is_played && is_state_topic) {
+      state_topics_.push_back(topic.name);
+    }
+  }
+}
+
+void Player::publish_state_snapshot()
+{
+  if (state_topics_.empty()) {
+    return;
+  }
+
+  auto snapshot = reader_->read_latest_before(state_topics_, playback_start_timestamp_);
+  ROSBAG2_TRANSPORT_LOG_INFO_STREAM(
+    "Publishing the state of " << snapshot->size() << " topics before the start offset.");
+  for (const auto & message : *snapshot) {
+    publishers_[message->topic_name]->publish(message->serialized_data);
   }
 }
 
@@ -21,11 +21,14 @@
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "moodycamel/readerwriterqueue.h"
 
 #include "rclcpp/qos.hpp"
 
+#include "rcutils/time.h"
+
 #include "rosbag2_transport/play_options.hpp"
 
 #include "replayable_message.hpp"
@@ -60,6 +63,7 @@ private:
   void play_messages_from_queue(const PlayOptions & options);
   void play_messages_until_queue_empty(const PlayOptions & options);
   void prepare_publishers(const PlayOptions & options);
+  void publish_state_snapshot();
   static constexpr double read_ahead_lower_bound_percentage_ = 0.9;
   static const std::chrono::milliseconds queue_read_wait_period_;
 
@@ -70,6 +74,8 @@ private:
   std::shared_ptr<Rosbag2Node> rosbag2_transport_;
   std::unordered_map<std::string, std::shared_ptr<GenericPublisher>> publishers_;
   std::unordered_map<std::string, rclcpp::QoS> topic_qos_profile_overrides_;
+  std::vector<std::string> state_topics_;
+  rcutils_time_point_value_t playback_start_timestamp_;
 };
 
 }  // namespace rosbag2_transport
@@ -141,12 +141,12 @@ void Recorder::subscribe_topics(
 void Recorder::subscribe_topic(const rosbag2_storage::TopicMetadata & topic)
 {
   // Need to create topic in writer before we are trying to create subscription. Since in
-  // callback for subscription we are calling writer_->write(bag_message); and it could happened
+  // callback for subscription we are calling writer_->write(...); and it could happened
   // that callback called before we reached out the line: writer_->create_topic(topic)
-  writer_->create_topic(topic);
+  const auto topic_handle = writer_->create_topic(topic);
 
   Rosbag2QoS subscription_qos{subscription_qos_for_topic(topic.name)};
-  auto subscription = create_subscription(topic.name, topic.type, subscription_qos);
+  auto subscription = create_subscription(topic.name, topic.type, subscription_qos, topic_handle);
   if (subscription) {
     subscriptions_.insert({topic.name, subscription});
     ROSBAG2_TRANSPORT_LOG_INFO_STREAM("Subscribed to topic '" << topic.name << "'");
@@ -158,17 +158,17 @@ void Recorder::subscribe_topic(const rosbag2_storage::TopicMetadata & topic)
 
 std::shared_ptr<GenericSubscription>
 Recorder::create_subscription(
-  const std::string & topic_name, const std::string & topic_type, const rclcpp::QoS & qos)
+  const std::string & topic_name, const std::string & topic_type, const rclcpp::QoS & qos,
+  rosbag2_cpp::writer_interfaces::BaseWriterInterface::TopicHandle topic_handle)
 {
   auto subscription = node_->create_generic_subscription(
     topic_name,
     topic_type,
     qos,
-    [this, topic_name](std::shared_ptr<rclcpp::SerializedMessage> message) {
-      auto bag_message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
-      // the serialized bag message takes ownership of the incoming rclcpp serialized message
+    [this, topic_handle](std::shared_ptr<rclcpp::SerializedMessage> message) {
+      // the serialized data takes ownership of the incoming rclcpp serialized message
       // we therefore have to make sure to cleanup that memory in a custom deleter.
-      bag_message->serialized_data = std::shared_ptr<rcutils_uint8_array_t>(
+      auto serialized_data = std::shared_ptr<rcutils_uint8_array_t>(
         new rcutils_uint8_array_t,
         [](rcutils_uint8_array_t * msg) {
           auto fini_return = rcutils_uint8_array_fini(msg);
@@ -178,17 +178,16 @@ Recorder::create_subscription(
               "Failed to destroy serialized message: " << rcutils_get_error_string().str);
           }
         });
-      *bag_message->serialized_data = message->release_rcl_serialized_message();
-      bag_message->topic_name = topic_name;
+      *serialized_data = message->release_rcl_serialized_message();
       rcutils_time_point_value_t time_stamp;
       int error = rcutils_system_time_now(&time_stamp);
       if (error != RCUTILS_RET_OK) {
         ROSBAG2_TRANSPORT_LOG_ERROR_STREAM(
           "Error getting current time. Error:" << rcutils_get_error_string().str);
       }
-      bag_message->time_stamp = time_stamp;
 
-      writer_->write(bag_message);
+      // Writing by handle neither copies the topic name nor allocates a message object.
+      writer_->write(topic_handle, time_stamp, std::move(serialized_data));
     });
   return subscription;
 }
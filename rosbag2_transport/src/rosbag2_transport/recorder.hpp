@@ -81,7 +81,8 @@ private:
   void subscribe_topic(const rosbag2_storage::TopicMetadata & topic);
 
   std::shared_ptr<GenericSubscription> create_subscription(
-    const std::string & topic_name, const std::string & topic_type, const rclcpp::QoS & qos);
+    const std::string & topic_name, const std::string & topic_type, const rclcpp::QoS & qos,
+    rosbag2_cpp::writer_interfaces::BaseWriterInterface::TopicHandle topic_handle);
 
   void record_messages() const;
 
@@ -29,6 +29,7 @@
 #include "rosbag2_cpp/info.hpp"
 #include "rosbag2_cpp/reader.hpp"
 #include "rosbag2_cpp/readers/sequential_reader.hpp"
+#include "rosbag2_cpp/reindexer.hpp"
 #include "rosbag2_cpp/writer.hpp"
 #include "rosbag2_cpp/writers/sequential_writer.hpp"
 #include "rosbag2_storage/metadata_io.hpp"
@@ -103,6 +104,13 @@ rosbag2_transport_record(PyObject * Py_UNUSED(self), PyObject * args, PyObject *
     "topics",
     "include_hidden_topics",
     "qos_profile_overrides",
+    "prepare_next_file",
+    "max_cache_bytes",
+    "async_cache_flush",
+    "drop_messages_on_full_cache",
+    "align_bagfile_duration",
+    "metadata_snapshot_interval",
+    "append",
     nullptr};
 
   char * uri = nullptr;
@@ -120,9 +128,16 @@ rosbag2_transport_record(PyObject * Py_UNUSED(self), PyObject * args, PyObject *
   uint64_t max_cache_size = 0u;
   PyObject * topics = nullptr;
   bool include_hidden_topics = false;
+  bool prepare_next_file = false;
+  uint64_t max_cache_bytes = 0u;
+  bool async_cache_flush = false;
+  bool drop_messages_on_full_cache = false;
+  bool align_bagfile_duration = false;
+  unsigned long long metadata_snapshot_interval = 0;  // NOLINT
+  bool append = false;
   if (
     !PyArg_ParseTupleAndKeywords(
-      args, kwargs, "ssssss|bbKKKKObO", const_cast<char **>(kwlist),
+      args, kwargs, "ssssss|bbKKKKObObKbbbKb", const_cast<char **>(kwlist),
       &uri,
       &storage_id,
       &serilization_format,
@@ -137,7 +152,14 @@ rosbag2_transport_record(PyObject * Py_UNUSED(self), PyObject * args, PyObject *
       &max_cache_size,
       &topics,
       &include_hidden_topics,
-      &qos_profile_overrides
+      &qos_profile_overrides,
+      &prepare_next_file,
+      &max_cache_bytes,
+      &async_cache_flush,
+      &drop_messages_on_full_cache,
+      &align_bagfile_duration,
+      &metadata_snapshot_interval,
+      &append
   ))
   {
     return nullptr;
@@ -148,6 +170,13 @@ rosbag2_transport_record(PyObject * Py_UNUSED(self), PyObject * args, PyObject *
   storage_options.max_bagfile_size = (uint64_t) max_bagfile_size;
   storage_options.max_bagfile_duration = static_cast<uint64_t>(max_bagfile_duration);
   storage_options.max_cache_size = max_cache_size;
+  storage_options.prepare_next_file = prepare_next_file;
+  storage_options.max_cache_bytes = max_cache_bytes;
+  storage_options.async_cache_flush = async_cache_flush;
+  storage_options.drop_messages_on_full_cache = drop_messages_on_full_cache;
+  storage_options.align_bagfile_duration = align_bagfile_duration;
+  storage_options.metadata_snapshot_interval = static_cast<uint64_t>(metadata_snapshot_interval);
+  storage_options.append = append;
   record_options.all = all;
   record_options.is_discovery_disabled = no_discovery;
   record_options.topic_polling_interval = std::chrono::milliseconds(polling_interval_ms);
@@ -237,6 +266,8 @@ rosbag2_transport_play(PyObject * Py_UNUSED(self), PyObject * args, PyObject * k
     "qos_profile_overrides",
     "loop",
     "topic_remapping",
+    "start_offset",
+    "state_topics",
     nullptr
   };
 
@@ -249,8 +280,10 @@ rosbag2_transport_play(PyObject * Py_UNUSED(self), PyObject * args, PyObject * k
   PyObject * qos_profile_overrides{nullptr};
   bool loop = false;
   PyObject * topic_remapping = nullptr;
+  double start_offset = 0.0;
+  PyObject * state_topics = nullptr;
   if (!PyArg_ParseTupleAndKeywords(
-      args, kwargs, "sss|kfOObO", const_cast<char **>(kwlist),
+      args, kwargs, "sss|kfOObOdO", const_cast<char **>(kwlist),
       &uri,
       &storage_id,
       &node_prefix,
@@ -259,7 +292,9 @@ rosbag2_transport_play(PyObject * Py_UNUSED(self), PyObject * args, PyObject * k
       &topics,
       &qos_profile_overrides,
       &loop,
-      &topic_remapping))
+      &topic_remapping,
+      &start_offset,
+      &state_topics))
   {
     return nullptr;
   }
@@ -271,6 +306,8 @@ rosbag2_transport_play(PyObject * Py_UNUSED(self), PyObject * args, PyObject * k
   play_options.read_ahead_queue_size = read_ahead_queue_size;
   play_options.rate = rate;
   play_options.loop = loop;
+  play_options.start_offset = static_cast<rcutils_time_point_value_t>(
+    RCUTILS_S_TO_NS(start_offset));
 
   if (topics) {
     PyObject * topic_iterator = PyObject_GetIter(topics);
@@ -285,6 +322,19 @@ rosbag2_transport_play(PyObject * Py_UNUSED(self), PyObject * args, PyObject * k
     }
   }
 
+  if (state_topics) {
+    PyObject * topic_iterator = PyObject_GetIter(state_topics);
+    if (topic_iterator != nullptr) {
+      PyObject * topic = nullptr;
+      while ((topic = PyIter_Next(topic_iterator))) {
+        play_options.state_topics.emplace_back(PyUnicode_AsUTF8(topic));
+
+        Py_DECREF(topic);
+      }
+      Py_DECREF(topic_iterator);
+    }
+  }
+
   auto topic_qos_overrides = PyObject_AsTopicQoSMap(qos_profile_overrides);
   play_options.topic_qos_profile_overrides = topic_qos_overrides;
 
@@ -342,6 +392,39 @@ rosbag2_transport_info(PyObject * Py_UNUSED(self), PyObject * args, PyObject * k
   Py_RETURN_NONE;
 }
 
+static PyObject *
+rosbag2_transport_reindex(PyObject * Py_UNUSED(self), PyObject * args, PyObject * kwargs)
+{
+  static const char * kwlist[] = {"uri", "storage_id", "thread_count", nullptr};
+
+  char * char_uri;
+  char * char_storage_id;
+  unsigned long long thread_count = 0;  // NOLINT
+  if (!PyArg_ParseTupleAndKeywords(
+      args, kwargs, "ss|K", const_cast<char **>(kwlist), &char_uri, &char_storage_id,
+      &thread_count))
+  {
+    return nullptr;
+  }
+
+  rosbag2_cpp::StorageOptions storage_options{};
+  storage_options.uri = std::string(char_uri);
+  storage_options.storage_id = std::string(char_storage_id);
+
+  rosbag2_storage::BagMetadata metadata{};
+  try {
+    rosbag2_cpp::Reindexer reindexer;
+    metadata = reindexer.reindex(storage_options, static_cast<size_t>(thread_count));
+  } catch (const std::exception & e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+    return nullptr;
+  }
+
+  return Py_BuildValue(
+    "KK", static_cast<unsigned long long>(metadata.files.size()),  // NOLINT
+    static_cast<unsigned long long>(metadata.message_count));  // NOLINT
+}
+
 /// Define the public methods of this module
 #if __GNUC__ >= 8
 # pragma GCC diagnostic push
@@ -360,6 +443,10 @@ static PyMethodDef rosbag2_transport_methods[] = {
     "info", reinterpret_cast<PyCFunction>(rosbag2_transport_info), METH_VARARGS | METH_KEYWORDS,
     "Print bag info"
   },
+  {
+    "reindex", reinterpret_cast<PyCFunction>(rosbag2_transport_reindex),
+    METH_VARARGS | METH_KEYWORDS, "Rebuild the metadata of a bag from its files"
+  },
   {nullptr, nullptr, 0, nullptr}  /* sentinel */
 };
 #if __GNUC__ >= 8
@@ -15,6 +15,8 @@
 #ifndef ROSBAG2_TRANSPORT__MOCK_SEQUENTIAL_READER_HPP_
 #define ROSBAG2_TRANSPORT__MOCK_SEQUENTIAL_READER_HPP_
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -78,6 +80,44 @@ public:
     filter_ = rosbag2_storage::StorageFilter();
   }
 
+  void seek(rcutils_time_point_value_t timestamp) override
+  {
+    num_read_ = 0;
+    while (num_read_ < messages_.size() && messages_[num_read_]->time_stamp < timestamp) {
+      num_read_++;
+    }
+  }
+
+  std::shared_ptr<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>
+  read_latest_before(
+    const std::vector<std::string> & topic_names,
+    rcutils_time_point_value_t timestamp) override
+  {
+    std::map<std::string, std::shared_ptr<rosbag2_storage::SerializedBagMessage>> latest;
+    for (const auto & message : messages_) {
+      if (message->time_stamp < timestamp &&
+        std::find(topic_names.begin(), topic_names.end(), message->topic_name) !=
+        topic_names.end() &&
+        (!latest[message->topic_name] ||
+        latest[message->topic_name]->time_stamp <= message->time_stamp))
+      {
+        latest[message->topic_name] = message;
+      }
+    }
+    auto latest_messages =
+      std::make_shared<std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>>>();
+    for (const auto & topic_and_message : latest) {
+      latest_messages->push_back(topic_and_message.second);
+    }
+    std::sort(
+      latest_messages->begin(), latest_messages->end(),
+      [](const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & lhs,
+      const std::shared_ptr<rosbag2_storage::SerializedBagMessage> & rhs) {
+        return lhs->time_stamp < rhs->time_stamp;
+      });
+    return latest_messages;
+  }
+
   void prepare(
     std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>> messages,
     std::vector<rosbag2_storage::TopicMetadata> topics)
@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "rosbag2_cpp/writer_interfaces/base_writer_interface.hpp"
@@ -35,9 +36,16 @@ public:
 
   void reset() override {}
 
-  void create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) override
+  TopicHandle create_topic(const rosbag2_storage::TopicMetadata & topic_with_type) override
   {
-    topics_.emplace(topic_with_type.name, topic_with_type);
+    auto handle = topic_handles_.find(topic_with_type.name);
+    if (handle == topic_handles_.end()) {
+      topics_.emplace(topic_with_type.name, topic_with_type);
+      handle = topic_handles_.emplace(
+        topic_with_type.name, static_cast<TopicHandle>(topic_names_by_handle_.size())).first;
+      topic_names_by_handle_.push_back(topic_with_type.name);
+    }
+    return handle->second;
   }
 
   void remove_topic(const rosbag2_storage::TopicMetadata & topic_with_type) override
@@ -45,12 +53,26 @@ public:
     (void) topic_with_type;
   }
 
+  using rosbag2_cpp::writer_interfaces::BaseWriterInterface::write;
+
   void write(std::shared_ptr<rosbag2_storage::SerializedBagMessage> message) override
   {
     messages_.push_back(message);
     messages_per_topic_[message->topic_name] += 1;
   }
 
+  void write(
+    TopicHandle topic,
+    rcutils_time_point_value_t time_stamp,
+    std::shared_ptr<rcutils_uint8_array_t> serialized_data) override
+  {
+    auto message = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    message->serialized_data = std::move(serialized_data);
+    message->time_stamp = time_stamp;
+    message->topic_name = topic_names_by_handle_.at(topic);
+    write(message);
+  }
+
   std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>> get_messages()
   {
     return messages_;
@@ -68,6 +90,8 @@ public:
 
 private:
   std::unordered_map<std::string, rosbag2_storage::TopicMetadata> topics_;
+  std::unordered_map<std::string, TopicHandle> topic_handles_;
+  std::vector<std::string> topic_names_by_handle_;
   std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>> messages_;
   std::unordered_map<std::string, size_t> messages_per_topic_;
 };
@@ -86,6 +86,25 @@ TEST_F(FormatterTestFixture, format_topics_with_type_correctly_layouts_more_topi
   EXPECT_EQ(expected, formatted_output.str());
 }
 
+TEST_F(FormatterTestFixture, format_topics_with_type_prints_statistics_of_topics_having_them) {
+  std::vector<rosbag2_storage::TopicInformation> topics;
+  topics.push_back({{"topic1", "type1", "rmw1", ""}, 11});
+  topics[0].total_bytes = 3000;
+  topics[0].duration = 1s;
+  topics[0].size_histogram = {0, 0, 0, 0, 0, 0, 0, 0, 5, 6};
+  topics.push_back({{"topic2", "type2", "rmw2", ""}, 200});
+  std::stringstream formatted_output;
+
+  formatter_->format_topics_with_type(topics, formatted_output, indentation_spaces_);
+  auto expected =
+    std::string("Topic: topic1 | Type: type1 | Count: 11 | Serialization Format: rmw1\n") +
+    std::string(indentation_spaces_ + 2, ' ') +
+    std::string("Size: 2.9 KiB | Rate: 10.0 Hz | Message sizes: < 256 B: 5, < 512 B: 6\n") +
+    std::string(indentation_spaces_, ' ') +
+    std::string("Topic: topic2 | Type: type2 | Count: 200 | Serialization Format: rmw2\n");
+  EXPECT_EQ(expected, formatted_output.str());
+}
+
 TEST_F(FormatterTestFixture, format_topics_with_type_prints_newline_if_there_are_no_topics) {
   std::vector<rosbag2_storage::TopicInformation> topics = {};
   std::stringstream formatted_output;
@@ -384,3 +384,41 @@ TEST_F(RosBag2PlayQosOverrideTestFixture, override_has_precedence_over_recorded)
   // Fails if times out
   play_and_wait(timeout);
 }
+
+TEST_F(RosBag2PlayTestFixture, playing_from_offset_publishes_state_before_offset_first)
+{
+  auto topic_types = std::vector<rosbag2_storage::TopicMetadata>{
+    {"topic1", "test_msgs/BasicTypes", "", ""},
+  };
+
+  std::vector<std::shared_ptr<rosbag2_storage::SerializedBagMessage>> messages;
+  for (int32_t i = 1; i <= 4; ++i) {
+    auto primitive_message = get_messages_basic_types()[0];
+    primitive_message->int32_value = i;
+    messages.push_back(serialize_test_message("topic1", 200 * i, primitive_message));
+  }
+
+  auto prepared_mock_reader = std::make_unique<MockSequentialReader>();
+  prepared_mock_reader->prepare(messages, topic_types);
+  reader_ = std::make_unique<rosbag2_cpp::Reader>(std::move(prepared_mock_reader));
+
+  sub_->add_subscription<test_msgs::msg::BasicTypes>("/topic1", 3);
+  auto await_received_messages = sub_->spin_subscriptions();
+
+  play_options_.start_offset = 500;
+  play_options_.state_topics = {"topic1"};
+  Rosbag2Transport rosbag2_transport(reader_, writer_, info_);
+  rosbag2_transport.play(storage_options_, play_options_);
+
+  await_received_messages.get();
+
+  auto replayed_test_primitives = sub_->get_received_messages<test_msgs::msg::BasicTypes>(
+    "/topic1");
+  // The last message before the offset, then the messages after it.
+  EXPECT_THAT(
+    replayed_test_primitives,
+    ElementsAre(
+      Pointee(Field(&test_msgs::msg::BasicTypes::int32_value, 2)),
+      Pointee(Field(&test_msgs::msg::BasicTypes::int32_value, 3)),
+      Pointee(Field(&test_msgs::msg::BasicTypes::int32_value, 4))));
+}